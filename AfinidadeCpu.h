@@ -0,0 +1,389 @@
+#ifndef AFINIDADE_CPU_H
+#define AFINIDADE_CPU_H
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+
+// Afinidade de CPU e memória local por nó NUMA para as threads dos serviços (workers do
+// httplib, fan-out do Mestre, laços de eventos, threads de contagem). Sem libnuma: a topologia
+// vem de /sys/devices/system/node, as threads são presas com sched_setaffinity e a memória
+// que alocam passa a vir preferencialmente do próprio nó (set_mempolicy com MPOL_PREFERRED).
+// Como o corpo de cada requisição é alocado pela thread que a lê, ele fica no nó dela.
+//
+// Variáveis de ambiente:
+//   AFINIDADE          nenhuma (padrão) | numa | nos:0,1 | cpus:0-7,16-23
+//                      numa/nos: cada thread é presa às CPUs de um nó, em rodízio entre os nós;
+//                      cpus: cada thread é presa a uma CPU da lista, em rodízio
+//   AFINIDADE_MEMORIA  local (padrão) | padrao: preferir a memória do nó da thread
+//
+// Com PROCESSOS > 1, cada processo fica com um nó (numa/nos, em rodízio) ou com uma fatia
+// contígua da lista de CPUs (cpus). Threads auxiliares de uma requisição (fixarThreadAtual com
+// o nó da chamadora) ficam no mesmo nó da thread que recebeu o corpo.
+// Mesmo sem AFINIDADE, as threads registradas aparecem em estado() com a CPU em que rodam.
+class AfinidadeCpu {
+public:
+    static AfinidadeCpu& instancia() {
+        static AfinidadeCpu afinidade;
+        return afinidade;
+    }
+
+    // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+    static std::vector<int> lerListaCpus(const std::string& lista) {
+        std::vector<int> cpus;
+        std::stringstream entrada(lista);
+        std::string faixa;
+        while (std::getline(entrada, faixa, ',')) {
+            faixa.erase(std::remove_if(faixa.begin(), faixa.end(), ::isspace), faixa.end());
+            if (faixa.empty()) continue;
+            size_t traco = faixa.find('-');
+            int inicio = std::stoi(faixa.substr(0, traco));
+            int fim = traco == std::string::npos ? inicio : std::stoi(faixa.substr(traco + 1));
+            for (int cpu = inicio; cpu <= fim; ++cpu) cpus.push_back(cpu);
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    static std::string formatarListaCpus(const std::vector<int>& cpus) {
+        std::string lista;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (!lista.empty()) lista += ',';
+            lista += std::to_string(cpus[i]);
+            if (j > i) lista += '-' + std::to_string(cpus[j]);
+            i = j + 1;
+        }
+        return lista;
+    }
+
+private:
+    static constexpr int mpolPreferido = 1; // MPOL_PREFERRED de <numaif.h>
+
+    struct No {
+        int id;
+        std::vector<int> cpus;
+    };
+
+    struct ThreadRegistrada {
+        std::string papel;
+        std::vector<int> cpus; // vazio: não presa
+        int no = -1;
+        bool memoriaLocal = false;
+        std::string erro;
+    };
+
+    // Estado da thread atual: presa uma única vez e removida do registro ao terminar
+    struct EstadoThread {
+        bool registrada = false;
+        int no = -1;
+        ~EstadoThread() {
+            if (registrada) AfinidadeCpu::instancia().removerThread(static_cast<pid_t>(syscall(SYS_gettid)));
+        }
+    };
+
+    static EstadoThread& estadoThread() {
+        static thread_local EstadoThread estado;
+        return estado;
+    }
+
+    std::string modo = "nenhuma";
+    bool memoriaLocal = true;
+    std::vector<No> topologia;       // nós do sistema, restritos às CPUs permitidas ao processo
+    std::vector<No> nosProcesso;     // nós usados por este processo
+    std::vector<int> cpusProcesso;   // CPUs usadas por este processo
+    std::vector<No> nosSelecionados;   // AFINIDADE=numa/nos:..., antes da divisão entre processos
+    std::vector<int> cpusSelecionadas; // AFINIDADE=cpus:..., idem
+    std::map<int, int> noDaCpu;
+    int indiceProcesso = 0;
+    int totalProcessos = 1;
+    std::atomic<size_t> proximaVaga{0};
+
+    mutable std::mutex mutex;
+    std::map<pid_t, ThreadRegistrada> threads;
+
+    static std::string lerArquivo(const std::string& caminho) {
+        std::ifstream arquivo(caminho);
+        std::string conteudo;
+        std::getline(arquivo, conteudo);
+        return conteudo;
+    }
+
+    void lerTopologia() {
+        cpu_set_t permitidas;
+        CPU_ZERO(&permitidas);
+        sched_getaffinity(0, sizeof(permitidas), &permitidas);
+        auto permitida = [&](int cpu) { return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &permitidas); };
+
+        std::error_code erro;
+        for (const auto& entrada : std::filesystem::directory_iterator("/sys/devices/system/node", erro)) {
+            std::string nome = entrada.path().filename().string();
+            if (nome.compare(0, 4, "node") != 0 || nome.size() == 4 ||
+                !std::all_of(nome.begin() + 4, nome.end(), ::isdigit)) {
+                continue;
+            }
+            No no{std::stoi(nome.substr(4)), {}};
+            for (int cpu : lerListaCpus(lerArquivo(entrada.path().string() + "/cpulist"))) {
+                if (permitida(cpu)) no.cpus.push_back(cpu);
+            }
+            if (!no.cpus.empty()) topologia.push_back(std::move(no));
+        }
+        // Sem /sys (ou sem NUMA): um único nó com as CPUs permitidas
+        if (topologia.empty()) {
+            No no{0, {}};
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (permitida(cpu)) no.cpus.push_back(cpu);
+            }
+            topologia.push_back(std::move(no));
+        }
+        std::sort(topologia.begin(), topologia.end(), [](const No& a, const No& b) { return a.id < b.id; });
+        for (const auto& no : topologia) {
+            for (int cpu : no.cpus) noDaCpu[cpu] = no.id;
+        }
+    }
+
+    AfinidadeCpu() {
+        lerTopologia();
+        const char* valor = std::getenv("AFINIDADE");
+        std::string configuracao = valor ? valor : "nenhuma";
+        const char* memoria = std::getenv("AFINIDADE_MEMORIA");
+        memoriaLocal = !memoria || std::string(memoria) != "padrao";
+
+        try {
+            if (configuracao.empty() || configuracao == "nenhuma") {
+                modo = "nenhuma";
+            } else if (configuracao == "numa") {
+                modo = "numa";
+                nosSelecionados = topologia;
+            } else if (configuracao.compare(0, 4, "nos:") == 0) {
+                modo = "nos";
+                for (int id : lerListaCpus(configuracao.substr(4))) {
+                    for (const auto& no : topologia) {
+                        if (no.id == id) nosSelecionados.push_back(no);
+                    }
+                }
+            } else if (configuracao.compare(0, 5, "cpus:") == 0) {
+                modo = "cpus";
+                for (int cpu : lerListaCpus(configuracao.substr(5))) {
+                    if (noDaCpu.count(cpu)) cpusSelecionadas.push_back(cpu);
+                }
+            } else {
+                throw std::invalid_argument(configuracao);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "AFINIDADE inválida (\"" << configuracao << "\"): threads não serão presas" << std::endl;
+            modo = "nenhuma";
+        }
+        if ((modo == "nos" && nosSelecionados.empty()) || (modo == "cpus" && cpusSelecionadas.empty())) {
+            std::cerr << "AFINIDADE=" << configuracao << " não corresponde a nenhuma CPU permitida: threads não serão presas"
+                     << std::endl;
+            modo = "nenhuma";
+        }
+        definirProcesso(0, 1);
+    }
+
+    void removerThread(pid_t tid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.erase(tid);
+    }
+
+    std::vector<int> cpusDoNo(int id) const {
+        std::vector<int> cpus;
+        for (int cpu : cpusProcesso) {
+            auto it = noDaCpu.find(cpu);
+            if (it != noDaCpu.end() && it->second == id) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    static bool prender(const std::vector<int>& cpus, std::string& erro) {
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        for (int cpu : cpus) CPU_SET(cpu, &conjunto);
+        if (sched_setaffinity(0, sizeof(conjunto), &conjunto) != 0) {
+            erro = std::string("sched_setaffinity: ") + std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    static bool preferirMemoria(int no, std::string& erro) {
+        std::array<unsigned long, 16> mascara{};
+        constexpr size_t bitsPorPalavra = sizeof(unsigned long) * 8;
+        if (no < 0 || static_cast<size_t>(no) >= mascara.size() * bitsPorPalavra) return false;
+        mascara[no / bitsPorPalavra] |= 1UL << (no % bitsPorPalavra);
+        if (syscall(SYS_set_mempolicy, mpolPreferido, mascara.data(), mascara.size() * bitsPorPalavra + 1) != 0) {
+            erro = std::string("set_mempolicy: ") + std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+
+    void registrar(const char* papel, std::vector<int> cpus, int no) {
+        EstadoThread& estado = estadoThread();
+        ThreadRegistrada registro;
+        registro.papel = papel;
+        if (!cpus.empty() && prender(cpus, registro.erro)) {
+            registro.cpus = std::move(cpus);
+            registro.no = no;
+            if (memoriaLocal && no >= 0) {
+                registro.memoriaLocal = preferirMemoria(no, registro.erro);
+            }
+        }
+        estado.registrada = true;
+        estado.no = registro.no;
+        std::lock_guard<std::mutex> lock(mutex);
+        threads[static_cast<pid_t>(syscall(SYS_gettid))] = std::move(registro);
+    }
+
+    // CPU em que a thread rodou por último: campo 39 de /proc/self/task/<tid>/stat
+    static int cpuAtual(pid_t tid) {
+        std::string linha = lerArquivo("/proc/self/task/" + std::to_string(tid) + "/stat");
+        size_t fimNome = linha.rfind(')');
+        if (fimNome == std::string::npos) return -1;
+        std::stringstream campos(linha.substr(fimNome + 2));
+        std::string campo;
+        for (int i = 3; i <= 39 && campos >> campo; ++i) {
+            if (i == 39) return std::atoi(campo.c_str());
+        }
+        return -1;
+    }
+
+public:
+    AfinidadeCpu(const AfinidadeCpu&) = delete;
+    AfinidadeCpu& operator=(const AfinidadeCpu&) = delete;
+
+    // Chamado em cada processo filho de ExecucaoServidor (o fork só copia a thread atual)
+    void definirProcesso(int indice, int total) {
+        indiceProcesso = indice;
+        totalProcessos = std::max(1, total);
+        proximaVaga = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.clear();
+        }
+        cpusProcesso.clear();
+        if (modo == "numa" || modo == "nos") {
+            nosProcesso = nosSelecionados;
+            if (totalProcessos > 1 && nosSelecionados.size() > 1) {
+                nosProcesso = {nosSelecionados[indiceProcesso % nosSelecionados.size()]};
+            }
+            for (const auto& no : nosProcesso) {
+                cpusProcesso.insert(cpusProcesso.end(), no.cpus.begin(), no.cpus.end());
+            }
+        } else if (modo == "cpus") {
+            cpusProcesso = cpusSelecionadas;
+            if (totalProcessos > 1 && cpusSelecionadas.size() >= static_cast<size_t>(totalProcessos)) {
+                size_t inicio = cpusSelecionadas.size() * indiceProcesso / totalProcessos;
+                size_t fim = cpusSelecionadas.size() * (indiceProcesso + 1) / totalProcessos;
+                cpusProcesso.assign(cpusSelecionadas.begin() + inicio, cpusSelecionadas.begin() + fim);
+            }
+        } else {
+            for (const auto& no : topologia) {
+                cpusProcesso.insert(cpusProcesso.end(), no.cpus.begin(), no.cpus.end());
+            }
+        }
+        std::sort(cpusProcesso.begin(), cpusProcesso.end());
+    }
+
+    bool ativa() const { return modo != "nenhuma"; }
+
+    // CPUs à disposição deste processo ou, com 'no' e AFINIDADE ativa, das threads presas a esse
+    // nó (para dimensionar pools de threads)
+    size_t cpusDisponiveis(int no = -1) const {
+        size_t cpus = ativa() && no >= 0 ? cpusDoNo(no).size() : cpusProcesso.size();
+        return std::max<size_t>(1, cpus);
+    }
+
+    // Nó da thread atual: o nó em que foi presa ou, se não foi, o da CPU em que está rodando
+    int noAtual() const {
+        int no = estadoThread().no;
+        if (no >= 0) return no;
+        int cpu = sched_getcpu();
+        auto it = noDaCpu.find(cpu);
+        return it == noDaCpu.end() ? -1 : it->second;
+    }
+
+    // Prende a thread atual à próxima vaga do rodízio (um nó ou uma CPU, conforme AFINIDADE).
+    // Só tem efeito na primeira chamada de cada thread.
+    void fixarThreadAtual(const char* papel) {
+        if (estadoThread().registrada) return;
+        size_t vaga = proximaVaga++;
+        if (modo == "cpus") {
+            int cpu = cpusProcesso[vaga % cpusProcesso.size()];
+            registrar(papel, {cpu}, noDaCpu.at(cpu));
+        } else if (modo == "numa" || modo == "nos") {
+            const No& no = nosProcesso[vaga % nosProcesso.size()];
+            registrar(papel, cpusDoNo(no.id), no.id);
+        } else {
+            registrar(papel, {}, -1);
+        }
+    }
+
+    // Prende a thread atual ao nó 'no' (em geral, noAtual() da thread que criou esta):
+    // threads auxiliares de uma requisição leem a memória do nó em que o corpo foi alocado
+    void fixarThreadAtual(const char* papel, int no) {
+        if (estadoThread().registrada) return;
+        std::vector<int> cpus = ativa() && no >= 0 ? cpusDoNo(no) : std::vector<int>{};
+        if (cpus.empty()) {
+            fixarThreadAtual(papel);
+            return;
+        }
+        registrar(papel, std::move(cpus), no);
+    }
+
+    Json::Value estado() const {
+        Json::Value resposta;
+        resposta["modo"] = modo;
+        resposta["memoria"] = memoriaLocal ? "local" : "padrao";
+        resposta["processo"] = indiceProcesso;
+        resposta["processos"] = totalProcessos;
+        resposta["cpus_processo"] = formatarListaCpus(cpusProcesso);
+        resposta["nos"] = Json::Value(Json::arrayValue);
+        for (const auto& no : topologia) {
+            Json::Value item;
+            item["no"] = no.id;
+            item["cpus"] = formatarListaCpus(no.cpus);
+            resposta["nos"].append(item);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        resposta["threads"] = Json::Value(Json::arrayValue);
+        for (const auto& [tid, registro] : threads) {
+            Json::Value item;
+            item["papel"] = registro.papel;
+            item["tid"] = tid;
+            item["cpus"] = registro.cpus.empty() ? "livre" : formatarListaCpus(registro.cpus);
+            item["no"] = registro.no;
+            int cpu = cpuAtual(tid);
+            item["cpu_atual"] = cpu;
+            auto it = noDaCpu.find(cpu);
+            item["no_atual"] = it == noDaCpu.end() ? -1 : it->second;
+            item["memoria_local"] = registro.memoriaLocal;
+            if (!registro.erro.empty()) item["erro"] = registro.erro;
+            resposta["threads"].append(item);
+        }
+        return resposta;
+    }
+};
+
+#endif // AFINIDADE_CPU_H
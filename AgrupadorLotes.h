@@ -0,0 +1,134 @@
+#ifndef AGRUPADOR_LOTES_H
+#define AGRUPADOR_LOTES_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <jsoncpp/json/json.h>
+#include "ClassesCaracteres.h"
+
+// Agrupamento de requisições pequenas e simultâneas em um escravo (micro-batching).
+//
+// A primeira requisição que chega abre um lote e vira a líder: espera até LOTE_JANELA_US
+// microssegundos ou até o lote ter LOTE_MAXIMO textos. As que chegam nesse intervalo copiam o
+// texto para o buffer empacotado do lote e aguardam. A líder conta tudo com uma única varredura
+// (contarClasseSegmentos) e cada requisição recebe de volta a sua quantidade.
+//
+// Custo: a líder e as que aguardam são workers do pool do httplib (CPPHTTPLIB_THREAD_POOL_COUNT)
+// bloqueados, sem atender outras conexões; a líder, pela janela inteira. Se os lotes não enchem,
+// N workers atendem no máximo cerca de N textos pequenos por LOTE_JANELA_US.
+//
+// Variáveis de ambiente:
+//   LOTE_JANELA_US      janela de espera da líder (padrão: 0 = desativado); prende um worker
+//                       do httplib por lote durante toda a janela
+//   LOTE_MAXIMO         textos por lote (padrão: 32)
+//   LOTE_TEXTO_MAXIMO   só textos até este tamanho em bytes entram em lotes (padrão: 16384)
+template <typename Politica>
+class AgrupadorLotes {
+private:
+    struct Lote {
+        std::vector<char> dados;
+        std::vector<size_t> fins;
+        std::vector<uint64_t> quantidades;
+        bool pronto = false;
+        std::condition_variable cv;
+    };
+
+    std::mutex mutex;
+    std::shared_ptr<Lote> aberto;
+    std::chrono::microseconds janela;
+    size_t maximo;
+    size_t textoMaximo;
+
+    std::atomic<uint64_t> lotes{0};
+    std::atomic<uint64_t> agrupadas{0};
+    std::atomic<uint64_t> maiorLote{0};
+
+    static uint64_t variavelNumerica(const char* nome, uint64_t padrao) {
+        const char* valor = std::getenv(nome);
+        return valor && *valor ? std::strtoull(valor, nullptr, 10) : padrao;
+    }
+
+public:
+    AgrupadorLotes()
+        : janela(variavelNumerica("LOTE_JANELA_US", 0)),
+          maximo(std::max<uint64_t>(1, variavelNumerica("LOTE_MAXIMO", 32))),
+          textoMaximo(variavelNumerica("LOTE_TEXTO_MAXIMO", 16384)) {}
+
+    bool ativo() const {
+        return janela.count() > 0 && maximo > 1;
+    }
+
+    // Textos grandes não ganham nada esperando: são contados direto pela requisição
+    bool aceita(size_t tamanho) const {
+        return ativo() && tamanho <= textoMaximo;
+    }
+
+    uint64_t contar(const char* texto, size_t tamanho) {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::shared_ptr<Lote> lote = aberto;
+        bool lider = !lote;
+        if (lider) {
+            lote = std::make_shared<Lote>();
+            lote->dados.reserve(std::min<size_t>(textoMaximo, 4096) * maximo);
+            lote->fins.reserve(maximo);
+            aberto = lote;
+        }
+        size_t indice = lote->fins.size();
+        lote->dados.insert(lote->dados.end(), texto, texto + tamanho);
+        lote->fins.push_back(lote->dados.size());
+        if (lote->fins.size() >= maximo) {
+            // Lote cheio: fecha para novas entradas e acorda a líder antes do fim da janela
+            aberto.reset();
+            lote->cv.notify_all();
+        }
+
+        if (!lider) {
+            lote->cv.wait(lock, [&]() { return lote->pronto; });
+            return lote->quantidades[indice];
+        }
+
+        auto prazo = std::chrono::steady_clock::now() + janela;
+        lote->cv.wait_until(lock, prazo, [&]() { return aberto != lote; });
+        if (aberto == lote) {
+            aberto.reset();
+        }
+        lock.unlock();
+
+        // Fechado: ninguém mais escreve em dados/fins, a contagem roda fora da trava
+        size_t segmentos = lote->fins.size();
+        lote->quantidades.resize(segmentos);
+        contarClasseSegmentos<Politica>(lote->dados.data(), lote->fins.data(), segmentos, lote->quantidades.data());
+        lotes.fetch_add(1, std::memory_order_relaxed);
+        agrupadas.fetch_add(segmentos, std::memory_order_relaxed);
+        uint64_t maior = maiorLote.load(std::memory_order_relaxed);
+        while (segmentos > maior && !maiorLote.compare_exchange_weak(maior, segmentos, std::memory_order_relaxed)) {
+        }
+
+        lock.lock();
+        lote->pronto = true;
+        lote->cv.notify_all();
+        return lote->quantidades[indice];
+    }
+
+    Json::Value estado() const {
+        uint64_t totalLotes = lotes.load();
+        Json::Value e;
+        e["ativo"] = ativo();
+        e["janela_us"] = Json::Value::Int64(janela.count());
+        e["maximo"] = Json::Value::UInt64(maximo);
+        e["texto_maximo_bytes"] = Json::Value::UInt64(textoMaximo);
+        e["lotes"] = Json::Value::UInt64(totalLotes);
+        e["requisicoes_agrupadas"] = Json::Value::UInt64(agrupadas.load());
+        e["media_por_lote"] = totalLotes > 0 ? static_cast<double>(agrupadas.load()) / totalLotes : 0.0;
+        e["maior_lote"] = Json::Value::UInt64(maiorLote.load());
+        return e;
+    }
+};
+
+#endif // AGRUPADOR_LOTES_H
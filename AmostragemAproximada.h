@@ -0,0 +1,263 @@
+#ifndef AMOSTRAGEM_APROXIMADA_H
+#define AMOSTRAGEM_APROXIMADA_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+// Contagem aproximada de textos enormes (/processar com "aproximado"): o texto é dividido em
+// blocos de tamanho fixo e blocos sorteados sem reposição são contados pelos escravos. O total de
+// cada classe é estimado por N * média da amostra, com intervalo de confiança pela aproximação
+// normal e correção de população finita:
+//
+//   meia largura = z * N * sqrt((1 - n/N) * s² / n)
+//
+// A amostragem é feita em rodadas: um piloto estima a variância, e cada rodada seguinte sorteia
+// os blocos que ainda faltam para a meia largura cair abaixo do erro relativo pedido (limitada a
+// 4x o que já foi amostrado, porque a variância do piloto é ruidosa). Quando todos os blocos
+// foram amostrados a meia largura é zero e o resultado é exato. Uma classe sem nenhuma ocorrência
+// na amostra não tem variância observável; o intervalo dela usa a regra dos três (≈ 3N/n a 95%).
+class AmostragemAproximada {
+public:
+    enum Classe { Letras = 0, Numeros = 1 };
+    static constexpr size_t numClasses = 2;
+
+    struct Parametros {
+        double erroRelativo = 0.001; // meia largura do intervalo / estimativa
+        double confianca = 0.95;
+        int64_t tempoMs = 0;         // orçamento de tempo; 0 = sem limite
+        size_t blocoBytes = 4096;
+        size_t blocosPiloto = 64;
+        uint64_t semente = 0;        // 0 = sorteada
+    };
+
+    struct Estimativa {
+        double valor = 0;
+        double meiaLargura = 0;
+    };
+
+    struct Bloco {
+        size_t inicio;
+        size_t tamanho;
+    };
+
+    // {"erro": 0.001, "confianca": 0.95, "tempo_ms": 200, "bloco_bytes": 4096, "semente": 42},
+    // ou true para os padrões; campos ausentes ficam com os valores de 'padrao'
+    static Parametros lerParametros(const Json::Value& json, Parametros padrao) {
+        if (json.isBool()) {
+            return padrao;
+        }
+        if (!json.isObject()) {
+            throw std::invalid_argument("\"aproximado\" deve ser true ou um objeto");
+        }
+        auto numero = [&](const char* nome) {
+            if (!json[nome].isNumeric()) {
+                throw std::invalid_argument(std::string("\"aproximado.") + nome + "\" deve ser numérico");
+            }
+            return json[nome].asDouble();
+        };
+        if (json.isMember("erro")) padrao.erroRelativo = numero("erro");
+        if (json.isMember("confianca")) padrao.confianca = numero("confianca");
+        if (json.isMember("tempo_ms")) padrao.tempoMs = static_cast<int64_t>(numero("tempo_ms"));
+        if (json.isMember("bloco_bytes")) padrao.blocoBytes = static_cast<size_t>(numero("bloco_bytes"));
+        if (json.isMember("semente")) padrao.semente = static_cast<uint64_t>(numero("semente"));
+
+        if (!(padrao.erroRelativo > 0)) {
+            throw std::invalid_argument("\"aproximado.erro\" deve ser positivo");
+        }
+        if (!(padrao.confianca > 0 && padrao.confianca < 1)) {
+            throw std::invalid_argument("\"aproximado.confianca\" deve estar entre 0 e 1");
+        }
+        if (padrao.tempoMs < 0) {
+            throw std::invalid_argument("\"aproximado.tempo_ms\" não pode ser negativo");
+        }
+        if (padrao.blocoBytes < 64) {
+            throw std::invalid_argument("\"aproximado.bloco_bytes\" deve ser de pelo menos 64");
+        }
+        return padrao;
+    }
+
+    // z tal que P(|Z| <= z) = confianca, por bisseção sobre erfc
+    static double quantilNormal(double confianca) {
+        double alvo = 1.0 - confianca;
+        double baixo = 0.0;
+        double alto = 40.0;
+        for (int i = 0; i < 100; ++i) {
+            double meio = (baixo + alto) / 2;
+            if (std::erfc(meio / std::sqrt(2.0)) > alvo) {
+                baixo = meio;
+            } else {
+                alto = meio;
+            }
+        }
+        return (baixo + alto) / 2;
+    }
+
+private:
+    const char* texto;
+    size_t tamanhoTexto;
+    Parametros parametros;
+    double z;
+    size_t totalBlocos;
+
+    // Fisher-Yates preguiçoso: só as posições trocadas ficam no mapa, então sortear n blocos
+    // custa O(n) de memória mesmo com milhões de blocos
+    std::mt19937_64 gerador;
+    std::unordered_map<size_t, size_t> trocas;
+    size_t sorteados = 0;
+
+    struct Acumulador {
+        double soma = 0;
+        double somaQuadrados = 0;
+    };
+    std::array<Acumulador, numClasses> acumuladores{};
+    size_t registrados = 0;
+    size_t bytesAmostrados = 0;
+
+    size_t posicao(size_t i) const {
+        auto it = trocas.find(i);
+        return it == trocas.end() ? i : it->second;
+    }
+
+    // Fronteira de bloco avançada até o início de um caractere UTF-8: os blocos continuam
+    // particionando o texto e nenhum caractere é cortado ao meio
+    size_t alinhar(size_t pos) const {
+        while (pos < tamanhoTexto && (static_cast<unsigned char>(texto[pos]) & 0xC0) == 0x80) {
+            ++pos;
+        }
+        return std::min(pos, tamanhoTexto);
+    }
+
+public:
+    AmostragemAproximada(const char* dados, size_t tamanho, const Parametros& p)
+        : texto(dados), tamanhoTexto(tamanho), parametros(p), z(quantilNormal(p.confianca)),
+          totalBlocos(std::max<size_t>(1, (tamanho + p.blocoBytes - 1) / p.blocoBytes)),
+          gerador(p.semente ? p.semente : std::random_device{}()) {}
+
+    size_t blocos() const { return totalBlocos; }
+    size_t amostrados() const { return registrados; }
+    size_t bytes() const { return bytesAmostrados; }
+    bool completo() const { return sorteados == totalBlocos; }
+    const Parametros& configuracao() const { return parametros; }
+
+    // Próximos 'quantidade' blocos da permutação aleatória (sem reposição)
+    std::vector<Bloco> sortear(size_t quantidade) {
+        quantidade = std::min(quantidade, totalBlocos - sorteados);
+        std::vector<Bloco> resultado;
+        resultado.reserve(quantidade);
+        for (size_t k = 0; k < quantidade; ++k, ++sorteados) {
+            std::uniform_int_distribution<size_t> distribuicao(sorteados, totalBlocos - 1);
+            size_t j = distribuicao(gerador);
+            size_t escolhido = posicao(j);
+            trocas[j] = posicao(sorteados);
+            trocas.erase(sorteados);
+            size_t inicio = alinhar(escolhido * parametros.blocoBytes);
+            size_t fim = alinhar(std::min(tamanhoTexto, (escolhido + 1) * parametros.blocoBytes));
+            resultado.push_back({inicio, fim - inicio});
+        }
+        return resultado;
+    }
+
+    // Contagens de um bloco devolvido por sortear()
+    void registrar(const Bloco& bloco, uint64_t letras, uint64_t numeros) {
+        double valores[numClasses] = {static_cast<double>(letras), static_cast<double>(numeros)};
+        for (size_t c = 0; c < numClasses; ++c) {
+            acumuladores[c].soma += valores[c];
+            acumuladores[c].somaQuadrados += valores[c] * valores[c];
+        }
+        registrados++;
+        bytesAmostrados += bloco.tamanho;
+    }
+
+    Estimativa estimar(Classe classe) const {
+        Estimativa estimativa;
+        if (registrados == 0) {
+            return estimativa;
+        }
+        const auto& a = acumuladores[classe];
+        double n = static_cast<double>(registrados);
+        double N = static_cast<double>(totalBlocos);
+        double media = a.soma / n;
+        estimativa.valor = N * media;
+        if (a.soma == 0 && registrados < totalBlocos) {
+            // Nenhuma ocorrência na amostra: a variância amostral é zero, mas o total não é
+            // conhecido. Regra dos três (generalizada): média por bloco <= -ln(1 - confiança) / n
+            estimativa.meiaLargura = N * -std::log(1 - parametros.confianca) / n;
+        } else if (registrados > 1 && registrados < totalBlocos) {
+            double variancia = std::max(0.0, (a.somaQuadrados - n * media * media) / (n - 1));
+            estimativa.meiaLargura = z * N * std::sqrt((1 - n / N) * variancia / n);
+        }
+        return estimativa;
+    }
+
+    // Erro relativo atual da classe. Sem ocorrências na amostra não há erro relativo: a classe
+    // conta como atingida quando o limite superior da regra dos três cabe em 'erro' do texto
+    // (a classe é no máximo essa fração dos bytes)
+    double erroRelativo(Classe classe) const {
+        Estimativa e = estimar(classe);
+        if (e.meiaLargura == 0) return 0;
+        if (acumuladores[classe].soma == 0) {
+            return tamanhoTexto > 0 ? e.meiaLargura / static_cast<double>(tamanhoTexto) : 0;
+        }
+        return e.valor > 0 ? e.meiaLargura / e.valor : INFINITY;
+    }
+
+    bool atingiuErro() const {
+        if (registrados < std::min(parametros.blocosPiloto, totalBlocos)) {
+            return false;
+        }
+        for (size_t c = 0; c < numClasses; ++c) {
+            if (erroRelativo(static_cast<Classe>(c)) > parametros.erroRelativo) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Tamanho total de amostra que, com a variância observada, atinge o erro pedido:
+    // n0 = (z * s / (erro * média))², corrigido para a população finita
+    size_t blocosNecessarios() const {
+        if (registrados < 2) {
+            return std::min(parametros.blocosPiloto, totalBlocos);
+        }
+        double n = static_cast<double>(registrados);
+        double N = static_cast<double>(totalBlocos);
+        double necessario = n;
+        for (const auto& a : acumuladores) {
+            double media = a.soma / n;
+            double variancia = std::max(0.0, (a.somaQuadrados - n * media * media) / (n - 1));
+            if (media <= 0) {
+                // Limite da regra dos três abaixo de 'erro' do texto: N * L / n <= erro * bytes
+                double bytesTexto = static_cast<double>(std::max<size_t>(1, tamanhoTexto));
+                necessario = std::max(necessario, N * -std::log(1 - parametros.confianca)
+                                                      / (parametros.erroRelativo * bytesTexto));
+                continue;
+            }
+            double n0 = std::pow(z * std::sqrt(variancia) / (parametros.erroRelativo * media), 2);
+            necessario = std::max(necessario, n0 / (1 + n0 / N));
+        }
+        return std::min(totalBlocos, static_cast<size_t>(std::ceil(necessario)));
+    }
+
+    Json::Value intervalo(Classe classe) const {
+        Estimativa e = estimar(classe);
+        Json::Value json;
+        json["estimativa"] = e.valor;
+        json["minimo"] = std::max(0.0, e.valor - e.meiaLargura);
+        json["maximo"] = e.valor + e.meiaLargura;
+        // Sem ocorrências na amostra o intervalo é [0, limite da regra dos três] e não há erro relativo
+        json["erro_relativo"] = e.valor > 0 ? Json::Value(e.meiaLargura / e.valor)
+                                : e.meiaLargura > 0 ? Json::Value(Json::nullValue) : Json::Value(0.0);
+        return json;
+    }
+};
+
+#endif // AMOSTRAGEM_APROXIMADA_H
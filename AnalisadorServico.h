@@ -0,0 +1,244 @@
+#ifndef ANALISADOR_SERVICO_H
+#define ANALISADOR_SERVICO_H
+
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "AfinidadeCpu.h"
+#include "AgrupadorLotes.h"
+#include "ArenaRequisicao.h"
+#include "ClassesCaracteres.h"
+#include "ExecucaoServidor.h"
+#include "JsonIncremental.h"
+#include "Rastreamento.h"
+#include "Registro.h"
+
+// Serviço escravo genérico: expõe a rota da política (ex.: /letras) e /health,
+// contando os caracteres da classe com o kernel especializado contarClasse<Politica>.
+// O corpo é contado à medida que chega (JsonIncremental.h), sem ser guardado inteiro.
+template <typename Politica>
+class AnalisadorServico {
+private:
+    // Receptor do LeitorTextoJson: cada trecho decodificado é contado e descartado
+    struct ContagemIncremental {
+        std::pmr::vector<uint64_t> quantidades;
+        std::pmr::string textoAgrupado; // texto pequeno guardado para o agrupador
+        bool agrupar = false;
+        uint64_t quantidadeTexto = 0;
+        uint64_t tamanhoTexto = 0;
+
+        explicit ContagemIncremental(std::pmr::memory_resource* memoria)
+            : quantidades(memoria), textoAgrupado(memoria) {}
+
+        void texto(const char* dados, size_t tamanho) {
+            tamanhoTexto += tamanho;
+            if (agrupar) {
+                textoAgrupado.append(dados, tamanho);
+            } else {
+                quantidadeTexto += contarClasse<Politica>(dados, tamanho);
+            }
+        }
+
+        void inicioFragmento() {
+            quantidades.push_back(0);
+        }
+
+        void fragmento(const char* dados, size_t tamanho) {
+            quantidades.back() += contarClasse<Politica>(dados, tamanho);
+        }
+    };
+
+    httplib::Server servidor;
+    std::atomic<int> emAndamento{0};
+    std::atomic<uint64_t> requisicoes{0};
+    MedidorAlocacoes alocacoes;
+    AgrupadorLotes<Politica> agrupador;
+    RegistroMestre registro;
+
+public:
+    AnalisadorServico()
+        : registro(Politica::tipo, Politica::porta, [this]() { return carga(); }) {
+        // O corpo não fica em memória: o tamanho aceito não precisa de limite
+        servidor.set_payload_max_length((std::numeric_limits<size_t>::max)());
+        configurarRotas();
+    }
+
+    // Carga informada ao Mestre nos heartbeats
+    Json::Value carga() const {
+        Json::Value c;
+        c["em_andamento"] = emAndamento.load();
+        c["requisicoes"] = Json::Value::UInt64(requisicoes.load());
+        return c;
+    }
+
+    void configurarRotas() {
+        // Endpoint de contagem da classe de caracteres
+        servidor.Post(Politica::rota, [this](const httplib::Request& req, httplib::Response& res,
+                                             const httplib::ContentReader& leitor) {
+            this->contar(req, res, leitor);
+        });
+
+        // Health check
+        servidor.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+            Json::Value resposta;
+            resposta["status"] = "ok";
+            resposta["servico"] = Politica::servico;
+            resposta["funcionalidade"] = Politica::funcionalidade;
+            resposta["alocacoes"] = alocacoes.estado();
+            resposta["lotes"] = agrupador.estado();
+            resposta["afinidade"] = AfinidadeCpu::instancia().estado();
+
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+        });
+    }
+
+    uint64_t contarTexto(const std::string& texto) {
+        return contarClasse<Politica>(texto);
+    }
+
+    void contar(const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& leitor) {
+        emAndamento++;
+        requisicoes++;
+        struct Pendente {
+            std::atomic<int>& contador;
+            ~Pendente() { contador--; }
+        } pendente{emAndamento};
+
+        // Id e amostragem vêm do Mestre; os tempos voltam em "timings" quando há id
+        Rastro rastro(idRequisicaoRecebido(req.get_header_value(cabecalhoRequestId)),
+                      Politica::servico, req.get_header_value(cabecalhoAmostrado) == "1");
+
+        // A arena vem antes de tudo que a usa: é destruída por último
+        MedidorAlocacoes::Medicao medicaoAlocacoes(alocacoes);
+        ArenaRequisicao arena;
+
+        try {
+            // Corpo pequeno (Content-Length conhecido) pode ir ao agrupador: o texto é guardado,
+            // na arena, e contado com os das requisições simultâneas
+            ContagemIncremental contagem(arena.memoria());
+            std::string declarado = req.get_header_value("Content-Length");
+            contagem.agrupar = !declarado.empty() && agrupador.aceita(std::strtoull(declarado.c_str(), nullptr, 10));
+            if (contagem.agrupar) {
+                contagem.textoAgrupado.reserve(std::strtoull(declarado.c_str(), nullptr, 10));
+            }
+
+            // Leitura, decodificação e contagem acontecem juntas, pedaço a pedaço
+            auto medicaoLeitura = rastro.medir("leitura");
+            LeitorTextoJson<ContagemIncremental> leitorJson(contagem);
+            bool lido = leitor([&](const char* dados, size_t tamanho) {
+                return leitorJson.alimentar(dados, tamanho);
+            });
+            if (!lido || !leitorJson.concluir()) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            medicaoLeitura.encerrar();
+
+            // Lote opcional: {"fragmentos": ["...", ...]} conta cada fragmento separadamente
+            // e devolve "quantidades" na mesma ordem, além do total em "quantidade"
+            bool lote = leitorJson.lote();
+            const auto& quantidades = contagem.quantidades;
+            uint64_t quantidade = 0;
+            if (lote) {
+                std::cout << Politica::nome << ": Contados " << Politica::rotulo << " em lote de "
+                         << quantidades.size() << " fragmentos (" << leitorJson.bytes() << " bytes)" << std::endl;
+                for (uint64_t q : quantidades) {
+                    quantidade += q;
+                }
+            } else if (contagem.agrupar && contagem.tamanhoTexto > 0) {
+                // Texto pequeno: espera a janela de agrupamento e é contado com as simultâneas
+                std::cout << Politica::nome << ": Contando " << Politica::rotulo << " em texto de "
+                         << contagem.tamanhoTexto << " caracteres..." << std::endl;
+                auto medicaoContagem = rastro.medir("contagem");
+                quantidade = agrupador.contar(contagem.textoAgrupado.data(), contagem.textoAgrupado.size());
+            } else {
+                std::cout << Politica::nome << ": Contados " << Politica::rotulo << " em texto de "
+                         << contagem.tamanhoTexto << " caracteres recebido em stream" << std::endl;
+                quantidade = contagem.quantidadeTexto;
+            }
+
+            // Constrói a resposta na arena; só a cópia final para res.body vai ao alocador global
+            std::pmr::string resposta(arena.memoria());
+            resposta.reserve(256 + quantidades.size() * 8);
+            resposta += "{\"quantidade\":";
+            anexarJsonNumero(resposta, quantidade);
+            if (lote) {
+                resposta += ",\"quantidades\":[";
+                for (size_t i = 0; i < quantidades.size(); ++i) {
+                    if (i > 0) resposta += ',';
+                    anexarJsonNumero(resposta, quantidades[i]);
+                }
+                resposta += ']';
+            }
+            resposta += ",\"tipo\":";
+            anexarJsonString(resposta, Politica::tipo, std::strlen(Politica::tipo));
+            resposta += ",\"processado_por\":";
+            anexarJsonString(resposta, Politica::processadoPor, std::strlen(Politica::processadoPor));
+            resposta += ",\"timestamp\":";
+            anexarJsonNumero(resposta, static_cast<uint64_t>(std::time(nullptr)));
+            if (req.has_header(cabecalhoRequestId)) {
+                resposta += ",\"timings\":";
+                resposta += Json::writeString(escritorJson(), rastro.timings());
+            }
+            resposta += '}';
+            res.set_content(resposta.data(), resposta.size(), "application/json");
+
+            std::cout << Politica::nome << ": " << Politica::encontrados << " " << quantidade
+                     << " " << Politica::rotulo << std::endl;
+
+        } catch (const std::exception& e) {
+            std::cerr << Politica::nome << " - Erro: " << e.what() << std::endl;
+
+            Json::Value erro;
+            erro["erro"] = e.what();
+            erro["servico"] = Politica::processadoPor;
+
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+
+    int iniciar(int porta = Politica::porta) {
+        std::cout << Politica::nome << " (" << Politica::funcionalidade << ") iniciando na porta "
+                 << porta << std::endl;
+        // Ao encerrar, sai do Mestre antes de drenar para não receber novas requisições
+        // Só tipos com grupo no Mestre se registram: os demais seriam recusados a cada heartbeat
+        ExecucaoServidor execucao(servidor, Politica::nome, porta,
+                                  [this]() {
+                                      if (Politica::roteadoPeloMestre) registro.iniciar();
+                                  },
+                                  [this]() { registro.parar(); });
+        return execucao.executar();
+    }
+
+    void parar() {
+        registro.parar();
+        servidor.stop();
+    }
+};
+
+// Corpo comum do main() de cada escravo
+template <typename Politica>
+int executarAnalisador() {
+    try {
+        AnalisadorServico<Politica> escravo;
+
+        // SIGINT/SIGTERM são tratados por ExecucaoServidor (encerramento com drenagem)
+        return escravo.iniciar(Politica::porta);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Erro fatal no " << Politica::nome << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif // ANALISADOR_SERVICO_H
@@ -0,0 +1,240 @@
+#ifndef ARENA_REQUISICAO_H
+#define ARENA_REQUISICAO_H
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+// Alocação por requisição no caminho quente (parse e construção das respostas):
+//
+// - ArenaRequisicao: std::pmr::monotonic_buffer_resource sobre um bloco reaproveitado de um
+//   pool por thread; liberar é só devolver o bloco. Se a requisição excede o bloco, o excesso
+//   vai ao alocador global e o próximo bloco daquela thread cresce (até ARENA_MAXIMO_BYTES).
+//   Só o que é pmr (std::pmr::string/vector) usa a arena: árvores Json::Value, o
+//   StreamWriterBuilder e os corpos std::string do httplib não aceitam alocador e continuam no
+//   alocador global, e é isso que "alocacoes.por_requisicao" ainda mede.
+// - MedidorAlocacoes: alocações globais (operator new) por requisição, somando as threads de
+//   fan-out; só conta de fato quando o executável inclui ContagemAlocacoes.h.
+// - lerJson / escritorJson / anexarJsonString: parse e escrita sem cópias extras do corpo.
+
+// Incrementado pelo operator new substituto de ContagemAlocacoes.h
+inline thread_local uint64_t alocacoesThread = 0;
+inline std::atomic<bool> contagemAlocacoesAtiva{false};
+
+struct EstatisticasArenas {
+    std::atomic<uint64_t> usadas{0};
+    std::atomic<uint64_t> excedidas{0};
+    std::atomic<uint64_t> bytesExcedentes{0};
+
+    static EstatisticasArenas& instancia() {
+        static EstatisticasArenas estatisticas;
+        return estatisticas;
+    }
+};
+
+// Blocos livres de uma thread; arenas aninhadas na mesma thread usam blocos distintos
+class PoolArenas {
+private:
+    std::vector<std::unique_ptr<char[]>> livres;
+    size_t tamanhoBloco = 64 * 1024;
+    size_t tamanhoMaximo;
+
+    PoolArenas() {
+        const char* valor = std::getenv("ARENA_MAXIMO_BYTES");
+        tamanhoMaximo = valor ? std::strtoull(valor, nullptr, 10) : 4 * 1024 * 1024;
+        tamanhoBloco = std::min(tamanhoBloco, tamanhoMaximo);
+    }
+
+public:
+    static PoolArenas& daThread() {
+        thread_local PoolArenas pool;
+        return pool;
+    }
+
+    size_t tamanho() const { return tamanhoBloco; }
+
+    std::unique_ptr<char[]> retirar() {
+        if (livres.empty()) {
+            return std::unique_ptr<char[]>(new char[tamanhoBloco]);
+        }
+        auto bloco = std::move(livres.back());
+        livres.pop_back();
+        return bloco;
+    }
+
+    // Blocos de tamanho antigo são descartados depois de um crescimento
+    void devolver(std::unique_ptr<char[]> bloco, size_t capacidade, size_t excedente) {
+        if (excedente > 0 && tamanhoBloco < tamanhoMaximo) {
+            tamanhoBloco = std::min(tamanhoMaximo, std::max(tamanhoBloco * 2, capacidade + excedente));
+            livres.clear();
+            return;
+        }
+        if (capacidade == tamanhoBloco && livres.size() < 4) {
+            livres.push_back(std::move(bloco));
+        }
+    }
+};
+
+class ArenaRequisicao {
+private:
+    // Repassa ao alocador global contando o que não coube no bloco
+    class RecursoExcedente : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t tamanho, size_t alinhamento) override {
+            bytes += tamanho;
+            return std::pmr::new_delete_resource()->allocate(tamanho, alinhamento);
+        }
+        void do_deallocate(void* p, size_t tamanho, size_t alinhamento) override {
+            std::pmr::new_delete_resource()->deallocate(p, tamanho, alinhamento);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& outro) const noexcept override {
+            return this == &outro;
+        }
+    };
+
+    PoolArenas& pool;
+    size_t capacidade;
+    std::unique_ptr<char[]> bloco;
+    RecursoExcedente excedente;
+    std::pmr::monotonic_buffer_resource recurso;
+
+public:
+    ArenaRequisicao()
+        : pool(PoolArenas::daThread()), capacidade(pool.tamanho()), bloco(pool.retirar()),
+          recurso(bloco.get(), capacidade, &excedente) {
+        EstatisticasArenas::instancia().usadas.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ArenaRequisicao() {
+        recurso.release();
+        if (excedente.bytes > 0) {
+            auto& estatisticas = EstatisticasArenas::instancia();
+            estatisticas.excedidas.fetch_add(1, std::memory_order_relaxed);
+            estatisticas.bytesExcedentes.fetch_add(excedente.bytes, std::memory_order_relaxed);
+        }
+        pool.devolver(std::move(bloco), capacidade, excedente.bytes);
+    }
+
+    ArenaRequisicao(const ArenaRequisicao&) = delete;
+    ArenaRequisicao& operator=(const ArenaRequisicao&) = delete;
+
+    std::pmr::memory_resource* memoria() { return &recurso; }
+};
+
+class MedidorAlocacoes {
+private:
+    std::atomic<uint64_t> requisicoes{0};
+    std::atomic<uint64_t> alocacoes{0};
+    std::atomic<uint64_t> ultima{0};
+
+public:
+    // Mede as alocações da thread atual durante o escopo. Threads auxiliares da mesma
+    // requisição (fan-out) usam contarRequisicao = false para só somar as suas alocações.
+    class Medicao {
+    private:
+        MedidorAlocacoes& medidor;
+        uint64_t inicio;
+        bool contarRequisicao;
+
+    public:
+        explicit Medicao(MedidorAlocacoes& m, bool contar = true)
+            : medidor(m), inicio(alocacoesThread), contarRequisicao(contar) {}
+
+        ~Medicao() {
+            uint64_t delta = alocacoesThread - inicio;
+            medidor.alocacoes.fetch_add(delta, std::memory_order_relaxed);
+            if (contarRequisicao) {
+                medidor.requisicoes.fetch_add(1, std::memory_order_relaxed);
+                medidor.ultima.store(delta, std::memory_order_relaxed);
+            }
+        }
+
+        Medicao(const Medicao&) = delete;
+        Medicao& operator=(const Medicao&) = delete;
+    };
+
+    void zerar() {
+        requisicoes = 0;
+        alocacoes = 0;
+        ultima = 0;
+    }
+
+    Json::Value estado() const {
+        const auto& arenas = EstatisticasArenas::instancia();
+        uint64_t total = requisicoes.load();
+        Json::Value e;
+        e["contagem_ativa"] = contagemAlocacoesAtiva.load();
+        e["requisicoes"] = Json::Value::UInt64(total);
+        e["por_requisicao"] = total > 0 ? static_cast<double>(alocacoes.load()) / total : 0.0;
+        e["ultima_requisicao"] = Json::Value::UInt64(ultima.load());
+        e["arenas_usadas"] = Json::Value::UInt64(arenas.usadas.load());
+        e["arenas_excedidas"] = Json::Value::UInt64(arenas.excedidas.load());
+        e["bytes_excedentes"] = Json::Value::UInt64(arenas.bytesExcedentes.load());
+        return e;
+    }
+};
+
+// Parse com um Reader por thread, sem a cópia do documento que Reader::parse(std::string) faz
+inline bool lerJson(const std::string& corpo, Json::Value& destino) {
+    thread_local Json::Reader reader;
+    return reader.parse(corpo.data(), corpo.data() + corpo.size(), destino, false);
+}
+
+// Escritor compacto criado uma vez por thread (o construtor monta um Json::Value de opções)
+inline const Json::StreamWriterBuilder& escritorJson() {
+    thread_local Json::StreamWriterBuilder builder = []() {
+        Json::StreamWriterBuilder b;
+        b["indentation"] = "";
+        return b;
+    }();
+    return builder;
+}
+
+// Acrescenta 'texto' como string JSON (com aspas) ao destino
+template <typename String>
+inline void anexarJsonString(String& destino, const char* texto, size_t tamanho) {
+    static const char hexa[] = "0123456789abcdef";
+    destino.push_back('"');
+    const char* trecho = texto;
+    const char* fim = texto + tamanho;
+    for (const char* p = texto; p < fim; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        destino.append(trecho, p - trecho);
+        trecho = p + 1;
+        switch (c) {
+            case '"': destino.append("\\\""); break;
+            case '\\': destino.append("\\\\"); break;
+            case '\n': destino.append("\\n"); break;
+            case '\r': destino.append("\\r"); break;
+            case '\t': destino.append("\\t"); break;
+            default: {
+                char escape[] = {'\\', 'u', '0', '0', hexa[c >> 4], hexa[c & 0xF]};
+                destino.append(escape, sizeof(escape));
+            }
+        }
+    }
+    destino.append(trecho, fim - trecho);
+    destino.push_back('"');
+}
+
+template <typename String>
+inline void anexarJsonNumero(String& destino, uint64_t valor) {
+    char buffer[24];
+    auto fim = std::to_chars(buffer, buffer + sizeof(buffer), valor).ptr;
+    destino.append(buffer, fim - buffer);
+}
+
+#endif // ARENA_REQUISICAO_H
@@ -0,0 +1,748 @@
+#ifndef ARMAZEM_RESULTADOS_H
+#define ARMAZEM_RESULTADOS_H
+
+#include <iostream>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+#include "Fragmentacao.h"
+
+// Resultados persistentes por hash de conteúdo (ver Fragmentacao.h), para que o Mestre
+// volte "quente" depois de reiniciar. Arquivos em ARMAZEM_DIR:
+//
+//   resultados.log   registros de tamanho fixo, só acrescentados (append-only)
+//   resultados.idx   tabela hash de endereçamento aberto, mapeada em memória: hash -> posição no log
+//   resultados.lock  flock que serializa as escritas entre processos (PROCESSOS > 1)
+//   compactacao.lock flock que garante uma compactação por vez entre os processos
+//
+// Ao abrir, o índice é só mapeado; apenas os registros gravados depois da última atualização do
+// índice (queda entre as duas escritas) são reindexados. Se o índice não corresponde ao log, é
+// reconstruído a partir dele. A compactação roda em segundo plano: reescreve o log apenas com os
+// registros vivos (sem duplicados e, acima de ARMAZEM_MAX_REGISTROS, sem os mais antigos) e troca
+// os arquivos por rename. Quem troca os arquivos marca o cabeçalho do índice antigo; os demais
+// processos percebem a marca e reabrem.
+//
+// Variáveis de ambiente:
+//   ARMAZEM_DIR            diretório dos arquivos (padrão: dados; vazio desativa o armazém)
+//   ARMAZEM_MAX_REGISTROS  registros vivos mantidos (padrão: 10000000)
+class ArmazemResultados {
+public:
+    struct Resultado {
+        uint64_t letras = 0;
+        uint64_t numeros = 0;
+        uint64_t bytes = 0;
+        int64_t timestamp = 0;
+    };
+
+private:
+    static constexpr uint64_t magiaLog = 0x31304c474f4c5241ULL;    // "ARLOGL01"
+    static constexpr uint64_t magiaIndice = 0x31304c5844495241ULL; // "ARIDXL01"
+
+    struct CabecalhoLog {
+        uint64_t magia;
+        uint64_t identidade; // muda a cada compactação; o índice guarda a do log que indexa
+        uint64_t reservado[2];
+    };
+
+    struct Registro {
+        uint64_t chave[2];
+        uint64_t letras;
+        uint64_t numeros;
+        uint64_t bytes;
+        int64_t timestamp;
+        uint64_t verificacao;
+    };
+
+    struct CabecalhoIndice {
+        uint64_t magia;
+        uint64_t identidade;
+        uint64_t capacidade; // potência de 2
+        uint64_t ocupados;
+        uint64_t fimLog;     // bytes do log já refletidos no índice
+        uint32_t substituido; // 1: arquivos trocados por outro processo, reabrir
+        uint32_t reservado;
+        uint64_t reservado2[2];
+    };
+
+    // posicao = deslocamento do registro no log + 1 (0 = posição vazia)
+    struct Posicao {
+        uint64_t chave[2];
+        uint64_t posicao;
+    };
+
+    struct Indice {
+        int fd = -1;
+        void* mapa = nullptr;
+        size_t tamanho = 0;
+        CabecalhoIndice* cabecalho = nullptr;
+        Posicao* posicoes = nullptr;
+    };
+
+    class TravaArquivo {
+    private:
+        int fd;
+
+    public:
+        explicit TravaArquivo(int f) : fd(f) {
+            while (flock(fd, LOCK_EX) != 0 && errno == EINTR) {
+            }
+        }
+        ~TravaArquivo() { flock(fd, LOCK_UN); }
+    };
+
+    std::string diretorio;
+    uint64_t maxRegistros;
+
+    // Ordem de aquisição: escrita -> flock -> mapa
+    std::mutex escrita;
+    mutable std::shared_mutex mapa; // leitores compartilham; troca de arquivos é exclusiva
+    int fdTrava = -1;
+    int fdTravaCompactacao = -1;
+    int fdLog = -1;
+    Indice indice;
+    std::atomic<bool> aberto{false};
+
+    std::thread threadCompactacao;
+    std::mutex mutexCompactacao;
+    std::condition_variable cvCompactacao;
+    bool compactacaoAtiva = false;
+
+    std::atomic<uint64_t> acertos{0};
+    std::atomic<uint64_t> faltas{0};
+    std::atomic<uint64_t> gravados{0};
+    std::atomic<uint64_t> compactacoes{0};
+    double aberturaMs = 0.0;
+    std::string modoAbertura;
+
+    std::string caminho(const char* nome) const { return diretorio + "/" + nome; }
+
+    static bool converterChave(const std::string& hash, uint64_t chave[2]) {
+        if (hash.size() != 32) {
+            return false;
+        }
+        for (char c : hash) {
+            if (!std::isxdigit(static_cast<unsigned char>(c))) return false;
+        }
+        chave[0] = std::strtoull(hash.substr(0, 16).c_str(), nullptr, 16);
+        chave[1] = std::strtoull(hash.substr(16).c_str(), nullptr, 16);
+        return true;
+    }
+
+    static uint64_t verificacao(const Registro& r) {
+        uint64_t v = misturar64(r.chave[0] ^ 0x9e3779b97f4a7c15ULL);
+        for (uint64_t campo : {r.chave[1], r.letras, r.numeros, r.bytes, static_cast<uint64_t>(r.timestamp)}) {
+            v = misturar64(v ^ campo);
+        }
+        return v | 1;
+    }
+
+    static bool lerTudo(int fd, void* destino, size_t tamanho, uint64_t deslocamento) {
+        char* p = static_cast<char*>(destino);
+        while (tamanho > 0) {
+            ssize_t lidos = pread(fd, p, tamanho, deslocamento);
+            if (lidos <= 0) {
+                if (lidos < 0 && errno == EINTR) continue;
+                return false;
+            }
+            p += lidos;
+            tamanho -= lidos;
+            deslocamento += lidos;
+        }
+        return true;
+    }
+
+    static bool escreverTudo(int fd, const void* origem, size_t tamanho, uint64_t deslocamento) {
+        const char* p = static_cast<const char*>(origem);
+        while (tamanho > 0) {
+            ssize_t escritos = pwrite(fd, p, tamanho, deslocamento);
+            if (escritos <= 0) {
+                if (escritos < 0 && errno == EINTR) continue;
+                return false;
+            }
+            p += escritos;
+            tamanho -= escritos;
+            deslocamento += escritos;
+        }
+        return true;
+    }
+
+    static uint64_t tamanhoArquivo(int fd) {
+        struct stat st {};
+        return fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    }
+
+    static uint64_t novaIdentidade() {
+        std::random_device aleatorio;
+        return (static_cast<uint64_t>(aleatorio()) << 32) ^ aleatorio() ^
+               static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    // --- Índice mapeado ---
+
+    static void desmapear(Indice& i) {
+        if (i.mapa) munmap(i.mapa, i.tamanho);
+        if (i.fd >= 0) close(i.fd);
+        i = Indice{};
+    }
+
+    static bool mapear(int fd, Indice& i) {
+        uint64_t tamanho = tamanhoArquivo(fd);
+        if (tamanho < sizeof(CabecalhoIndice)) {
+            close(fd);
+            return false;
+        }
+        void* mapa = mmap(nullptr, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapa == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        i.fd = fd;
+        i.mapa = mapa;
+        i.tamanho = tamanho;
+        i.cabecalho = static_cast<CabecalhoIndice*>(mapa);
+        i.posicoes = reinterpret_cast<Posicao*>(static_cast<char*>(mapa) + sizeof(CabecalhoIndice));
+        uint64_t capacidade = i.cabecalho->capacidade;
+        bool valido = i.cabecalho->magia == magiaIndice && capacidade > 0 && (capacidade & (capacidade - 1)) == 0 &&
+                      tamanho == sizeof(CabecalhoIndice) + capacidade * sizeof(Posicao);
+        if (!valido) {
+            desmapear(i);
+        }
+        return valido;
+    }
+
+    // Cria um índice vazio em 'arquivo' (arquivo temporário, depois renomeado)
+    static bool criarIndice(const std::string& arquivo, uint64_t capacidade, uint64_t identidade, Indice& i) {
+        int fd = open(arquivo.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, sizeof(CabecalhoIndice) + capacidade * sizeof(Posicao)) != 0) {
+            close(fd);
+            return false;
+        }
+        CabecalhoIndice cabecalho{};
+        cabecalho.magia = magiaIndice;
+        cabecalho.identidade = identidade;
+        cabecalho.capacidade = capacidade;
+        cabecalho.fimLog = sizeof(CabecalhoLog);
+        if (!escreverTudo(fd, &cabecalho, sizeof(cabecalho), 0)) {
+            close(fd);
+            return false;
+        }
+        return mapear(fd, i);
+    }
+
+    static uint64_t capacidadePara(uint64_t registros) {
+        uint64_t capacidade = 1024;
+        while (capacidade * 7 / 10 < registros + 1) capacidade *= 2;
+        return capacidade;
+    }
+
+    // Leitores de outras threads/processos leem sem trava: a chave é escrita antes da posição
+    static uint64_t procurar(const Indice& i, const uint64_t chave[2]) {
+        uint64_t mascara = i.cabecalho->capacidade - 1;
+        for (uint64_t n = 0, p = chave[0] & mascara; n <= mascara; ++n, p = (p + 1) & mascara) {
+            uint64_t posicao = __atomic_load_n(&i.posicoes[p].posicao, __ATOMIC_ACQUIRE);
+            if (posicao == 0) {
+                return 0;
+            }
+            if (i.posicoes[p].chave[0] == chave[0] && i.posicoes[p].chave[1] == chave[1]) {
+                return posicao;
+            }
+        }
+        return 0;
+    }
+
+    static void inserir(Indice& i, const uint64_t chave[2], uint64_t deslocamento) {
+        uint64_t mascara = i.cabecalho->capacidade - 1;
+        for (uint64_t p = chave[0] & mascara;; p = (p + 1) & mascara) {
+            Posicao& posicao = i.posicoes[p];
+            if (__atomic_load_n(&posicao.posicao, __ATOMIC_ACQUIRE) == 0) {
+                posicao.chave[0] = chave[0];
+                posicao.chave[1] = chave[1];
+                __atomic_store_n(&posicao.posicao, deslocamento + 1, __ATOMIC_RELEASE);
+                ++i.cabecalho->ocupados;
+                return;
+            }
+            if (posicao.chave[0] == chave[0] && posicao.chave[1] == chave[1]) {
+                __atomic_store_n(&posicao.posicao, deslocamento + 1, __ATOMIC_RELEASE);
+                return;
+            }
+        }
+    }
+
+    // Indexa os registros íntegros de [inicio, fim); para no primeiro registro incompleto
+    static uint64_t indexarLog(int fd, Indice& i, uint64_t inicio, uint64_t fim) {
+        std::vector<Registro> bloco(4096);
+        uint64_t posicao = inicio;
+        while (posicao + sizeof(Registro) <= fim) {
+            size_t quantidade = std::min<uint64_t>(bloco.size(), (fim - posicao) / sizeof(Registro));
+            if (!lerTudo(fd, bloco.data(), quantidade * sizeof(Registro), posicao)) {
+                break;
+            }
+            for (size_t k = 0; k < quantidade; ++k) {
+                if (bloco[k].verificacao != verificacao(bloco[k])) {
+                    return posicao;
+                }
+                inserir(i, bloco[k].chave, posicao);
+                posicao += sizeof(Registro);
+            }
+        }
+        return posicao;
+    }
+
+    // --- Abertura (com flock e 'mapa' exclusivo) ---
+
+    void fecharArquivos() {
+        desmapear(indice);
+        if (fdLog >= 0) close(fdLog);
+        fdLog = -1;
+    }
+
+    bool abrirArquivos() {
+        fecharArquivos();
+
+        fdLog = open(caminho("resultados.log").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fdLog < 0) {
+            return false;
+        }
+        CabecalhoLog cabecalhoLog{};
+        uint64_t tamanhoLog = tamanhoArquivo(fdLog);
+        bool novo = tamanhoLog < sizeof(CabecalhoLog);
+        if (novo) {
+            cabecalhoLog.magia = magiaLog;
+            cabecalhoLog.identidade = novaIdentidade();
+            if (!escreverTudo(fdLog, &cabecalhoLog, sizeof(cabecalhoLog), 0) ||
+                ftruncate(fdLog, sizeof(cabecalhoLog)) != 0) {
+                return false;
+            }
+            tamanhoLog = sizeof(cabecalhoLog);
+        } else if (!lerTudo(fdLog, &cabecalhoLog, sizeof(cabecalhoLog), 0) || cabecalhoLog.magia != magiaLog) {
+            std::cerr << "Armazém de resultados: " << caminho("resultados.log") << " não é um log válido" << std::endl;
+            return false;
+        }
+
+        int fdIndice = open(caminho("resultados.idx").c_str(), O_RDWR | O_CLOEXEC);
+        bool mapeado = fdIndice >= 0 && mapear(fdIndice, indice);
+        // A cauda a reindexar também precisa caber no índice mapeado
+        if (mapeado && (indice.cabecalho->identidade != cabecalhoLog.identidade ||
+                        indice.cabecalho->fimLog > tamanhoLog || substituido(indice) ||
+                        indice.cabecalho->ocupados + (tamanhoLog - indice.cabecalho->fimLog) / sizeof(Registro) >
+                            indice.cabecalho->capacidade * 7 / 10)) {
+            // Outros processos que ainda o usam passam a reabrir
+            marcarSubstituido(indice);
+            desmapear(indice);
+            mapeado = false;
+        }
+
+        if (mapeado) {
+            modoAbertura = "mapeado";
+        } else {
+            // Reconstrução a partir do log
+            uint64_t registros = (tamanhoLog - sizeof(CabecalhoLog)) / sizeof(Registro);
+            std::string temporario = caminho("resultados.idx.tmp");
+            if (!criarIndice(temporario, capacidadePara(registros), cabecalhoLog.identidade, indice)) {
+                return false;
+            }
+            if (std::rename(temporario.c_str(), caminho("resultados.idx").c_str()) != 0) {
+                return false;
+            }
+            modoAbertura = novo ? "novo" : "reconstruido";
+        }
+
+        // Cauda gravada depois da última atualização do índice (ou o log inteiro, se reconstruído)
+        uint64_t fim = indexarLog(fdLog, indice, indice.cabecalho->fimLog, tamanhoLog);
+        indice.cabecalho->fimLog = fim;
+        return true;
+    }
+
+    static bool substituido(const Indice& i) {
+        return __atomic_load_n(&i.cabecalho->substituido, __ATOMIC_ACQUIRE) != 0;
+    }
+
+    static void marcarSubstituido(Indice& i) {
+        __atomic_store_n(&i.cabecalho->substituido, 1u, __ATOMIC_RELEASE);
+    }
+
+    // Chamado com 'escrita' e flock: outro processo trocou os arquivos?
+    void reabrirSeSubstituido() {
+        if (indice.cabecalho && !substituido(indice)) {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(mapa);
+        if (!abrirArquivos()) {
+            aberto = false;
+            std::cerr << "Armazém de resultados: falha ao reabrir, desativado" << std::endl;
+        }
+    }
+
+    // Cópia de 'origem' em um índice novo de 'capacidade' posições
+    static bool copiarIndice(const Indice& origem, const std::string& arquivo, uint64_t capacidade, Indice& destino) {
+        if (!criarIndice(arquivo, capacidade, origem.cabecalho->identidade, destino)) {
+            return false;
+        }
+        for (uint64_t p = 0; p < origem.cabecalho->capacidade; ++p) {
+            const Posicao& posicao = origem.posicoes[p];
+            if (posicao.posicao != 0) {
+                inserir(destino, posicao.chave, posicao.posicao - 1);
+            }
+        }
+        destino.cabecalho->fimLog = origem.cabecalho->fimLog;
+        return true;
+    }
+
+    // Dobra a capacidade do índice (com 'escrita' e flock)
+    bool crescerIndice() {
+        std::unique_lock<std::shared_mutex> lock(mapa);
+        Indice novo;
+        std::string temporario = caminho("resultados.idx.tmp");
+        if (!copiarIndice(indice, temporario, indice.cabecalho->capacidade * 2, novo)) {
+            return false;
+        }
+        if (std::rename(temporario.c_str(), caminho("resultados.idx").c_str()) != 0) {
+            desmapear(novo);
+            return false;
+        }
+        marcarSubstituido(indice);
+        desmapear(indice);
+        indice = novo;
+        return true;
+    }
+
+    // --- Compactação ---
+
+    bool precisaCompactar() const {
+        std::shared_lock<std::shared_mutex> lock(mapa);
+        if (!indice.cabecalho) {
+            return false;
+        }
+        uint64_t registros = (indice.cabecalho->fimLog - sizeof(CabecalhoLog)) / sizeof(Registro);
+        uint64_t vivos = indice.cabecalho->ocupados;
+        return vivos > maxRegistros || (registros >= 1024 && registros - vivos > vivos);
+    }
+
+    // Copia os registros vivos de [inicio, fim) do log atual para o novo log/índice
+    uint64_t copiarVivos(int fdNovoLog, Indice& novo, uint64_t inicio, uint64_t fim, uint64_t& descartar) {
+        std::vector<Registro> bloco(4096);
+        std::vector<Registro> vivos;
+        vivos.reserve(bloco.size());
+        uint64_t posicao = inicio;
+        while (posicao + sizeof(Registro) <= fim) {
+            size_t quantidade = std::min<uint64_t>(bloco.size(), (fim - posicao) / sizeof(Registro));
+            if (!lerTudo(fdLog, bloco.data(), quantidade * sizeof(Registro), posicao)) {
+                break;
+            }
+            vivos.clear();
+            for (size_t k = 0; k < quantidade; ++k, posicao += sizeof(Registro)) {
+                const Registro& r = bloco[k];
+                if (r.verificacao != verificacao(r) || procurar(indice, r.chave) != posicao + 1) {
+                    continue;
+                }
+                if (descartar > 0) {
+                    --descartar; // acima do limite: os mais antigos ficam de fora
+                    continue;
+                }
+                vivos.push_back(r);
+            }
+            uint64_t destino = novo.cabecalho->fimLog;
+            if (!escreverTudo(fdNovoLog, vivos.data(), vivos.size() * sizeof(Registro), destino)) {
+                return 0;
+            }
+            for (const auto& r : vivos) {
+                inserir(novo, r.chave, destino);
+                destino += sizeof(Registro);
+            }
+            novo.cabecalho->fimLog = destino;
+        }
+        return posicao;
+    }
+
+    bool compactar() {
+        // Outro processo já compactando: os arquivos temporários seriam os mesmos
+        if (flock(fdTravaCompactacao, LOCK_EX | LOCK_NB) != 0) {
+            return false;
+        }
+        struct LiberarTrava {
+            int fd;
+            ~LiberarTrava() { flock(fd, LOCK_UN); }
+        } liberar{fdTravaCompactacao};
+
+        auto inicio = std::chrono::steady_clock::now();
+        std::string logTemporario = caminho("resultados.log.tmp");
+        std::string indiceTemporario = caminho("resultados.idx.compactacao");
+        Indice novo;
+        int fdNovoLog = -1;
+        uint64_t registrosAntes = 0;
+        uint64_t copiados = 0;
+        uint64_t identidadeAntiga = 0;
+        auto descartarTemporarios = [&]() {
+            desmapear(novo);
+            if (fdNovoLog >= 0) close(fdNovoLog);
+            unlink(logTemporario.c_str());
+            unlink(indiceTemporario.c_str());
+        };
+
+        // Fase 1, sem bloquear as escritas: copia o que havia até o instante inicial
+        {
+            std::shared_lock<std::shared_mutex> lock(mapa);
+            if (!indice.cabecalho) {
+                return false;
+            }
+            identidadeAntiga = indice.cabecalho->identidade;
+            uint64_t fim = indice.cabecalho->fimLog;
+            uint64_t vivos = indice.cabecalho->ocupados;
+            uint64_t descartar = vivos > maxRegistros ? vivos - maxRegistros * 3 / 4 : 0;
+            registrosAntes = (fim - sizeof(CabecalhoLog)) / sizeof(Registro);
+
+            CabecalhoLog cabecalhoLog{magiaLog, novaIdentidade(), {0, 0}};
+            fdNovoLog = open(logTemporario.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fdNovoLog < 0 || !escreverTudo(fdNovoLog, &cabecalhoLog, sizeof(cabecalhoLog), 0) ||
+                !criarIndice(indiceTemporario, capacidadePara(vivos - descartar), cabecalhoLog.identidade, novo)) {
+                descartarTemporarios();
+                return false;
+            }
+            copiados = copiarVivos(fdNovoLog, novo, sizeof(CabecalhoLog), fim, descartar);
+            if (copiados != fim) {
+                descartarTemporarios();
+                return false;
+            }
+        }
+
+        // Fase 2, com as escritas bloqueadas: o que foi gravado durante a fase 1 e a troca
+        std::lock_guard<std::mutex> lockEscrita(escrita);
+        TravaArquivo trava(fdTrava);
+        std::unique_lock<std::shared_mutex> lock(mapa);
+        if (!indice.cabecalho || substituido(indice) || indice.cabecalho->identidade != identidadeAntiga) {
+            descartarTemporarios();
+            return false;
+        }
+        uint64_t nenhum = 0;
+        uint64_t fim = indice.cabecalho->fimLog;
+        uint64_t necessarios = novo.cabecalho->ocupados + (fim - copiados) / sizeof(Registro);
+        if (necessarios + 1 > novo.cabecalho->capacidade * 7 / 10) {
+            // Muitas gravações durante a fase 1: o índice novo precisa crescer antes da cauda
+            Indice maior;
+            std::string maiorTemporario = indiceTemporario + ".maior";
+            if (!copiarIndice(novo, maiorTemporario, capacidadePara(necessarios), maior) ||
+                std::rename(maiorTemporario.c_str(), indiceTemporario.c_str()) != 0) {
+                desmapear(maior);
+                unlink(maiorTemporario.c_str());
+                descartarTemporarios();
+                return false;
+            }
+            desmapear(novo);
+            novo = maior;
+        }
+        if (copiarVivos(fdNovoLog, novo, copiados, fim, nenhum) != fim) {
+            descartarTemporarios();
+            return false;
+        }
+
+        // Uma queda entre os dois renames deixa identidades diferentes: o índice é reconstruído
+        marcarSubstituido(indice);
+        if (std::rename(logTemporario.c_str(), caminho("resultados.log").c_str()) != 0 ||
+            std::rename(indiceTemporario.c_str(), caminho("resultados.idx").c_str()) != 0) {
+            descartarTemporarios();
+            abrirArquivos();
+            return false;
+        }
+        fecharArquivos();
+        fdLog = fdNovoLog;
+        indice = novo;
+        compactacoes++;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        std::cout << "Armazém de resultados compactado: " << registrosAntes << " -> " << indice.cabecalho->ocupados
+                 << " registros em " << ms << " ms" << std::endl;
+        return true;
+    }
+
+public:
+    ArmazemResultados(std::string pasta, uint64_t maximo)
+        : diretorio(std::move(pasta)), maxRegistros(std::max<uint64_t>(1024, maximo)) {}
+
+    ~ArmazemResultados() {
+        pararCompactacao();
+        std::unique_lock<std::shared_mutex> lock(mapa);
+        fecharArquivos();
+        if (fdTrava >= 0) close(fdTrava);
+        if (fdTravaCompactacao >= 0) close(fdTravaCompactacao);
+    }
+
+    ArmazemResultados(const ArmazemResultados&) = delete;
+    ArmazemResultados& operator=(const ArmazemResultados&) = delete;
+
+    // Abre depois do fork: cada processo precisa do seu próprio descritor para o flock
+    bool abrir() {
+        if (diretorio.empty() || aberto) {
+            return aberto;
+        }
+        auto inicio = std::chrono::steady_clock::now();
+        mkdir(diretorio.c_str(), 0755);
+        fdTrava = open(caminho("resultados.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        fdTravaCompactacao = open(caminho("compactacao.lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fdTrava < 0 || fdTravaCompactacao < 0) {
+            std::cerr << "Armazém de resultados desativado: não foi possível usar " << diretorio << ": "
+                      << std::strerror(errno) << std::endl;
+            return false;
+        }
+        {
+            TravaArquivo trava(fdTrava);
+            std::unique_lock<std::shared_mutex> lock(mapa);
+            if (!abrirArquivos()) {
+                fecharArquivos();
+                std::cerr << "Armazém de resultados desativado: falha ao abrir " << diretorio << std::endl;
+                return false;
+            }
+        }
+        aberturaMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        aberto = true;
+        std::cout << "Armazém de resultados em " << diretorio << ": " << indice.cabecalho->ocupados
+                 << " registros (índice " << modoAbertura << " em " << aberturaMs << " ms)" << std::endl;
+        return true;
+    }
+
+    bool ativo() const {
+        return aberto;
+    }
+
+    bool buscar(const std::string& hash, Resultado& resultado) {
+        uint64_t chave[2];
+        if (!aberto || !converterChave(hash, chave)) {
+            return false;
+        }
+        std::shared_lock<std::shared_mutex> lock(mapa);
+        if (substituido(indice)) {
+            // Outro processo compactou ou cresceu o índice: reabre antes de consultar
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> lockEscrita(escrita);
+                TravaArquivo trava(fdTrava);
+                reabrirSeSubstituido();
+            }
+            if (!aberto) return false;
+            lock.lock();
+        }
+
+        uint64_t posicao = procurar(indice, chave);
+        Registro r{};
+        if (posicao == 0 || !lerTudo(fdLog, &r, sizeof(r), posicao - 1) || r.chave[0] != chave[0] ||
+            r.chave[1] != chave[1] || r.verificacao != verificacao(r)) {
+            faltas++;
+            return false;
+        }
+        acertos++;
+        resultado = {r.letras, r.numeros, r.bytes, r.timestamp};
+        return true;
+    }
+
+    void gravar(const std::string& hash, const Resultado& resultado) {
+        uint64_t chave[2];
+        if (!aberto || !converterChave(hash, chave)) {
+            return;
+        }
+        bool compactar = false;
+        {
+            std::lock_guard<std::mutex> lockEscrita(escrita);
+            TravaArquivo trava(fdTrava);
+            reabrirSeSubstituido();
+            if (!aberto) return;
+            if (indice.cabecalho->ocupados + 1 > indice.cabecalho->capacidade * 7 / 10 && !crescerIndice()) {
+                std::cerr << "Armazém de resultados: falha ao crescer o índice" << std::endl;
+                return;
+            }
+
+            std::shared_lock<std::shared_mutex> lock(mapa);
+            Registro r{{chave[0], chave[1]}, resultado.letras, resultado.numeros, resultado.bytes,
+                       resultado.timestamp, 0};
+            r.verificacao = verificacao(r);
+            // Primeiro o log, depois o índice: uma queda entre os dois é corrigida na abertura
+            uint64_t deslocamento = indice.cabecalho->fimLog;
+            if (!escreverTudo(fdLog, &r, sizeof(r), deslocamento)) {
+                std::cerr << "Armazém de resultados: falha ao gravar: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            inserir(indice, chave, deslocamento);
+            indice.cabecalho->fimLog = deslocamento + sizeof(r);
+            gravados++;
+            uint64_t registros = (indice.cabecalho->fimLog - sizeof(CabecalhoLog)) / sizeof(Registro);
+            uint64_t vivos = indice.cabecalho->ocupados;
+            compactar = vivos > maxRegistros || (registros >= 1024 && registros - vivos > vivos);
+        }
+        if (compactar) {
+            cvCompactacao.notify_one();
+        }
+    }
+
+    void iniciarCompactacao() {
+        if (!aberto) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutexCompactacao);
+            compactacaoAtiva = true;
+        }
+        threadCompactacao = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(mutexCompactacao);
+            while (compactacaoAtiva) {
+                cvCompactacao.wait_for(lock, std::chrono::seconds(60));
+                if (!compactacaoAtiva || !aberto || !precisaCompactar()) {
+                    continue;
+                }
+                lock.unlock();
+                compactar();
+                lock.lock();
+            }
+        });
+    }
+
+    void pararCompactacao() {
+        {
+            std::lock_guard<std::mutex> lock(mutexCompactacao);
+            compactacaoAtiva = false;
+        }
+        cvCompactacao.notify_all();
+        if (threadCompactacao.joinable()) {
+            threadCompactacao.join();
+        }
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["ativo"] = aberto.load();
+        if (!aberto) {
+            return e;
+        }
+        std::shared_lock<std::shared_mutex> lock(mapa);
+        e["diretorio"] = diretorio;
+        e["registros"] = Json::Value::UInt64(indice.cabecalho->ocupados);
+        e["registros_log"] = Json::Value::UInt64((indice.cabecalho->fimLog - sizeof(CabecalhoLog)) / sizeof(Registro));
+        e["capacidade_indice"] = Json::Value::UInt64(indice.cabecalho->capacidade);
+        e["abertura"] = modoAbertura;
+        e["abertura_ms"] = aberturaMs;
+        e["acertos"] = Json::Value::UInt64(acertos.load());
+        e["faltas"] = Json::Value::UInt64(faltas.load());
+        e["gravados"] = Json::Value::UInt64(gravados.load());
+        e["compactacoes"] = Json::Value::UInt64(compactacoes.load());
+        return e;
+    }
+};
+
+#endif // ARMAZEM_RESULTADOS_H
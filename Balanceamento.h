@@ -0,0 +1,345 @@
+#ifndef BALANCEAMENTO_H
+#define BALANCEAMENTO_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+inline int64_t agoraMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Estado vivo de uma réplica de escravo, acompanhado pelo Mestre
+struct Replica {
+    std::string host;
+    int port;
+    bool estatica = true; // configurada por variável de ambiente; não expira sem heartbeat
+    std::atomic<int64_t> ultimoHeartbeatMs{0};
+    std::atomic<int> cargaReportada{0}; // requisições em andamento informadas no último heartbeat
+    std::atomic<int> emAndamento{0};
+    std::atomic<double> latenciaEwmaMs{0.0};
+    std::atomic<double> vazaoEwmaBytesS{0.0}; // observada em fragmentos de texto grande (ver DistribuicaoFragmentos.h)
+    std::atomic<uint64_t> requisicoes{0};
+    std::atomic<uint64_t> falhas{0};
+
+    static constexpr double alfaEwma = 0.2;
+    // Falha entra na EWMA como latência penalizada: uma réplica que falha rápido não pode parecer
+    // a mais rápida. A penalidade é a maior entre o tempo até a falha, um piso e um múltiplo da EWMA
+    static constexpr double penalidadeFalhaMinimaMs = 1000.0;
+    static constexpr double fatorPenalidadeFalha = 4.0;
+
+    Replica(std::string h, int p) : host(std::move(h)), port(p) {}
+
+    void registrarLatencia(double ms) {
+        double atual = latenciaEwmaMs.load(std::memory_order_relaxed);
+        double nova;
+        do {
+            nova = (atual == 0.0) ? ms : atual + alfaEwma * (ms - atual);
+        } while (!latenciaEwmaMs.compare_exchange_weak(atual, nova, std::memory_order_relaxed));
+    }
+
+    void registrarFalha(double ms) {
+        falhas.fetch_add(1, std::memory_order_relaxed);
+        double atual = latenciaEwmaMs.load(std::memory_order_relaxed);
+        registrarLatencia(std::max({ms, penalidadeFalhaMinimaMs, atual * fatorPenalidadeFalha}));
+    }
+
+    void registrarVazao(uint64_t bytes, double ms) {
+        if (bytes == 0 || ms <= 0.0) {
+            return;
+        }
+        double amostra = bytes / (ms / 1000.0);
+        double atual = vazaoEwmaBytesS.load(std::memory_order_relaxed);
+        double nova;
+        do {
+            nova = (atual == 0.0) ? amostra : atual + alfaEwma * (amostra - atual);
+        } while (!vazaoEwmaBytesS.compare_exchange_weak(atual, nova, std::memory_order_relaxed));
+    }
+
+    std::string endereco() const {
+        return host + ":" + std::to_string(port);
+    }
+
+    // Carga considerada pelas políticas: o maior valor entre o que o Mestre observa
+    // e o que a própria réplica informou (que inclui tráfego de outros clientes)
+    int pendentes() const {
+        return std::max(emAndamento.load(std::memory_order_relaxed),
+                        cargaReportada.load(std::memory_order_relaxed));
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["endereco"] = endereco();
+        e["estatica"] = estatica;
+        e["em_andamento"] = emAndamento.load();
+        e["carga_reportada"] = cargaReportada.load();
+        e["latencia_ewma_ms"] = latenciaEwmaMs.load();
+        e["vazao_bytes_s"] = vazaoEwmaBytesS.load();
+        e["requisicoes"] = Json::Value::UInt64(requisicoes.load());
+        e["falhas"] = Json::Value::UInt64(falhas.load());
+        return e;
+    }
+};
+
+using ListaReplicas = std::vector<std::shared_ptr<Replica>>;
+
+// Marca uma requisição em andamento na réplica e registra a latência ao concluir
+class ReservaReplica {
+private:
+    std::shared_ptr<Replica> replica;
+    std::chrono::steady_clock::time_point inicio;
+    bool concluida = false;
+
+public:
+    explicit ReservaReplica(std::shared_ptr<Replica> r)
+        : replica(std::move(r)), inicio(std::chrono::steady_clock::now()) {
+        replica->emAndamento.fetch_add(1, std::memory_order_relaxed);
+        replica->requisicoes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ReservaReplica(const ReservaReplica&) = delete;
+    ReservaReplica& operator=(const ReservaReplica&) = delete;
+
+    // Conclusão com sucesso: a latência observada alimenta a EWMA
+    double concluir() {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        replica->registrarLatencia(ms);
+        replica->emAndamento.fetch_sub(1, std::memory_order_relaxed);
+        concluida = true;
+        return ms;
+    }
+
+    // Sem concluir(): falha, que também alimenta a EWMA (com penalidade)
+    ~ReservaReplica() {
+        if (!concluida) {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+            replica->registrarFalha(ms);
+            replica->emAndamento.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    const Replica& operator*() const { return *replica; }
+    const Replica* operator->() const { return replica.get(); }
+};
+
+class PoliticaBalanceamento {
+public:
+    virtual ~PoliticaBalanceamento() = default;
+    virtual std::shared_ptr<Replica> escolher(const ListaReplicas& replicas) = 0;
+    virtual const char* nome() const = 0;
+};
+
+class BalanceamentoRoundRobin : public PoliticaBalanceamento {
+private:
+    std::atomic<uint64_t> proxima{0};
+
+public:
+    std::shared_ptr<Replica> escolher(const ListaReplicas& replicas) override {
+        return replicas[proxima.fetch_add(1, std::memory_order_relaxed) % replicas.size()];
+    }
+
+    const char* nome() const override { return "round-robin"; }
+};
+
+class BalanceamentoMenosPendentes : public PoliticaBalanceamento {
+private:
+    std::atomic<uint64_t> desempate{0};
+
+public:
+    std::shared_ptr<Replica> escolher(const ListaReplicas& replicas) override {
+        // Começa em posição rotativa para não favorecer sempre a primeira em caso de empate
+        size_t inicio = desempate.fetch_add(1, std::memory_order_relaxed) % replicas.size();
+        std::shared_ptr<Replica> melhor;
+        int menor = 0;
+        for (size_t i = 0; i < replicas.size(); ++i) {
+            const auto& r = replicas[(inicio + i) % replicas.size()];
+            int pendentes = r->pendentes();
+            if (!melhor || pendentes < menor) {
+                melhor = r;
+                menor = pendentes;
+            }
+        }
+        return melhor;
+    }
+
+    const char* nome() const override { return "menos-pendentes"; }
+};
+
+// Power of two choices: sorteia duas réplicas e fica com a de menor custo
+// estimado (latência EWMA ponderada pelas requisições em andamento)
+class BalanceamentoDuasEscolhasEwma : public PoliticaBalanceamento {
+private:
+    static double custo(const Replica& r) {
+        return (r.latenciaEwmaMs.load(std::memory_order_relaxed) + 1.0) * (r.pendentes() + 1);
+    }
+
+public:
+    std::shared_ptr<Replica> escolher(const ListaReplicas& replicas) override {
+        if (replicas.size() == 1) {
+            return replicas[0];
+        }
+        thread_local std::mt19937_64 gerador{std::random_device{}()};
+        std::uniform_int_distribution<size_t> sorteio(0, replicas.size() - 1);
+        size_t a = sorteio(gerador);
+        size_t b = sorteio(gerador);
+        if (a == b) {
+            b = (a + 1) % replicas.size();
+        }
+        return custo(*replicas[a]) <= custo(*replicas[b]) ? replicas[a] : replicas[b];
+    }
+
+    const char* nome() const override { return "p2c-ewma"; }
+};
+
+inline std::unique_ptr<PoliticaBalanceamento> criarPoliticaBalanceamento(const std::string& nome) {
+    if (nome == "round-robin") {
+        return std::make_unique<BalanceamentoRoundRobin>();
+    }
+    if (nome == "menos-pendentes") {
+        return std::make_unique<BalanceamentoMenosPendentes>();
+    }
+    if (nome == "p2c-ewma") {
+        return std::make_unique<BalanceamentoDuasEscolhasEwma>();
+    }
+    throw std::runtime_error("Política de balanceamento desconhecida: " + nome);
+}
+
+// Réplicas de um mesmo tipo de escravo e a política usada para escolher entre elas.
+// A lista de membros é um instantâneo imutável trocado atomicamente (estilo RCU):
+// as threads de requisição apenas carregam o ponteiro atual, sem lock, enquanto
+// registros e expirações montam uma nova lista e a publicam.
+class GrupoReplicas {
+private:
+    std::string nomeGrupo;
+    std::shared_ptr<const ListaReplicas> instantaneo;
+    std::mutex mutexEscrita; // serializa apenas os escritores
+    std::unique_ptr<PoliticaBalanceamento> politica;
+
+    void publicar(ListaReplicas lista) {
+        std::atomic_store(&instantaneo, std::shared_ptr<const ListaReplicas>(
+            std::make_shared<ListaReplicas>(std::move(lista))));
+    }
+
+public:
+    GrupoReplicas(std::string nome, const std::string& enderecos, std::unique_ptr<PoliticaBalanceamento> p)
+        : nomeGrupo(std::move(nome)), politica(std::move(p)) {
+        // Endereços no formato "host:porta,host:porta"
+        ListaReplicas replicas;
+        std::stringstream ss(enderecos);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t separador = item.rfind(':');
+            if (item.empty() || separador == std::string::npos) continue;
+            replicas.push_back(std::make_shared<Replica>(item.substr(0, separador),
+                                                         std::stoi(item.substr(separador + 1))));
+        }
+        publicar(std::move(replicas));
+    }
+
+    std::shared_ptr<const ListaReplicas> membros() const {
+        return std::atomic_load(&instantaneo);
+    }
+
+    std::shared_ptr<Replica> escolher() {
+        auto lista = membros();
+        if (lista->empty()) {
+            throw std::runtime_error("Nenhuma réplica disponível para " + nomeGrupo);
+        }
+        return politica->escolher(*lista);
+    }
+
+    std::shared_ptr<Replica> buscar(const std::string& host, int port) const {
+        auto lista = membros();
+        for (const auto& r : *lista) {
+            if (r->host == host && r->port == port) return r;
+        }
+        return nullptr;
+    }
+
+    // Registra (ou renova) uma réplica dinâmica; retorna true se ela é nova no grupo
+    bool registrar(const std::string& host, int port) {
+        std::lock_guard<std::mutex> lock(mutexEscrita);
+        if (auto existente = buscar(host, port)) {
+            existente->ultimoHeartbeatMs.store(agoraMs(), std::memory_order_relaxed);
+            return false;
+        }
+        auto nova = std::make_shared<Replica>(host, port);
+        nova->estatica = false;
+        nova->ultimoHeartbeatMs.store(agoraMs(), std::memory_order_relaxed);
+
+        ListaReplicas lista(*membros());
+        lista.push_back(std::move(nova));
+        publicar(std::move(lista));
+        return true;
+    }
+
+    // Atualiza heartbeat e carga sem trocar o instantâneo; false se a réplica não é membro
+    bool heartbeat(const std::string& host, int port, int carga) {
+        auto replica = buscar(host, port);
+        if (!replica) {
+            return false;
+        }
+        replica->ultimoHeartbeatMs.store(agoraMs(), std::memory_order_relaxed);
+        replica->cargaReportada.store(carga, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool remover(const std::string& host, int port) {
+        std::lock_guard<std::mutex> lock(mutexEscrita);
+        auto atual = membros();
+        ListaReplicas lista;
+        for (const auto& r : *atual) {
+            if (r->host != host || r->port != port) lista.push_back(r);
+        }
+        if (lista.size() == atual->size()) {
+            return false;
+        }
+        publicar(std::move(lista));
+        return true;
+    }
+
+    // Remove réplicas dinâmicas sem heartbeat há mais de limiteMs; retorna quantas saíram
+    size_t removerExpiradas(int64_t limiteMs) {
+        std::lock_guard<std::mutex> lock(mutexEscrita);
+        auto atual = membros();
+        int64_t agora = agoraMs();
+        ListaReplicas lista;
+        for (const auto& r : *atual) {
+            if (r->estatica || agora - r->ultimoHeartbeatMs.load(std::memory_order_relaxed) <= limiteMs) {
+                lista.push_back(r);
+            } else {
+                std::cout << "Réplica " << r->endereco() << " de " << nomeGrupo
+                         << " expirou (sem heartbeat)" << std::endl;
+            }
+        }
+        size_t removidas = atual->size() - lista.size();
+        if (removidas > 0) {
+            publicar(std::move(lista));
+        }
+        return removidas;
+    }
+
+    const std::string& nome() const { return nomeGrupo; }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["politica"] = politica->nome();
+        e["replicas"] = Json::Value(Json::arrayValue);
+        for (const auto& r : *membros()) {
+            e["replicas"].append(r->estado());
+        }
+        return e;
+    }
+};
+
+#endif // BALANCEAMENTO_H
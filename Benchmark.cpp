@@ -0,0 +1,144 @@
+// Microbenchmarks: kernels de contagem, busca de padrões e codificação/decodificação JSON do payload {"texto": ...}
+// (inteiro com jsoncpp ou incremental, como nos escravos)
+//
+// Uso: ./bench-micro [--saida resultados.json] [--comparar base.json] [--max-bytes N] ...
+#include "BenchmarkUtil.h"
+#include "BuscaPadroes.h"
+#include "ClassesCaracteres.h"
+#include "JsonIncremental.h"
+
+// Receptor que só conta letras, como o AnalisadorServico
+struct ContagemLetrasBenchmark {
+    uint64_t quantidade = 0;
+    void texto(const char* dados, size_t tamanho) { quantidade += contarClasse<PoliticaLetras>(dados, tamanho); }
+    void inicioFragmento() {}
+    void fragmento(const char*, size_t) {}
+};
+
+// Receptor que guarda o texto decodificado, para comparar com o jsoncpp
+struct ColetaTextoBenchmark {
+    std::string recebido;
+    void texto(const char* dados, size_t tamanho) { recebido.append(dados, tamanho); }
+    void inicioFragmento() {}
+    void fragmento(const char*, size_t) {}
+};
+
+// Corpo com escapes (\uXXXX com par substituto, \\, \", controles) cortado em dois pedaços em cada
+// posição possível e também byte a byte: o texto decodificado deve ser o mesmo do jsoncpp
+bool verificarEscapesDivididos() {
+    const std::string corpo =
+        "{\"outro\": [1, \"\\\"x\"], \"texto\": \"a\\\"b\\\\c\\/d\\n\\t\\u0041\\u00e9\\u20ac"
+        "\\ud83d\\ude00 fim\\\\\\\"\"}";
+    Json::Value esperado;
+    Json::Reader reader;
+    if (!reader.parse(corpo, esperado) || !esperado["texto"].isString()) {
+        std::cerr << "Corpo de verificação de escapes inválido para o jsoncpp" << std::endl;
+        return false;
+    }
+    auto decodificar = [&](const std::vector<size_t>& cortes, std::string& texto) {
+        ColetaTextoBenchmark coleta;
+        LeitorTextoJson<ColetaTextoBenchmark> leitor(coleta);
+        size_t inicio = 0;
+        for (size_t corte : cortes) {
+            leitor.alimentar(corpo.data() + inicio, corte - inicio);
+            inicio = corte;
+        }
+        leitor.alimentar(corpo.data() + inicio, corpo.size() - inicio);
+        texto = std::move(coleta.recebido);
+        return leitor.concluir();
+    };
+    std::vector<std::vector<size_t>> divisoes;
+    for (size_t corte = 0; corte <= corpo.size(); ++corte) {
+        divisoes.push_back({corte});
+    }
+    divisoes.emplace_back();
+    for (size_t corte = 1; corte < corpo.size(); ++corte) {
+        divisoes.back().push_back(corte);
+    }
+    for (const auto& cortes : divisoes) {
+        std::string texto;
+        if (!decodificar(cortes, texto) || texto != esperado["texto"].asString()) {
+            std::cerr << "LeitorTextoJson diverge do jsoncpp com " << cortes.size() + 1 << " pedaços"
+                      << (cortes.size() == 1 ? " (corte em " + std::to_string(cortes[0]) + ")" : "") << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SuiteBenchmark suite("micro", OpcoesBenchmark::ler(argc, argv));
+    int codigo = verificarEscapesDivididos() ? 0 : 1;
+
+    for (uint64_t tamanho : tamanhosPadrao(suite.configuracao().maxBytes)) {
+        std::string texto = gerarTextoBenchmark(tamanho);
+
+        suite.medir("contarLetrasTexto", tamanho, [&]() {
+            naoOtimizar(contarLetrasTexto(texto));
+        });
+        suite.medir("contarNumerosTexto", tamanho, [&]() {
+            naoOtimizar(contarNumerosTexto(texto));
+        });
+
+        // Mesmo texto como lote de segmentos de 1 KB (agrupamento de requisições nos escravos)
+        std::vector<size_t> fins;
+        for (size_t fim = 1024; fim < texto.size(); fim += 1024) {
+            fins.push_back(fim);
+        }
+        fins.push_back(texto.size());
+        std::vector<uint64_t> quantidades(fins.size());
+        suite.medir("contarLetrasSegmentos1K", tamanho, [&]() {
+            contarClasseSegmentos<PoliticaLetras>(texto.data(), fins.data(), fins.size(), quantidades.data());
+            naoOtimizar(quantidades[0]);
+        });
+
+        // Aho-Corasick: palavras-chave raras (salto SIMD na raiz) e frequentes
+        static const AutomatoPadroes raros({"xilofone", "quartzo", "zebra", "kiwi"}, false);
+        static const AutomatoPadroes frequentes({"de", "que", "para", "com", "texto"}, true);
+        suite.medir("padroesRaros", tamanho, [&]() {
+            naoOtimizar(raros.contar(texto.data(), texto.size())[0]);
+        });
+        suite.medir("padroesFrequentes", tamanho, [&]() {
+            naoOtimizar(frequentes.contar(texto.data(), texto.size())[0]);
+        });
+
+        Json::Value requestJson;
+        requestJson["texto"] = texto;
+        Json::StreamWriterBuilder builder;
+        suite.medir("json_encode_texto", tamanho, [&]() {
+            std::string jsonString = Json::writeString(builder, requestJson);
+            naoOtimizar(jsonString.size());
+        });
+
+        std::string jsonString = Json::writeString(builder, requestJson);
+        suite.medir("json_decode_texto", tamanho, [&]() {
+            Json::Value decodificado;
+            Json::Reader reader;
+            reader.parse(jsonString, decodificado);
+            std::string recuperado = decodificado["texto"].asString();
+            naoOtimizar(recuperado.size());
+        });
+
+        // Corpo em pedaços de 16 KB, decodificado e contado sem montar o texto
+        uint64_t letrasEsperadas = contarLetrasTexto(texto);
+        bool correto = true;
+        suite.medir("json_stream_contar_letras", tamanho, [&]() {
+            ContagemLetrasBenchmark contagem;
+            LeitorTextoJson<ContagemLetrasBenchmark> leitor(contagem);
+            for (size_t i = 0; i < jsonString.size(); i += 16384) {
+                leitor.alimentar(jsonString.data() + i, std::min<size_t>(16384, jsonString.size() - i));
+            }
+            if (!leitor.concluir() || contagem.quantidade != letrasEsperadas) {
+                correto = false;
+            }
+            naoOtimizar(contagem.quantidade);
+        });
+        if (!correto) {
+            std::cerr << "json_stream_contar_letras diverge de contarLetrasTexto para " << tamanho << " bytes" << std::endl;
+            codigo = 1;
+        }
+    }
+
+    int codigoSuite = suite.finalizar();
+    return codigo != 0 ? codigo : codigoSuite;
+}
@@ -0,0 +1,133 @@
+// Benchmark ponta a ponta: cliente → Mestre → escravos, tudo no mesmo processo.
+// Os escravos são substitutos locais (mesmo kernel e formato JSON dos escravos reais)
+// em portas livres de 127.0.0.1; o Mestre é a classe real, configurada para usá-los.
+//
+// Uso: ./bench-fim-a-fim [--saida resultados.json] [--comparar base.json] [--max-bytes N] ...
+#include <sstream>
+#include "BenchmarkUtil.h"
+#include "ClassesCaracteres.h"
+#include "ContagemAlocacoes.h"
+#include "Mestre.h"
+
+// Escravo substituto: POST Politica::rota e GET /health
+template <typename Politica>
+class SubstitutoEscravo {
+private:
+    httplib::Server servidor;
+    std::thread thread;
+    int porta = -1;
+
+public:
+    SubstitutoEscravo() {
+        servidor.Post(Politica::rota, [](const httplib::Request& req, httplib::Response& res) {
+            Json::Value requestJson;
+            Json::Reader reader;
+            if (!reader.parse(req.body, requestJson)) {
+                res.status = 400;
+                return;
+            }
+            Json::Value resposta;
+            resposta["quantidade"] = Json::Value::UInt64(contarClasse<Politica>(requestJson["texto"].asString()));
+            resposta["tipo"] = Politica::tipo;
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+        });
+        servidor.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+            res.set_content("{\"status\": \"ok\"}", "application/json");
+        });
+
+        porta = servidor.bind_to_any_port("127.0.0.1");
+        thread = std::thread([this]() { servidor.listen_after_bind(); });
+    }
+
+    ~SubstitutoEscravo() {
+        servidor.stop();
+        thread.join();
+    }
+
+    std::string endereco() const {
+        return "127.0.0.1:" + std::to_string(porta);
+    }
+};
+
+static bool aguardarPronto(int porta) {
+    httplib::Client client("127.0.0.1", porta);
+    for (int i = 0; i < 100; ++i) {
+        auto resposta = client.Get("/health");
+        if (resposta && resposta->status == 200) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    SuiteBenchmark suite("fim-a-fim", OpcoesBenchmark::ler(argc, argv));
+
+    // Os logs por requisição do Mestre distorceriam a medição e a saída JSON
+    std::ostringstream descarte;
+    std::streambuf* saidaOriginal = std::cout.rdbuf(descarte.rdbuf());
+
+    int codigo = 0;
+    {
+        SubstitutoEscravo<PoliticaLetras> escravoLetras;
+        SubstitutoEscravo<PoliticaNumeros> escravoNumeros;
+        setenv("ESCRAVOS_LETRAS", escravoLetras.endereco().c_str(), 1);
+        setenv("ESCRAVOS_NUMEROS", escravoNumeros.endereco().c_str(), 1);
+        // Mede só a contagem: sem construir o índice posicional a cada iteração
+        setenv("INDICE_POSICIONAL", "0", 1);
+
+        Mestre mestre;
+        int portaMestre = mestre.vincularPortaLivre("127.0.0.1");
+        std::thread threadMestre([&]() { mestre.escutarVinculado(); });
+
+        if (!aguardarPronto(portaMestre)) {
+            std::cerr << "Mestre não respondeu em 127.0.0.1:" << portaMestre << std::endl;
+            codigo = 1;
+        }
+
+        for (uint64_t tamanho : tamanhosPadrao(suite.configuracao().maxBytes)) {
+            if (codigo != 0 || !suite.selecionado("processar")) break;
+
+            std::string texto = gerarTextoBenchmark(tamanho);
+            int letrasEsperadas = contarLetrasTexto(texto);
+            int numerosEsperados = contarNumerosTexto(texto);
+
+            Json::Value requestJson;
+            requestJson["texto"] = texto;
+            Json::StreamWriterBuilder builder;
+            std::string corpo = Json::writeString(builder, requestJson);
+
+            httplib::Client client("127.0.0.1", portaMestre);
+            client.set_keep_alive(true);
+            client.set_read_timeout(600);
+            client.set_write_timeout(600);
+
+            bool correto = true;
+            mestre.zerarAlocacoes();
+            suite.medir("processar", tamanho, [&]() {
+                auto resposta = client.Post("/processar", corpo, "application/json");
+                Json::Value resultado;
+                Json::Reader reader;
+                if (!resposta || resposta->status != 200 || !reader.parse(resposta->body, resultado) ||
+                    resultado["letras"].asInt() != letrasEsperadas ||
+                    resultado["numeros"].asInt() != numerosEsperados) {
+                    correto = false;
+                }
+            });
+            suite.anotar("alocacoes_por_requisicao", mestre.estadoSaude()["alocacoes"]["por_requisicao"]);
+            if (!correto) {
+                std::cerr << "Resposta incorreta do Mestre para " << tamanho << " bytes" << std::endl;
+                codigo = 1;
+            }
+        }
+
+        mestre.parar();
+        threadMestre.join();
+    }
+
+    std::cout.rdbuf(saidaOriginal);
+    int codigoSuite = suite.finalizar();
+    return codigo != 0 ? codigo : codigoSuite;
+}
@@ -0,0 +1,189 @@
+#ifndef BENCHMARK_UTIL_H
+#define BENCHMARK_UTIL_H
+
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <jsoncpp/json/json.h>
+
+// Infraestrutura comum dos benchmarks: medição, saída em JSON e comparação com uma execução anterior.
+//
+// Opções de linha de comando:
+//   --saida arquivo.json     grava os resultados (padrão: apenas stdout)
+//   --comparar base.json     compara com uma execução anterior; sai com código 2 se houver regressão
+//   --tolerancia 0.10        piora relativa aceita antes de acusar regressão (padrão: 10%)
+//   --tempo-minimo 0.5       segundos mínimos de medição por caso
+//   --max-bytes N            ignora tamanhos de payload acima de N (padrão: 1 GB)
+//   --filtro texto           executa apenas os casos cujo nome contém o texto
+
+struct OpcoesBenchmark {
+    std::string saida;
+    std::string comparar;
+    double tolerancia = 0.10;
+    double tempoMinimoS = 0.5;
+    uint64_t maxBytes = 1ULL << 30;
+    std::string filtro;
+
+    static OpcoesBenchmark ler(int argc, char* argv[]) {
+        OpcoesBenchmark opcoes;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string nome = argv[i];
+            std::string valor = argv[i + 1];
+            if (nome == "--saida") opcoes.saida = valor;
+            else if (nome == "--comparar") opcoes.comparar = valor;
+            else if (nome == "--tolerancia") opcoes.tolerancia = std::stod(valor);
+            else if (nome == "--tempo-minimo") opcoes.tempoMinimoS = std::stod(valor);
+            else if (nome == "--max-bytes") opcoes.maxBytes = std::stoull(valor);
+            else if (nome == "--filtro") opcoes.filtro = valor;
+            else std::cerr << "Opção desconhecida: " << nome << std::endl;
+        }
+        return opcoes;
+    }
+};
+
+// Impede que o compilador descarte um resultado que não é usado
+template <typename T>
+inline void naoOtimizar(const T& valor) {
+    asm volatile("" : : "r,m"(valor) : "memory");
+}
+
+// Tamanhos de payload de 1 KB a 1 GB (potências de 16 a partir de 1 KB, mais 1 GB)
+inline std::vector<uint64_t> tamanhosPadrao(uint64_t maxBytes) {
+    std::vector<uint64_t> tamanhos;
+    for (uint64_t t : {1ULL << 10, 1ULL << 14, 1ULL << 18, 1ULL << 22, 1ULL << 26, 1ULL << 30}) {
+        if (t <= maxBytes) tamanhos.push_back(t);
+    }
+    return tamanhos;
+}
+
+// Texto determinístico com letras, dígitos, espaços, pontuação e acentos (UTF-8)
+inline std::string gerarTextoBenchmark(uint64_t tamanho) {
+    static const std::string alfabeto =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789     \n.,;!?\"\\";
+    static const std::string acentos[] = {"á", "é", "ç", "ã", "õ"};
+    std::mt19937_64 gerador(42);
+    std::string texto;
+    texto.reserve(tamanho + 2);
+    while (texto.size() < tamanho) {
+        uint64_t sorteio = gerador();
+        if (sorteio % 50 == 0) {
+            texto += acentos[(sorteio >> 8) % 5];
+        } else {
+            texto.push_back(alfabeto[(sorteio >> 8) % alfabeto.size()]);
+        }
+    }
+    texto.resize(tamanho);
+    return texto;
+}
+
+class SuiteBenchmark {
+private:
+    std::string nomeSuite;
+    OpcoesBenchmark opcoes;
+    Json::Value resultados{Json::arrayValue};
+
+    static std::string chave(const Json::Value& r) {
+        return r["nome"].asString() + "/" + r["bytes"].asString();
+    }
+
+public:
+    SuiteBenchmark(std::string nome, OpcoesBenchmark o) : nomeSuite(std::move(nome)), opcoes(std::move(o)) {}
+
+    const OpcoesBenchmark& configuracao() const { return opcoes; }
+
+    bool selecionado(const std::string& nome) const {
+        return opcoes.filtro.empty() || nome.find(opcoes.filtro) != std::string::npos;
+    }
+
+    // Executa 'funcao' repetidamente, dobrando as iterações até atingir o tempo mínimo
+    template <typename Funcao>
+    void medir(const std::string& nome, uint64_t bytes, Funcao&& funcao) {
+        if (!selecionado(nome)) {
+            return;
+        }
+        funcao(); // aquecimento
+
+        uint64_t iteracoes = 1;
+        double segundos = 0.0;
+        while (true) {
+            auto inicio = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iteracoes; ++i) {
+                funcao();
+            }
+            segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+            if (segundos >= opcoes.tempoMinimoS || iteracoes >= (1ULL << 30)) {
+                break;
+            }
+            iteracoes *= 2;
+        }
+
+        double nsPorIteracao = segundos * 1e9 / iteracoes;
+        Json::Value r;
+        r["nome"] = nome;
+        r["bytes"] = Json::Value::UInt64(bytes);
+        r["iteracoes"] = Json::Value::UInt64(iteracoes);
+        r["ns_por_iteracao"] = nsPorIteracao;
+        r["mb_por_s"] = bytes > 0 ? (bytes / 1e6) / (nsPorIteracao / 1e9) : 0.0;
+        resultados.append(r);
+
+        std::cerr << nome << " [" << bytes << " bytes]: " << nsPorIteracao / 1e3 << " us/iter, "
+                  << r["mb_por_s"].asDouble() << " MB/s (" << iteracoes << " iterações)" << std::endl;
+    }
+
+    // Acrescenta uma métrica extra ao último caso medido (ex.: alocações por requisição)
+    void anotar(const std::string& campo, const Json::Value& valor) {
+        if (!resultados.empty()) {
+            resultados[resultados.size() - 1][campo] = valor;
+            std::cerr << "  " << campo << ": " << valor.asString() << std::endl;
+        }
+    }
+
+    // Grava/imprime os resultados e compara com a base; retorna o código de saída do programa
+    int finalizar() {
+        Json::Value documento;
+        documento["suite"] = nomeSuite;
+        documento["timestamp"] = Json::Value::Int64(std::time(nullptr));
+        documento["resultados"] = resultados;
+
+        Json::StreamWriterBuilder builder;
+        std::string json = Json::writeString(builder, documento);
+        if (opcoes.saida.empty()) {
+            std::cout << json << std::endl;
+        } else {
+            std::ofstream(opcoes.saida) << json << std::endl;
+        }
+
+        if (opcoes.comparar.empty()) {
+            return 0;
+        }
+
+        std::ifstream arquivoBase(opcoes.comparar);
+        Json::Value base;
+        Json::Reader reader;
+        if (!arquivoBase || !reader.parse(arquivoBase, base)) {
+            std::cerr << "Não foi possível ler a base " << opcoes.comparar << std::endl;
+            return 1;
+        }
+
+        int regressoes = 0;
+        for (const auto& atual : resultados) {
+            for (const auto& anterior : base["resultados"]) {
+                if (chave(anterior) != chave(atual)) continue;
+                double razao = atual["ns_por_iteracao"].asDouble() / anterior["ns_por_iteracao"].asDouble();
+                if (razao > 1.0 + opcoes.tolerancia) {
+                    ++regressoes;
+                    std::cerr << "REGRESSÃO " << chave(atual) << ": " << (razao - 1.0) * 100.0 << "% mais lento" << std::endl;
+                }
+            }
+        }
+        std::cerr << regressoes << " regressões em relação a " << opcoes.comparar << std::endl;
+        return regressoes > 0 ? 2 : 0;
+    }
+};
+
+#endif // BENCHMARK_UTIL_H
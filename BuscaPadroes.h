@@ -0,0 +1,952 @@
+#ifndef BUSCA_PADROES_H
+#define BUSCA_PADROES_H
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <jsoncpp/json/json.h>
+#include "Fragmentacao.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Contagem de muitos padrões em uma única passada pelo texto (EscravoPadroes.cpp):
+//
+// - AutomatoPadroes: Aho-Corasick compilado como DFA completo (transições de falha já
+//   resolvidas) sobre classes de bytes, para a tabela ter uma coluna por byte distinto dos
+//   padrões e não 256. A varredura só soma visitas por estado; as contagens por padrão saem
+//   depois, propagando as visitas pelos links de falha. Ocorrências sobrepostas contam todas.
+//   Na raiz, blocos de 16 bytes sem nenhum byte inicial de padrão são pulados (SSE2).
+// - AutomatoExpressoes: expressões regulares (e os literais do mesmo pedido) em um único DFA
+//   por construção de subconjuntos; ocorrência = posição em que termina um casamento.
+// - ConjuntoPadroes: escolhe o autômato do pedido (Aho-Corasick se não há expressões).
+// - CacheConjuntos: conjuntos compilados por hash da descrição (padrões, expressões, caixa).
+
+class AutomatoPadroes {
+private:
+    // Limite de entradas da tabela de transições (4 bytes cada): 64 MB
+    static constexpr size_t maximoTransicoes = 16 * 1024 * 1024;
+
+    std::array<uint8_t, 256> classes{};
+    uint32_t numClasses = 1; // classe 0: bytes que não aparecem em nenhum padrão
+    std::vector<uint32_t> transicoes;
+    std::vector<uint32_t> falha;
+    std::vector<uint32_t> ordemLargura;
+    std::vector<uint32_t> terminais; // estado final de cada padrão
+
+    std::vector<uint8_t> iniciais; // bytes com transição a partir da raiz
+
+    static unsigned char dobrar(unsigned char c, bool ignorarCaixa) {
+        return (ignorarCaixa && c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+    }
+
+    uint32_t estados() const {
+        return static_cast<uint32_t>(falha.size());
+    }
+
+    bool saltoSimd() const {
+#ifdef __SSE2__
+        return !iniciais.empty() && iniciais.size() <= 16;
+#else
+        return false;
+#endif
+    }
+
+    // Bloco de 16 bytes sem nenhum byte que inicie um padrão: pode ser pulado a partir da raiz
+    bool blocoSemIniciais(const unsigned char* p) const {
+#ifdef __SSE2__
+        __m128i bloco = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i achados = _mm_setzero_si128();
+        for (uint8_t c : iniciais) {
+            achados = _mm_or_si128(achados, _mm_cmpeq_epi8(bloco, _mm_set1_epi8(static_cast<char>(c))));
+        }
+        return _mm_movemask_epi8(achados) == 0;
+#else
+        (void)p;
+        return false;
+#endif
+    }
+
+public:
+    AutomatoPadroes(const std::vector<std::string>& padroes, bool ignorarCaixa) {
+        // Classes: uma por byte distinto dos padrões; sem caixa, maiúscula e minúscula juntas
+        for (const auto& padrao : padroes) {
+            if (padrao.empty()) {
+                throw std::invalid_argument("padrão vazio");
+            }
+            for (unsigned char c : padrao) {
+                unsigned char d = dobrar(c, ignorarCaixa);
+                if (classes[d] == 0) {
+                    if (numClasses == 256) {
+                        throw std::invalid_argument("padrões usam bytes distintos demais");
+                    }
+                    classes[d] = static_cast<uint8_t>(numClasses++);
+                }
+            }
+        }
+        if (ignorarCaixa) {
+            for (int c = 'A'; c <= 'Z'; ++c) {
+                classes[c] = classes[c - 'A' + 'a'];
+            }
+        }
+
+        // Trie: ausente = 0 (a raiz nunca é destino de uma aresta da trie)
+        transicoes.assign(numClasses, 0);
+        falha.assign(1, 0);
+        for (const auto& padrao : padroes) {
+            uint32_t estado = 0;
+            for (unsigned char c : padrao) {
+                uint32_t& proximo = transicoes[static_cast<size_t>(estado) * numClasses + classes[c]];
+                if (proximo == 0) {
+                    if (static_cast<size_t>(estados() + 1) * numClasses > maximoTransicoes) {
+                        throw std::invalid_argument("conjunto de padrões grande demais");
+                    }
+                    proximo = estados();
+                    falha.push_back(0);
+                    transicoes.resize(transicoes.size() + numClasses, 0);
+                }
+                // resize pode ter movido a tabela: relê pelo índice
+                estado = transicoes[static_cast<size_t>(estado) * numClasses + classes[c]];
+            }
+            terminais.push_back(estado);
+        }
+
+        // Largura: links de falha e transições ausentes copiadas do estado de falha
+        ordemLargura.reserve(estados());
+        for (uint32_t c = 0; c < numClasses; ++c) {
+            uint32_t filho = transicoes[c];
+            if (filho != 0) {
+                falha[filho] = 0;
+                ordemLargura.push_back(filho);
+            }
+        }
+        for (size_t k = 0; k < ordemLargura.size(); ++k) {
+            uint32_t estado = ordemLargura[k];
+            size_t linha = static_cast<size_t>(estado) * numClasses;
+            size_t linhaFalha = static_cast<size_t>(falha[estado]) * numClasses;
+            for (uint32_t c = 0; c < numClasses; ++c) {
+                uint32_t filho = transicoes[linha + c];
+                if (filho != 0) {
+                    falha[filho] = transicoes[linhaFalha + c];
+                    ordemLargura.push_back(filho);
+                } else {
+                    transicoes[linha + c] = transicoes[linhaFalha + c];
+                }
+            }
+        }
+
+        for (int c = 0; c < 256; ++c) {
+            if (transicoes[classes[c]] != 0) {
+                iniciais.push_back(static_cast<uint8_t>(c));
+            }
+        }
+    }
+
+    // Ocorrências de cada padrão, na ordem em que foram dados
+    std::vector<uint64_t> contar(const char* dados, size_t tamanho) const {
+        std::vector<uint64_t> visitas(estados(), 0);
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(dados);
+        const uint32_t* delta = transicoes.data();
+        const size_t largura = numClasses;
+        // Salto só com poucos bytes iniciais; a decisão é por bloco, para não desviar a cada byte
+        const bool saltar = saltoSimd();
+        uint32_t estado = 0;
+        size_t i = 0;
+        while (i < tamanho) {
+            if (saltar && estado == 0 && i + 16 <= tamanho && blocoSemIniciais(p + i)) {
+                i += 16;
+                continue;
+            }
+            size_t fimBloco = std::min(tamanho, i + 16);
+            for (; i < fimBloco; ++i) {
+                estado = delta[estado * largura + classes[p[i]]];
+                visitas[estado]++;
+            }
+        }
+
+        // Quem visita um estado também casa os sufixos dele (cadeia de falha)
+        for (size_t k = ordemLargura.size(); k-- > 0;) {
+            uint32_t e = ordemLargura[k];
+            visitas[falha[e]] += visitas[e];
+        }
+        std::vector<uint64_t> contagens;
+        contagens.reserve(terminais.size());
+        for (uint32_t t : terminais) {
+            contagens.push_back(visitas[t]);
+        }
+        return contagens;
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["estados"] = estados();
+        e["classes"] = numClasses;
+        e["bytes_iniciais"] = Json::Value::UInt64(iniciais.size());
+        e["salto_simd"] = saltoSimd();
+        return e;
+    }
+};
+
+// Subconjunto de expressões regulares compilado sem std::regex (que recursa a cada caractere
+// casado e derruba o processo em textos grandes): literais, '.', classes [...] e [^...],
+// \d \w \s \D \W \S, escapes (\n, \t, \xHH, pontuação), grupos (...) e (?:...), alternância e
+// os quantificadores * + ? {n} {n,} {n,m} (as formas preguiçosas casam o mesmo aqui). Âncoras,
+// retrovisores e lookarounds são recusados, assim como expressões que casam a cadeia vazia.
+//
+// Cada expressão vira um fragmento de NFA de Thompson; os fragmentos de todas as expressões
+// (e dos literais do mesmo conjunto) são unidos e determinizados por construção de subconjuntos
+// em um único DFA sobre classes de bytes. Uma ocorrência é uma posição do texto em que termina
+// um casamento: a mesma regra dos literais no Aho-Corasick (sobrepostas contam todas).
+class AutomatoExpressoes {
+private:
+    static constexpr size_t maximoTransicoes = 16 * 1024 * 1024; // como em AutomatoPadroes
+    static constexpr size_t maximoEstados = 1 << 18; // recusa explosões de subconjuntos em ~1 s
+    static constexpr size_t maximoNosNfa = 1 << 16;
+    static constexpr size_t maximoTamanhoExpressao = 4096;
+    static constexpr int maximoAninhamento = 64;
+    static constexpr int maximoRepeticoes = 1000;
+
+    using Bytes = std::bitset<256>;
+
+    struct Arvore {
+        enum Tipo { Conjunto, Sequencia, Alternativa, Repeticao } tipo = Sequencia;
+        Bytes bytes;
+        std::vector<Arvore> filhos;
+        int minimo = 0;
+        int maximo = 0; // -1: ilimitado
+    };
+
+    // Descida recursiva com profundidade limitada pelo aninhamento de grupos
+    class Analisador {
+    private:
+        const std::string& texto;
+        size_t pos = 0;
+        bool ignorarCaixa;
+        int profundidade = 0;
+
+        [[noreturn]] void erro(const std::string& mensagem) const {
+            throw std::invalid_argument("expressão regular \"" + texto + "\": " + mensagem);
+        }
+
+        bool fim() const { return pos >= texto.size(); }
+        unsigned char atual() const { return static_cast<unsigned char>(texto[pos]); }
+
+        Bytes dobrarCaixa(Bytes bytes) const {
+            if (ignorarCaixa) {
+                for (int c = 'a'; c <= 'z'; ++c) {
+                    if (bytes[c] || bytes[c - 'a' + 'A']) {
+                        bytes.set(c);
+                        bytes.set(c - 'a' + 'A');
+                    }
+                }
+            }
+            return bytes;
+        }
+
+        static Bytes faixa(int inicio, int fim) {
+            Bytes bytes;
+            for (int c = inicio; c <= fim; ++c) bytes.set(c);
+            return bytes;
+        }
+
+        static Bytes classeEscape(unsigned char c) {
+            Bytes digitos = faixa('0', '9');
+            Bytes palavra = digitos | faixa('a', 'z') | faixa('A', 'Z');
+            palavra.set('_');
+            Bytes espacos;
+            for (char e : {' ', '\t', '\n', '\r', '\f', '\v'}) espacos.set(static_cast<unsigned char>(e));
+            switch (c) {
+                case 'd': return digitos;
+                case 'D': return ~digitos;
+                case 'w': return palavra;
+                case 'W': return ~palavra;
+                case 's': return espacos;
+                case 'S': return ~espacos;
+                default: return Bytes();
+            }
+        }
+
+        static int hex(unsigned char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        // Depois da barra invertida: um conjunto de bytes (classe ou byte único)
+        Bytes escape(bool dentroDeClasse) {
+            if (fim()) erro("barra invertida no fim");
+            unsigned char c = atual();
+            ++pos;
+            if (std::strchr("dDwWsS", c)) return classeEscape(c);
+            Bytes bytes;
+            switch (c) {
+                case 'n': bytes.set('\n'); return bytes;
+                case 't': bytes.set('\t'); return bytes;
+                case 'r': bytes.set('\r'); return bytes;
+                case 'f': bytes.set('\f'); return bytes;
+                case 'v': bytes.set('\v'); return bytes;
+                case 'x': {
+                    int alto = pos < texto.size() ? hex(texto[pos]) : -1;
+                    int baixo = pos + 1 < texto.size() ? hex(texto[pos + 1]) : -1;
+                    if (alto < 0 || baixo < 0) erro("\\x exige dois dígitos hexadecimais");
+                    pos += 2;
+                    bytes.set(alto * 16 + baixo);
+                    return bytes;
+                }
+                case 'b':
+                case 'B':
+                    if (!dentroDeClasse) erro("âncoras (\\b, \\B) não são suportadas");
+                    break;
+                default:
+                    break;
+            }
+            if (c >= '1' && c <= '9') erro("retrovisores não são suportados");
+            if (std::isalnum(c)) erro(std::string("escape desconhecido \\") + static_cast<char>(c));
+            bytes.set(c);
+            return bytes;
+        }
+
+        Bytes classe() {
+            bool negada = !fim() && atual() == '^';
+            if (negada) ++pos;
+            Bytes bytes;
+            bool primeiro = true;
+            while (true) {
+                if (fim()) erro("classe [ sem ]");
+                unsigned char c = atual();
+                if (c == ']' && !primeiro) {
+                    ++pos;
+                    break;
+                }
+                primeiro = false;
+                Bytes item;
+                int inicio = -1;
+                if (c == '\\') {
+                    ++pos;
+                    item = escape(true);
+                    if (item.count() == 1) {
+                        for (int b = 0; b < 256; ++b) if (item[b]) inicio = b;
+                    }
+                } else {
+                    if (c >= 0x80) erro("classes com bytes não ASCII não são suportadas");
+                    ++pos;
+                    item.set(c);
+                    inicio = c;
+                }
+                // Faixa a-z: só entre bytes únicos e se o '-' não fecha a classe
+                if (inicio >= 0 && pos + 1 < texto.size() && texto[pos] == '-' && texto[pos + 1] != ']') {
+                    ++pos;
+                    int fimFaixa;
+                    if (atual() == '\\') {
+                        ++pos;
+                        Bytes b = escape(true);
+                        if (b.count() != 1) erro("faixa inválida na classe");
+                        fimFaixa = 0;
+                        while (!b[fimFaixa]) ++fimFaixa;
+                    } else {
+                        if (atual() >= 0x80) erro("classes com bytes não ASCII não são suportadas");
+                        fimFaixa = atual();
+                        ++pos;
+                    }
+                    if (fimFaixa < inicio) erro("faixa invertida na classe");
+                    item = faixa(inicio, fimFaixa);
+                }
+                bytes |= item;
+            }
+            bytes = dobrarCaixa(bytes);
+            return negada ? ~bytes : bytes;
+        }
+
+        int numero() {
+            if (fim() || !std::isdigit(atual())) erro("quantificador {n,m} inválido");
+            long valor = 0;
+            while (!fim() && std::isdigit(atual())) {
+                valor = valor * 10 + (atual() - '0');
+                if (valor > maximoRepeticoes) erro("repetição acima de " + std::to_string(maximoRepeticoes));
+                ++pos;
+            }
+            return static_cast<int>(valor);
+        }
+
+        Arvore atomo() {
+            unsigned char c = atual();
+            Arvore no;
+            no.tipo = Arvore::Conjunto;
+            switch (c) {
+                case '(': {
+                    ++pos;
+                    if (!fim() && atual() == '?') {
+                        if (pos + 1 < texto.size() && texto[pos + 1] == ':') {
+                            pos += 2;
+                        } else {
+                            erro("lookarounds e grupos nomeados não são suportados");
+                        }
+                    }
+                    if (++profundidade > maximoAninhamento) erro("grupos aninhados demais");
+                    Arvore grupo = alternativa();
+                    --profundidade;
+                    if (fim() || atual() != ')') erro("( sem )");
+                    ++pos;
+                    return grupo;
+                }
+                case '[':
+                    ++pos;
+                    no.bytes = classe();
+                    return no;
+                case '.':
+                    ++pos;
+                    no.bytes = ~Bytes();
+                    no.bytes.reset('\n');
+                    return no;
+                case '\\':
+                    ++pos;
+                    no.bytes = dobrarCaixa(escape(false));
+                    return no;
+                case '^':
+                case '$':
+                    erro("âncoras (^, $) não são suportadas");
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                    erro("quantificador sem operando");
+                case ')':
+                    erro(") sem (");
+                default:
+                    ++pos;
+                    no.bytes.set(c);
+                    no.bytes = dobrarCaixa(no.bytes);
+                    return no;
+            }
+        }
+
+        Arvore sequencia() {
+            Arvore seq;
+            seq.tipo = Arvore::Sequencia;
+            while (!fim() && atual() != '|' && atual() != ')') {
+                Arvore item = atomo();
+                while (!fim() && std::strchr("*+?{", atual())) {
+                    int minimo = 0;
+                    int maximo = -1;
+                    unsigned char q = atual();
+                    ++pos;
+                    if (q == '+') {
+                        minimo = 1;
+                    } else if (q == '?') {
+                        maximo = 1;
+                    } else if (q == '{') {
+                        minimo = numero();
+                        maximo = minimo;
+                        if (!fim() && atual() == ',') {
+                            ++pos;
+                            maximo = (!fim() && atual() == '}') ? -1 : numero();
+                        }
+                        if (fim() || atual() != '}') erro("quantificador {n,m} inválido");
+                        ++pos;
+                        if (maximo >= 0 && maximo < minimo) erro("quantificador {n,m} com m < n");
+                    }
+                    if (!fim() && atual() == '?') ++pos; // preguiçoso: mesma linguagem
+                    Arvore repeticao;
+                    repeticao.tipo = Arvore::Repeticao;
+                    repeticao.minimo = minimo;
+                    repeticao.maximo = maximo;
+                    repeticao.filhos.push_back(std::move(item));
+                    item = std::move(repeticao);
+                }
+                seq.filhos.push_back(std::move(item));
+            }
+            return seq;
+        }
+
+    public:
+        Analisador(const std::string& expressao, bool caixa) : texto(expressao), ignorarCaixa(caixa) {}
+
+        Arvore alternativa() {
+            Arvore alt;
+            alt.tipo = Arvore::Alternativa;
+            alt.filhos.push_back(sequencia());
+            while (!fim() && atual() == '|') {
+                ++pos;
+                alt.filhos.push_back(sequencia());
+            }
+            return alt.filhos.size() == 1 ? std::move(alt.filhos[0]) : alt;
+        }
+
+        Arvore analisar() {
+            if (texto.size() > maximoTamanhoExpressao) erro("expressão longa demais");
+            Arvore arvore = alternativa();
+            if (!fim()) erro(") sem (");
+            return arvore;
+        }
+    };
+
+    static bool casaVazio(const Arvore& no) {
+        switch (no.tipo) {
+            case Arvore::Conjunto: return false;
+            case Arvore::Repeticao: return no.minimo == 0 || casaVazio(no.filhos[0]);
+            case Arvore::Alternativa:
+                return std::any_of(no.filhos.begin(), no.filhos.end(), casaVazio);
+            case Arvore::Sequencia:
+            default:
+                return std::all_of(no.filhos.begin(), no.filhos.end(), casaVazio);
+        }
+    }
+
+    // NFA de Thompson: nó que consome um byte do conjunto, nó epsilon (até duas saídas) ou final
+    struct NoNfa {
+        Bytes bytes;
+        bool epsilon = false;
+        int32_t proximo = -1;
+        int32_t alternativo = -1;
+        int32_t aceita = -1; // índice do padrão, em nós finais
+    };
+
+    struct Fragmento {
+        int32_t inicio;
+        std::vector<std::pair<int32_t, bool>> saidas; // (nó, saída alternativa?) a ligar
+    };
+
+    std::vector<NoNfa> nfa;
+
+    int32_t novoNo(NoNfa no) {
+        if (nfa.size() >= maximoNosNfa) {
+            throw std::invalid_argument("expressões regulares grandes demais");
+        }
+        nfa.push_back(no);
+        return static_cast<int32_t>(nfa.size() - 1);
+    }
+
+    void ligar(const Fragmento& fragmento, int32_t destino) {
+        for (auto [no, alternativa] : fragmento.saidas) {
+            (alternativa ? nfa[no].alternativo : nfa[no].proximo) = destino;
+        }
+    }
+
+    Fragmento vazio() {
+        NoNfa no;
+        no.epsilon = true;
+        int32_t n = novoNo(no);
+        return {n, {{n, false}}};
+    }
+
+    Fragmento compilar(const Arvore& arvore) {
+        switch (arvore.tipo) {
+            case Arvore::Conjunto: {
+                NoNfa no;
+                no.bytes = arvore.bytes;
+                int32_t n = novoNo(no);
+                return {n, {{n, false}}};
+            }
+            case Arvore::Sequencia: {
+                if (arvore.filhos.empty()) return vazio();
+                Fragmento resultado = compilar(arvore.filhos[0]);
+                for (size_t i = 1; i < arvore.filhos.size(); ++i) {
+                    Fragmento proximo = compilar(arvore.filhos[i]);
+                    ligar(resultado, proximo.inicio);
+                    resultado.saidas = std::move(proximo.saidas);
+                }
+                return resultado;
+            }
+            case Arvore::Alternativa: {
+                Fragmento ultimo = compilar(arvore.filhos.back());
+                Fragmento resultado{ultimo.inicio, ultimo.saidas};
+                for (size_t i = arvore.filhos.size() - 1; i-- > 0;) {
+                    Fragmento ramo = compilar(arvore.filhos[i]);
+                    NoNfa divisao;
+                    divisao.epsilon = true;
+                    divisao.proximo = ramo.inicio;
+                    divisao.alternativo = resultado.inicio;
+                    resultado.inicio = novoNo(divisao);
+                    resultado.saidas.insert(resultado.saidas.end(), ramo.saidas.begin(), ramo.saidas.end());
+                }
+                return resultado;
+            }
+            case Arvore::Repeticao:
+            default: {
+                const Arvore& filho = arvore.filhos[0];
+                Fragmento resultado = vazio();
+                auto anexar = [&](Fragmento parte) {
+                    ligar(resultado, parte.inicio);
+                    resultado.saidas = std::move(parte.saidas);
+                };
+                for (int i = 0; i < arvore.minimo; ++i) {
+                    anexar(compilar(filho));
+                }
+                if (arvore.maximo < 0) {
+                    // x*: divisão que entra no corpo ou sai; o corpo volta para a divisão
+                    Fragmento corpo = compilar(filho);
+                    NoNfa divisao;
+                    divisao.epsilon = true;
+                    divisao.proximo = corpo.inicio;
+                    int32_t d = novoNo(divisao);
+                    ligar(corpo, d);
+                    anexar({d, {{d, true}}});
+                } else {
+                    // x{0,k}: k opcionais em sequência
+                    for (int i = arvore.minimo; i < arvore.maximo; ++i) {
+                        Fragmento corpo = compilar(filho);
+                        NoNfa divisao;
+                        divisao.epsilon = true;
+                        divisao.proximo = corpo.inicio;
+                        int32_t d = novoNo(divisao);
+                        corpo.saidas.push_back({d, true});
+                        anexar({d, std::move(corpo.saidas)});
+                    }
+                }
+                return resultado;
+            }
+        }
+    }
+
+    // DFA
+    std::array<uint8_t, 256> classes{};
+    uint32_t numClasses = 1;
+    std::vector<uint32_t> transicoes;
+    std::vector<uint32_t> inicioAceitas; // aceitas do estado e: aceitas[inicioAceitas[e] .. inicioAceitas[e+1])
+    std::vector<uint32_t> aceitas;
+    size_t numPadroes = 0;
+    std::vector<uint8_t> iniciais; // bytes que tiram o DFA do estado inicial
+
+    bool saltoSimd() const {
+#ifdef __SSE2__
+        return !iniciais.empty() && iniciais.size() <= 16;
+#else
+        return false;
+#endif
+    }
+
+    // Mesmo salto de AutomatoPadroes: no estado inicial, blocos sem byte inicial não mudam nada
+    bool blocoSemIniciais(const unsigned char* p) const {
+#ifdef __SSE2__
+        __m128i bloco = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i achados = _mm_setzero_si128();
+        for (uint8_t c : iniciais) {
+            achados = _mm_or_si128(achados, _mm_cmpeq_epi8(bloco, _mm_set1_epi8(static_cast<char>(c))));
+        }
+        return _mm_movemask_epi8(achados) == 0;
+#else
+        (void)p;
+        return false;
+#endif
+    }
+
+    std::vector<uint32_t> marcas;
+    uint32_t geracao = 0;
+
+    // Fecho epsilon, mantendo só os nós que consomem bytes e os finais (ordenados: chave do estado)
+    std::vector<int32_t> fecho(std::vector<int32_t> pilha) {
+        ++geracao;
+        std::vector<int32_t> resultado;
+        while (!pilha.empty()) {
+            int32_t n = pilha.back();
+            pilha.pop_back();
+            if (n < 0 || marcas[n] == geracao) continue;
+            marcas[n] = geracao;
+            const NoNfa& no = nfa[n];
+            if (no.epsilon) {
+                pilha.push_back(no.proximo);
+                pilha.push_back(no.alternativo);
+            } else {
+                resultado.push_back(n);
+            }
+        }
+        std::sort(resultado.begin(), resultado.end());
+        return resultado;
+    }
+
+    // Classes de bytes: bytes que nenhum conjunto do NFA distingue ficam na mesma coluna
+    void calcularClasses() {
+        std::array<uint32_t, 256> particao{};
+        uint32_t total = 1;
+        std::vector<Bytes> vistos;
+        for (const auto& no : nfa) {
+            if (no.epsilon || no.aceita >= 0) continue;
+            if (std::find(vistos.begin(), vistos.end(), no.bytes) != vistos.end()) continue;
+            vistos.push_back(no.bytes);
+            std::map<std::pair<uint32_t, bool>, uint32_t> novas;
+            for (int c = 0; c < 256; ++c) {
+                auto chave = std::make_pair(particao[c], static_cast<bool>(no.bytes[c]));
+                auto it = novas.emplace(chave, static_cast<uint32_t>(novas.size())).first;
+                particao[c] = it->second;
+            }
+            total = static_cast<uint32_t>(novas.size());
+        }
+        numClasses = total;
+        for (int c = 0; c < 256; ++c) classes[c] = static_cast<uint8_t>(particao[c]);
+    }
+
+public:
+    // Literais primeiro (como sequências de bytes), depois as expressões: a ordem das contagens
+    AutomatoExpressoes(const std::vector<std::string>& literais, const std::vector<std::string>& expressoes,
+                       bool ignorarCaixa) {
+        std::vector<int32_t> inicios;
+        auto adicionar = [&](const Arvore& arvore) {
+            Fragmento fragmento = compilar(arvore);
+            NoNfa final;
+            final.aceita = static_cast<int32_t>(numPadroes++);
+            ligar(fragmento, novoNo(final));
+            inicios.push_back(fragmento.inicio);
+        };
+        for (const auto& literal : literais) {
+            if (literal.empty()) {
+                throw std::invalid_argument("padrão vazio");
+            }
+            Arvore seq;
+            seq.tipo = Arvore::Sequencia;
+            for (unsigned char c : literal) {
+                Arvore byte;
+                byte.tipo = Arvore::Conjunto;
+                byte.bytes.set(c);
+                if (ignorarCaixa && std::isalpha(c)) {
+                    byte.bytes.set(std::tolower(c));
+                    byte.bytes.set(std::toupper(c));
+                }
+                seq.filhos.push_back(std::move(byte));
+            }
+            adicionar(seq);
+        }
+        for (const auto& expressao : expressoes) {
+            Arvore arvore = Analisador(expressao, ignorarCaixa).analisar();
+            if (casaVazio(arvore)) {
+                throw std::invalid_argument("expressão regular \"" + expressao + "\" casa a cadeia vazia");
+            }
+            adicionar(arvore);
+        }
+
+        calcularClasses();
+        std::array<int, 256> representante{};
+        representante.fill(-1);
+        for (int c = 255; c >= 0; --c) representante[classes[c]] = c;
+
+        // Subconjuntos: todo estado inclui o fecho dos inícios (casamento pode começar em qualquer
+        // byte). Esse fecho fica implícito na chave, e os passos a partir dele são calculados uma vez
+        // por classe: com milhares de literais ele domina o tamanho de cada conjunto
+        marcas.assign(nfa.size(), 0);
+        const std::vector<int32_t> fechoInicial = fecho(inicios);
+        std::vector<bool> noInicial(nfa.size(), false);
+        for (int32_t n : fechoInicial) noInicial[n] = true;
+        auto avancar = [&](const std::vector<int32_t>& conjunto, uint32_t c) {
+            std::vector<int32_t> destino;
+            for (int32_t n : conjunto) {
+                if (nfa[n].aceita < 0 && nfa[n].bytes[representante[c]]) destino.push_back(nfa[n].proximo);
+            }
+            std::vector<int32_t> alcancados = fecho(std::move(destino));
+            alcancados.erase(std::remove_if(alcancados.begin(), alcancados.end(),
+                                            [&](int32_t n) { return noInicial[n]; }),
+                             alcancados.end());
+            return alcancados;
+        };
+        std::vector<std::vector<int32_t>> passosIniciais;
+        for (uint32_t c = 0; c < numClasses; ++c) {
+            passosIniciais.push_back(avancar(fechoInicial, c));
+        }
+
+        std::map<std::vector<int32_t>, uint32_t> ids;
+        std::vector<std::vector<int32_t>> conjuntos(1); // estado 0: só o fecho inicial
+        ids.emplace(conjuntos[0], 0);
+        for (size_t e = 0; e < conjuntos.size(); ++e) {
+            if ((e + 1) * numClasses > maximoTransicoes || e + 1 > maximoEstados) {
+                throw std::invalid_argument("expressões regulares geram estados demais no autômato");
+            }
+            transicoes.resize((e + 1) * numClasses);
+            for (uint32_t c = 0; c < numClasses; ++c) {
+                std::vector<int32_t> alcancados = avancar(conjuntos[e], c);
+                std::vector<int32_t> proximo;
+                proximo.reserve(alcancados.size() + passosIniciais[c].size());
+                std::set_union(alcancados.begin(), alcancados.end(), passosIniciais[c].begin(),
+                               passosIniciais[c].end(), std::back_inserter(proximo));
+                auto [it, novo] = ids.emplace(std::move(proximo), static_cast<uint32_t>(conjuntos.size()));
+                if (novo) conjuntos.push_back(it->first);
+                transicoes[e * numClasses + c] = it->second;
+            }
+        }
+
+        inicioAceitas.reserve(conjuntos.size() + 1);
+        for (const auto& conjunto : conjuntos) {
+            inicioAceitas.push_back(static_cast<uint32_t>(aceitas.size()));
+            for (int32_t n : conjunto) {
+                if (nfa[n].aceita >= 0) aceitas.push_back(static_cast<uint32_t>(nfa[n].aceita));
+            }
+        }
+        inicioAceitas.push_back(static_cast<uint32_t>(aceitas.size()));
+
+        for (int c = 0; c < 256; ++c) {
+            if (transicoes[classes[c]] != 0) iniciais.push_back(static_cast<uint8_t>(c));
+        }
+        nfa.clear();
+        nfa.shrink_to_fit();
+        marcas.clear();
+        marcas.shrink_to_fit();
+    }
+
+    // Ocorrências (posições em que termina um casamento) de cada padrão
+    std::vector<uint64_t> contar(const char* dados, size_t tamanho) const {
+        uint32_t estados = static_cast<uint32_t>(inicioAceitas.size() - 1);
+        std::vector<uint64_t> visitas(estados, 0);
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(dados);
+        const uint32_t* delta = transicoes.data();
+        const size_t largura = numClasses;
+        const bool saltar = saltoSimd();
+        uint32_t estado = 0;
+        size_t i = 0;
+        while (i < tamanho) {
+            if (saltar && estado == 0 && i + 16 <= tamanho && blocoSemIniciais(p + i)) {
+                i += 16;
+                continue;
+            }
+            size_t fimBloco = std::min(tamanho, i + 16);
+            for (; i < fimBloco; ++i) {
+                estado = delta[estado * largura + classes[p[i]]];
+                visitas[estado]++;
+            }
+        }
+        std::vector<uint64_t> contagens(numPadroes, 0);
+        for (uint32_t e = 0; e < estados; ++e) {
+            if (visitas[e] == 0) continue;
+            for (uint32_t k = inicioAceitas[e]; k < inicioAceitas[e + 1]; ++k) {
+                contagens[aceitas[k]] += visitas[e];
+            }
+        }
+        return contagens;
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["tipo"] = "dfa";
+        e["estados"] = Json::Value::UInt64(inicioAceitas.size() - 1);
+        e["classes"] = numClasses;
+        e["bytes_iniciais"] = Json::Value::UInt64(iniciais.size());
+        e["salto_simd"] = saltoSimd();
+        return e;
+    }
+};
+
+class ConjuntoPadroes {
+private:
+    std::vector<std::string> literais;
+    std::vector<std::string> expressoesTexto;
+    // Só literais: Aho-Corasick. Com expressões, tudo vai para o mesmo DFA (uma passada)
+    std::unique_ptr<AutomatoPadroes> automato;
+    std::unique_ptr<AutomatoExpressoes> automatoExpressoes;
+
+public:
+    ConjuntoPadroes(std::vector<std::string> padroes, std::vector<std::string> regex, bool ignorarCaixa)
+        : literais(std::move(padroes)), expressoesTexto(std::move(regex)) {
+        if (!expressoesTexto.empty()) {
+            automatoExpressoes = std::make_unique<AutomatoExpressoes>(literais, expressoesTexto, ignorarCaixa);
+        } else if (!literais.empty()) {
+            automato = std::make_unique<AutomatoPadroes>(literais, ignorarCaixa);
+        }
+    }
+
+    // Literais e expressões em uma única passada pelo texto
+    Json::Value contar(const char* dados, size_t tamanho, uint64_t& total) const {
+        Json::Value lista(Json::arrayValue);
+        total = 0;
+        std::vector<uint64_t> contagens;
+        if (automatoExpressoes) {
+            contagens = automatoExpressoes->contar(dados, tamanho);
+        } else if (automato) {
+            contagens = automato->contar(dados, tamanho);
+        }
+        for (size_t i = 0; i < contagens.size(); ++i) {
+            bool literal = i < literais.size();
+            Json::Value item;
+            item["padrao"] = literal ? literais[i] : expressoesTexto[i - literais.size()];
+            item["tipo"] = literal ? "literal" : "regex";
+            item["quantidade"] = Json::Value::UInt64(contagens[i]);
+            lista.append(item);
+            total += contagens[i];
+        }
+        return lista;
+    }
+
+    Json::Value estado() const {
+        Json::Value e = automatoExpressoes ? automatoExpressoes->estado()
+                        : automato ? automato->estado() : Json::Value(Json::objectValue);
+        e["literais"] = Json::Value::UInt64(literais.size());
+        e["expressoes"] = Json::Value::UInt64(expressoesTexto.size());
+        return e;
+    }
+
+    // Chave do cache: hash de uma descrição sem ambiguidade (tamanho:conteúdo de cada item)
+    static std::string chave(const std::vector<std::string>& padroes, const std::vector<std::string>& regex,
+                             bool ignorarCaixa) {
+        std::string descricao = ignorarCaixa ? "i" : "c";
+        for (const auto* lista : {&padroes, &regex}) {
+            descricao += '|';
+            for (const auto& item : *lista) {
+                descricao += std::to_string(item.size());
+                descricao += ':';
+                descricao += item;
+            }
+        }
+        return hashConteudo(descricao);
+    }
+};
+
+// Conjuntos compilados mais recentes (FIFO, como CacheFragmentos); compilação fora da trava
+class CacheConjuntos {
+private:
+    std::unordered_map<std::string, std::shared_ptr<const ConjuntoPadroes>> conjuntos;
+    std::deque<std::string> ordemInsercao;
+    size_t capacidade;
+    uint64_t acertos = 0;
+    uint64_t compilacoes = 0;
+    mutable std::mutex mutex;
+
+public:
+    explicit CacheConjuntos(size_t maximo) : capacidade(maximo > 0 ? maximo : 1) {}
+
+    std::shared_ptr<const ConjuntoPadroes> buscar(const std::string& chave) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = conjuntos.find(chave);
+        if (it == conjuntos.end()) {
+            return nullptr;
+        }
+        ++acertos;
+        return it->second;
+    }
+
+    std::shared_ptr<const ConjuntoPadroes> inserir(const std::string& chave,
+                                                   std::shared_ptr<const ConjuntoPadroes> conjunto) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++compilacoes;
+        auto [it, novo] = conjuntos.emplace(chave, std::move(conjunto));
+        if (!novo) {
+            return it->second; // outra requisição compilou o mesmo conjunto antes
+        }
+        ordemInsercao.push_back(chave);
+        while (conjuntos.size() > capacidade) {
+            conjuntos.erase(ordemInsercao.front());
+            ordemInsercao.pop_front();
+        }
+        return it->second;
+    }
+
+    Json::Value estado() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Json::Value e;
+        e["conjuntos"] = Json::Value::UInt64(conjuntos.size());
+        e["capacidade"] = Json::Value::UInt64(capacidade);
+        e["acertos"] = Json::Value::UInt64(acertos);
+        e["compilacoes"] = Json::Value::UInt64(compilacoes);
+        return e;
+    }
+};
+
+#endif // BUSCA_PADROES_H
@@ -0,0 +1,66 @@
+#ifndef CACHE_FRAGMENTOS_H
+#define CACHE_FRAGMENTOS_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <jsoncpp/json/json.h>
+
+// Contagens já calculadas por hash de fragmento (ver Fragmentacao.h), com capacidade
+// limitada: ao encher, descarta os fragmentos mais antigos (FIFO).
+class CacheFragmentos {
+public:
+    struct Contagem {
+        uint64_t letras = 0;
+        uint64_t numeros = 0;
+    };
+
+private:
+    std::unordered_map<std::string, Contagem> contagens;
+    std::deque<std::string> ordemInsercao;
+    size_t capacidade;
+    uint64_t acertos = 0;
+    uint64_t faltas = 0;
+    mutable std::mutex mutex;
+
+public:
+    explicit CacheFragmentos(size_t maximo) : capacidade(maximo > 0 ? maximo : 1) {}
+
+    bool buscar(const std::string& hash, Contagem& contagem) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = contagens.find(hash);
+        if (it == contagens.end()) {
+            ++faltas;
+            return false;
+        }
+        ++acertos;
+        contagem = it->second;
+        return true;
+    }
+
+    void inserir(const std::string& hash, const Contagem& contagem) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!contagens.emplace(hash, contagem).second) {
+            return;
+        }
+        ordemInsercao.push_back(hash);
+        while (contagens.size() > capacidade) {
+            contagens.erase(ordemInsercao.front());
+            ordemInsercao.pop_front();
+        }
+    }
+
+    Json::Value estado() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Json::Value e;
+        e["fragmentos"] = Json::Value::UInt64(contagens.size());
+        e["capacidade"] = Json::Value::UInt64(capacidade);
+        e["acertos"] = Json::Value::UInt64(acertos);
+        e["faltas"] = Json::Value::UInt64(faltas);
+        return e;
+    }
+};
+
+#endif // CACHE_FRAGMENTOS_H
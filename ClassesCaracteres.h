@@ -0,0 +1,180 @@
+#ifndef CLASSES_CARACTERES_H
+#define CLASSES_CARACTERES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Políticas de classe de caractere usadas pelos analisadores.
+// Cada política define o predicado `pertence` (avaliado em tempo de compilação)
+// e os metadados do serviço que a expõe (rota, porta, nomes para log e JSON).
+// Os predicados seguem a semântica de <cctype> no locale "C".
+
+struct PoliticaLetras {
+    static constexpr const char* nome = "Escravo1";
+    static constexpr const char* servico = "escravo1-letras";
+    static constexpr const char* funcionalidade = "contador de letras";
+    static constexpr const char* rota = "/letras";
+    static constexpr const char* tipo = "letras";
+    static constexpr bool roteadoPeloMestre = true; // o Mestre tem grupo para este tipo
+    static constexpr const char* processadoPor = "escravo1";
+    static constexpr const char* rotulo = "letras";
+    static constexpr const char* encontrados = "Encontradas";
+    static constexpr int porta = 8081;
+
+    static constexpr bool pertence(unsigned char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+};
+
+struct PoliticaNumeros {
+    static constexpr const char* nome = "Escravo2";
+    static constexpr const char* servico = "escravo2-numeros";
+    static constexpr const char* funcionalidade = "contador de números";
+    static constexpr const char* rota = "/numeros";
+    static constexpr const char* tipo = "numeros";
+    static constexpr bool roteadoPeloMestre = true; // o Mestre tem grupo para este tipo
+    static constexpr const char* processadoPor = "escravo2";
+    static constexpr const char* rotulo = "números";
+    static constexpr const char* encontrados = "Encontrados";
+    static constexpr int porta = 8082;
+
+    static constexpr bool pertence(unsigned char c) {
+        return c >= '0' && c <= '9';
+    }
+};
+
+struct PoliticaVogais {
+    static constexpr const char* nome = "EscravoVogais";
+    static constexpr const char* servico = "escravo-vogais";
+    static constexpr const char* funcionalidade = "contador de vogais";
+    static constexpr const char* rota = "/vogais";
+    static constexpr const char* tipo = "vogais";
+    static constexpr bool roteadoPeloMestre = false; // o Mestre não roteia este tipo: não se registra
+    static constexpr const char* processadoPor = "escravo-vogais";
+    static constexpr const char* rotulo = "vogais";
+    static constexpr const char* encontrados = "Encontradas";
+    static constexpr int porta = 8084;
+
+    static constexpr bool pertence(unsigned char c) {
+        switch (c | 0x20) {
+            case 'a': case 'e': case 'i': case 'o': case 'u':
+                return true;
+            default:
+                return false;
+        }
+    }
+};
+
+struct PoliticaMaiusculas {
+    static constexpr const char* nome = "EscravoMaiusculas";
+    static constexpr const char* servico = "escravo-maiusculas";
+    static constexpr const char* funcionalidade = "contador de letras maiúsculas";
+    static constexpr const char* rota = "/maiusculas";
+    static constexpr const char* tipo = "maiusculas";
+    static constexpr bool roteadoPeloMestre = false; // o Mestre não roteia este tipo: não se registra
+    static constexpr const char* processadoPor = "escravo-maiusculas";
+    static constexpr const char* rotulo = "maiúsculas";
+    static constexpr const char* encontrados = "Encontradas";
+    static constexpr int porta = 8085;
+
+    static constexpr bool pertence(unsigned char c) {
+        return c >= 'A' && c <= 'Z';
+    }
+};
+
+struct PoliticaEspacos {
+    static constexpr const char* nome = "EscravoEspacos";
+    static constexpr const char* servico = "escravo-espacos";
+    static constexpr const char* funcionalidade = "contador de espaços em branco";
+    static constexpr const char* rota = "/espacos";
+    static constexpr const char* tipo = "espacos";
+    static constexpr bool roteadoPeloMestre = false; // o Mestre não roteia este tipo: não se registra
+    static constexpr const char* processadoPor = "escravo-espacos";
+    static constexpr const char* rotulo = "espaços";
+    static constexpr const char* encontrados = "Encontrados";
+    static constexpr int porta = 8086;
+
+    static constexpr bool pertence(unsigned char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+};
+
+// Tabela de pertinência (0 ou 1 por byte) gerada em tempo de compilação
+template <typename Politica>
+struct TabelaClasse {
+    static constexpr std::array<uint8_t, 256> gerar() {
+        std::array<uint8_t, 256> tabela{};
+        for (int c = 0; c < 256; ++c) {
+            tabela[c] = Politica::pertence(static_cast<unsigned char>(c)) ? 1 : 0;
+        }
+        return tabela;
+    }
+
+    static constexpr std::array<uint8_t, 256> valores = gerar();
+};
+
+// Kernel de contagem especializado por política: soma direta da tabela,
+// sem desvios dependentes do conteúdo, com quatro acumuladores independentes
+template <typename Politica>
+inline uint64_t contarClasse(const char* dados, size_t tamanho) {
+    const auto& tabela = TabelaClasse<Politica>::valores;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(dados);
+
+    uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= tamanho; i += 4) {
+        a0 += tabela[p[i]];
+        a1 += tabela[p[i + 1]];
+        a2 += tabela[p[i + 2]];
+        a3 += tabela[p[i + 3]];
+    }
+    for (; i < tamanho; ++i) {
+        a0 += tabela[p[i]];
+    }
+    return a0 + a1 + a2 + a3;
+}
+
+// Vários textos empacotados em um buffer contíguo (fins[i] = fim do i-ésimo): o mesmo kernel
+// percorre o buffer inteiro uma vez, sem reiniciar os acumuladores a cada segmento; no fim de
+// cada segmento o total corrido é lido e a diferença para o anterior vai para quantidades[i]
+template <typename Politica>
+inline void contarClasseSegmentos(const char* dados, const size_t* fins, size_t segmentos, uint64_t* quantidades) {
+    const auto& tabela = TabelaClasse<Politica>::valores;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(dados);
+
+    uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    uint64_t anterior = 0;
+    size_t i = 0;
+    for (size_t s = 0; s < segmentos; ++s) {
+        const size_t fim = fins[s];
+        for (; i + 4 <= fim; i += 4) {
+            a0 += tabela[p[i]];
+            a1 += tabela[p[i + 1]];
+            a2 += tabela[p[i + 2]];
+            a3 += tabela[p[i + 3]];
+        }
+        for (; i < fim; ++i) {
+            a0 += tabela[p[i]];
+        }
+        uint64_t corrido = a0 + a1 + a2 + a3;
+        quantidades[s] = corrido - anterior;
+        anterior = corrido;
+    }
+}
+
+template <typename Politica>
+inline uint64_t contarClasse(const std::string& texto) {
+    return contarClasse<Politica>(texto.data(), texto.size());
+}
+
+inline int contarLetrasTexto(const std::string& texto) {
+    return static_cast<int>(contarClasse<PoliticaLetras>(texto));
+}
+
+inline int contarNumerosTexto(const std::string& texto) {
+    return static_cast<int>(contarClasse<PoliticaNumeros>(texto));
+}
+
+#endif // CLASSES_CARACTERES_H
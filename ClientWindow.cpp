@@ -1,12 +1,15 @@
 #include "ClientWindow.h"
+#include "Fragmentacao.h"
 #include <QVBoxLayout>
 #include <QGroupBox>
 #include <QCoreApplication>
+#include <filesystem>
 #include <fstream> // Add this line
+#include <unordered_map>
 
 ClientWindow::ClientWindow(QWidget *parent) : QMainWindow(parent) {
     setWindowTitle("Sistema Distribuído - Cliente");
-    setFixedSize(500, 450);
+    setFixedSize(560, 590);
 
     // Layout principal
     QWidget *centralWidget = new QWidget(this);
@@ -29,18 +32,24 @@ ClientWindow::ClientWindow(QWidget *parent) : QMainWindow(parent) {
     configLayout->addWidget(editPort);
 
     // --- Seção de Arquivo ---
-    QGroupBox *fileGroup = new QGroupBox("Arquivo de Entrada", this);
+    QGroupBox *fileGroup = new QGroupBox("Arquivo ou Pasta de Entrada", this);
     mainLayout->addWidget(fileGroup);
     QVBoxLayout *fileLayout = new QVBoxLayout(fileGroup);
 
-    labelFile = new QLabel("Caminho do Arquivo:", this);
+    labelFile = new QLabel("Caminho do Arquivo ou Pasta:", this);
     editFile = new QLineEdit(this);
     buttonSelectFile = new QPushButton("Selecionar Arquivo...", this);
+    buttonSelectFolder = new QPushButton("Selecionar Pasta...", this);
     buttonProcess = new QPushButton("Processar", this);
+    checkIncremental = new QCheckBox("Modo incremental (envia só os trechos alterados)", this);
+    checkProgressivo = new QCheckBox("Resultados parciais (exibe a contagem enquanto processa)", this);
 
     fileLayout->addWidget(labelFile);
     fileLayout->addWidget(editFile);
     fileLayout->addWidget(buttonSelectFile);
+    fileLayout->addWidget(buttonSelectFolder);
+    fileLayout->addWidget(checkIncremental);
+    fileLayout->addWidget(checkProgressivo);
     fileLayout->addWidget(buttonProcess);
 
     // --- Seção de Resultado ---
@@ -48,13 +57,23 @@ ClientWindow::ClientWindow(QWidget *parent) : QMainWindow(parent) {
     mainLayout->addWidget(outputGroup);
     QVBoxLayout *outputLayout = new QVBoxLayout(outputGroup);
 
+    labelProgresso = new QLabel(this);
     textOutput = new QTextEdit(this);
     textOutput->setReadOnly(true);
+    outputLayout->addWidget(labelProgresso);
     outputLayout->addWidget(textOutput);
 
+    timerIngestao = new QTimer(this);
+    timerIngestao->setInterval(250);
+    timerProgressivo = new QTimer(this);
+    timerProgressivo->setInterval(100);
+
     // Conecta os botões aos slots
     connect(buttonSelectFile, &QPushButton::clicked, this, &ClientWindow::selectFile);
+    connect(buttonSelectFolder, &QPushButton::clicked, this, &ClientWindow::selectFolder);
     connect(buttonProcess, &QPushButton::clicked, this, &ClientWindow::processFile);
+    connect(timerIngestao, &QTimer::timeout, this, &ClientWindow::atualizarIngestao);
+    connect(timerProgressivo, &QTimer::timeout, this, &ClientWindow::atualizarProgressivo);
 }
 
 ClientWindow::~ClientWindow() {}
@@ -66,6 +85,13 @@ void ClientWindow::selectFile() {
     }
 }
 
+void ClientWindow::selectFolder() {
+    QString pasta = QFileDialog::getExistingDirectory(this, "Selecionar Pasta com Arquivos de Texto");
+    if (!pasta.isEmpty()) {
+        editFile->setText(pasta);
+    }
+}
+
 void ClientWindow::processFile() {
     try {
         std::string host = editHost->text().toStdString();
@@ -77,11 +103,24 @@ void ClientWindow::processFile() {
             return;
         }
 
+        if (std::filesystem::is_directory(nomeArquivo)) {
+            processarPasta(nomeArquivo, host, port);
+            return;
+        }
+
         textOutput->append("Lendo arquivo: " + QString::fromStdString(nomeArquivo));
         std::string conteudo = lerArquivo(nomeArquivo);
 
+        // O modo incremental já evita reenviar o texto; o progressivo vale para o envio completo
+        if (checkProgressivo->isChecked() && !checkIncremental->isChecked()) {
+            processarProgressivo(conteudo, host, port);
+            return;
+        }
+
         textOutput->append("Enviando para o servidor mestre...");
-        Json::Value resultado = enviarArquivo(conteudo, host, port);
+        Json::Value resultado = checkIncremental->isChecked()
+            ? enviarIncremental(conteudo, host, port)
+            : enviarArquivo(conteudo, host, port);
 
         exibirResultado(resultado);
 
@@ -112,10 +151,57 @@ Json::Value ClientWindow::enviarArquivo(const std::string& conteudo, const std::
     Json::Value requestJson;
     requestJson["texto"] = conteudo;
     
+    return postarJson(client, "/processar", requestJson);
+}
+
+// Envia primeiro só o manifesto de fragmentos; o Mestre responde com os hashes que
+// não tem em cache e o cliente reenvia o manifesto acompanhado apenas desses fragmentos
+Json::Value ClientWindow::enviarIncremental(const std::string& conteudo, const std::string& host, int port) {
+    httplib::Client client(host, port);
+    client.set_keep_alive(true);
+    
+    std::vector<Fragmento> fragmentos = fragmentar(conteudo);
+    std::unordered_map<std::string, const Fragmento*> porHash;
+    Json::Value requestJson;
+    requestJson["manifesto"] = Json::Value(Json::arrayValue);
+    for (const auto& fragmento : fragmentos) {
+        Json::Value item;
+        item["hash"] = fragmento.hash;
+        item["tamanho"] = Json::Value::UInt64(fragmento.tamanho);
+        requestJson["manifesto"].append(item);
+        porHash[fragmento.hash] = &fragmento;
+    }
+    textOutput->append("Manifesto com " + QString::number(fragmentos.size()) + " fragmentos");
+    
+    // Com vários processos no Mestre, cada um tem o seu cache: mais de uma rodada pode ser necessária
+    for (int rodada = 0; rodada < 4; ++rodada) {
+        Json::Value resultado = postarJson(client, "/processar/incremental", requestJson);
+        if (resultado["completo"].asBool()) {
+            textOutput->append("Fragmentos reaproveitados: "
+                              + QString::number(resultado["fragmentos_reaproveitados"].asUInt64())
+                              + ", novos: " + QString::number(resultado["fragmentos_novos"].asUInt64()));
+            return resultado;
+        }
+        
+        requestJson["fragmentos"] = Json::Value(Json::objectValue);
+        for (const auto& hash : resultado["faltando"]) {
+            auto it = porHash.find(hash.asString());
+            if (it == porHash.end()) {
+                throw std::runtime_error("Servidor pediu fragmento desconhecido: " + hash.asString());
+            }
+            requestJson["fragmentos"][it->first] = conteudo.substr(it->second->inicio, it->second->tamanho);
+        }
+        textOutput->append("Enviando " + QString::number(resultado["faltando"].size()) + " fragmentos alterados...");
+    }
+    
+    throw std::runtime_error("Processamento incremental não concluiu");
+}
+
+Json::Value ClientWindow::postarJson(httplib::Client& client, const std::string& rota, const Json::Value& requestJson) {
     Json::StreamWriterBuilder builder;
     std::string jsonString = Json::writeString(builder, requestJson);
     
-    auto resposta = client.Post("/processar", jsonString, "application/json");
+    auto resposta = client.Post(rota, jsonString, "application/json");
     
     if (!resposta) {
         throw std::runtime_error("Erro na comunicação com o servidor mestre");
@@ -136,9 +222,126 @@ Json::Value ClientWindow::enviarArquivo(const std::string& conteudo, const std::
 
 void ClientWindow::exibirResultado(const Json::Value& resultado) {
     textOutput->append("\n<font color=\"blue\">=== RESULTADO ===</font>");
-    textOutput->append("Quantidade de letras: " + QString::number(resultado["letras"].asInt()));
-    textOutput->append("Quantidade de números: " + QString::number(resultado["numeros"].asInt()));
+    textOutput->append("Quantidade de letras: " + QString::number(resultado["letras"].asUInt64()));
+    textOutput->append("Quantidade de números: " + QString::number(resultado["numeros"].asUInt64()));
     textOutput->append("Total de caracteres processados: " 
-                      + QString::number(resultado["letras"].asInt() + resultado["numeros"].asInt()));
+                      + QString::number(resultado["letras"].asUInt64() + resultado["numeros"].asUInt64()));
     textOutput->append("<font color=\"blue\">================</font>\n");
-}
\ No newline at end of file
+}
+
+// Pasta: o pipeline roda em threads próprias e a janela só acompanha o progresso pelo timer
+void ClientWindow::processarPasta(const std::string& pasta, const std::string& host, int port) {
+    if (ingestao) {
+        QMessageBox::warning(this, "Erro", "Já existe uma pasta em processamento.");
+        return;
+    }
+
+    textOutput->append("Processando pasta: " + QString::fromStdString(pasta));
+    resultadosExibidos = 0;
+    ingestao = std::make_unique<IngestaoDiretorio>(pasta, host, port);
+    ingestao->iniciar();
+    buttonProcess->setEnabled(false);
+    timerIngestao->start();
+}
+
+void ClientWindow::atualizarIngestao() {
+    if (!ingestao) {
+        timerIngestao->stop();
+        return;
+    }
+
+    for (const auto& resultado : ingestao->resultadosDesde(resultadosExibidos)) {
+        QString caminho = QString::fromStdString(resultado.caminho);
+        if (!resultado.erro.empty()) {
+            textOutput->append("<font color=\"red\">" + caminho + ": " + QString::fromStdString(resultado.erro) + "</font>");
+        } else {
+            textOutput->append(caminho + ": letras=" + QString::number(resultado.letras)
+                              + ", números=" + QString::number(resultado.numeros)
+                              + (resultado.reaproveitado ? " (conteúdo repetido)" : ""));
+        }
+        ++resultadosExibidos;
+    }
+
+    ProgressoIngestao progresso = ingestao->estado();
+    labelProgresso->setText(QString("Arquivos: %1/%2%3 | falhas: %4 | %5 arquivos/s | %6 MB/s")
+                                .arg(progresso.arquivosConcluidos)
+                                .arg(progresso.arquivosEncontrados)
+                                .arg(progresso.varreduraConcluida ? "" : "+")
+                                .arg(progresso.falhas)
+                                .arg(progresso.arquivosPorSegundo(), 0, 'f', 1)
+                                .arg(progresso.megabytesPorSegundo(), 0, 'f', 2));
+
+    if (!progresso.concluido) {
+        return;
+    }
+
+    timerIngestao->stop();
+    ingestao->aguardar();
+    ingestao.reset();
+    buttonProcess->setEnabled(true);
+
+    textOutput->append("\n<font color=\"blue\">=== RESULTADO DA PASTA ===</font>");
+    textOutput->append("Arquivos processados: " + QString::number(progresso.arquivosConcluidos)
+                      + " (falhas: " + QString::number(progresso.falhas) + ")");
+    textOutput->append("Quantidade de letras: " + QString::number(progresso.letras));
+    textOutput->append("Quantidade de números: " + QString::number(progresso.numeros));
+    textOutput->append("Tempo: " + QString::number(progresso.segundos, 'f', 2) + " s ("
+                      + QString::number(progresso.megabytesPorSegundo(), 'f', 2) + " MB/s)");
+    textOutput->append("<font color=\"blue\">================</font>\n");
+}
+
+// Arquivo com resultados parciais: a janela continua responsiva e mostra cada fragmento contado
+void ClientWindow::processarProgressivo(const std::string& conteudo, const std::string& host, int port) {
+    if (progressivo) {
+        QMessageBox::warning(this, "Erro", "Já existe um arquivo em processamento.");
+        return;
+    }
+
+    textOutput->append("Enviando para o servidor mestre (resultados parciais)...");
+    eventosExibidos = 0;
+    labelProgresso->setText("Aguardando o primeiro fragmento...");
+    progressivo = std::make_unique<ProcessamentoProgressivo>(host, port, conteudo);
+    progressivo->iniciar();
+    buttonProcess->setEnabled(false);
+    timerProgressivo->start();
+}
+
+void ClientWindow::atualizarProgressivo() {
+    if (!progressivo) {
+        timerProgressivo->stop();
+        return;
+    }
+
+    // Lido antes dos eventos: se a thread já terminou, nenhum evento fica para trás
+    bool terminou = progressivo->terminou();
+    for (const auto& evento : progressivo->eventosDesde(eventosExibidos)) {
+        ++eventosExibidos;
+        const Json::Value& dados = evento.dados;
+        if (evento.tipo == "parcial") {
+            textOutput->append("Fragmento " + QString::number(dados["fragmento"].asUInt64() + 1)
+                              + " (" + QString::fromStdString(dados["tipo"].asString()) + "): "
+                              + QString::number(dados["quantidade"].asUInt64()));
+            labelProgresso->setText(QString("Progresso: %1% | letras até agora: %2 | números até agora: %3")
+                                        .arg(dados["progresso"].asDouble() * 100.0, 0, 'f', 0)
+                                        .arg(dados["letras"].asUInt64())
+                                        .arg(dados["numeros"].asUInt64()));
+        } else if (evento.tipo == "resultado") {
+            labelProgresso->setText(dados["armazenado"].asBool() ? "Concluído (resultado já armazenado no Mestre)"
+                                                                 : "Concluído");
+            exibirResultado(dados);
+        } else if (evento.tipo == "erro") {
+            labelProgresso->setText("Falhou");
+            textOutput->append("<font color=\"red\">Erro: "
+                              + QString::fromStdString(dados["erro"].asString()) + "</font>");
+        }
+    }
+
+    if (!terminou) {
+        return;
+    }
+
+    timerProgressivo->stop();
+    progressivo->aguardar();
+    progressivo.reset();
+    buttonProcess->setEnabled(true);
+}
@@ -3,13 +3,18 @@
 
 #include <QMainWindow>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QLabel>
 #include <QLineEdit>
 #include <QTextEdit>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QTimer>
+#include <memory>
 #include <httplib.h>
 #include <jsoncpp/json/json.h>
+#include "IngestaoDiretorio.h"
+#include "ProcessamentoProgressivo.h"
 
 class ClientWindow : public QMainWindow {
     Q_OBJECT
@@ -20,7 +25,10 @@ public:
 
 private slots:
     void selectFile();
+    void selectFolder();
     void processFile();
+    void atualizarIngestao();
+    void atualizarProgressivo();
 
 private:
     // Widgets da interface
@@ -31,13 +39,31 @@ private:
     QLabel* labelFile;
     QLineEdit* editFile;
     QPushButton* buttonSelectFile;
+    QPushButton* buttonSelectFolder;
     QPushButton* buttonProcess;
+    QCheckBox* checkIncremental;
+    QCheckBox* checkProgressivo;
+    QLabel* labelProgresso;
     QTextEdit* textOutput;
 
+    // Processamento de pasta: pipeline em threads próprias, acompanhado por um timer
+    std::unique_ptr<IngestaoDiretorio> ingestao;
+    QTimer* timerIngestao;
+    size_t resultadosExibidos = 0;
+
+    // Arquivo com resultados parciais: conexão em thread própria, eventos lidos pelo timer
+    std::unique_ptr<ProcessamentoProgressivo> progressivo;
+    QTimer* timerProgressivo;
+    size_t eventosExibidos = 0;
+
     // Lógica do cliente
     std::string lerArquivo(const std::string& nomeArquivo);
     Json::Value enviarArquivo(const std::string& conteudo, const std::string& host, int port);
+    Json::Value enviarIncremental(const std::string& conteudo, const std::string& host, int port);
+    Json::Value postarJson(httplib::Client& client, const std::string& rota, const Json::Value& requestJson);
     void exibirResultado(const Json::Value& resultado);
+    void processarPasta(const std::string& pasta, const std::string& host, int port);
+    void processarProgressivo(const std::string& conteudo, const std::string& host, int port);
 };
 
 #endif // CLIENTWINDOW_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef CONTAGEM_ALOCACOES_H
+#define CONTAGEM_ALOCACOES_H
+
+// Substitui o operator new global para contar alocações por thread (alocacoesThread), base do
+// "alocacoes.por_requisicao" do /health. Incluir em exatamente um .cpp por executável
+// (o que tem o main): as definições abaixo não são inline e não podem se repetir na ligação.
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "ArenaRequisicao.h"
+
+namespace {
+const bool contagemAlocacoesRegistrada = (contagemAlocacoesAtiva = true);
+
+// free() fora de linha: com o corpo visível, o GCC casa o ponteiro recebido pelo operator delete
+// com o malloc do operator new e acusa -Wmismatched-new-delete em cada delete do executável
+[[gnu::noinline]] void liberarAlocacao(void* p) noexcept {
+    std::free(p);
+}
+}
+
+void* operator new(std::size_t tamanho) {
+    ++alocacoesThread;
+    if (tamanho == 0) {
+        tamanho = 1;
+    }
+    while (true) {
+        if (void* p = std::malloc(tamanho)) {
+            return p;
+        }
+        std::new_handler tratador = std::get_new_handler();
+        if (!tratador) {
+            throw std::bad_alloc();
+        }
+        tratador();
+    }
+}
+
+void* operator new[](std::size_t tamanho) {
+    return ::operator new(tamanho);
+}
+
+// Variantes alinhadas: std::pmr::new_delete_resource() aloca por elas
+void* operator new(std::size_t tamanho, std::align_val_t alinhamento) {
+    ++alocacoesThread;
+    std::size_t a = static_cast<std::size_t>(alinhamento);
+    std::size_t arredondado = (std::max<std::size_t>(tamanho, 1) + a - 1) / a * a;
+    while (true) {
+        if (void* p = std::aligned_alloc(a, arredondado)) {
+            return p;
+        }
+        std::new_handler tratador = std::get_new_handler();
+        if (!tratador) {
+            throw std::bad_alloc();
+        }
+        tratador();
+    }
+}
+
+void* operator new[](std::size_t tamanho, std::align_val_t alinhamento) {
+    return ::operator new(tamanho, alinhamento);
+}
+
+void operator delete(void* p) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete[](void* p) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    liberarAlocacao(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    liberarAlocacao(p);
+}
+
+#endif // CONTAGEM_ALOCACOES_H
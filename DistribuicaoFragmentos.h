@@ -0,0 +1,146 @@
+#ifndef DISTRIBUICAO_FRAGMENTOS_H
+#define DISTRIBUICAO_FRAGMENTOS_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Distribuição de um texto grande entre as réplicas de um grupo:
+//
+// - planejarFragmentos: divide o texto em mais fragmentos que réplicas (porReplica por réplica),
+//   com tamanho proporcional à vazão observada de cada uma (bytes/s) e cortes em espaço em branco.
+//   Os fragmentos vão, em rodadas, para a fila da réplica que tem aquele tamanho.
+// - FilaFragmentos: cada réplica consome a sua fila pela frente; quando ela esvazia, rouba pelo
+//   fim da fila com mais bytes pendentes. O trabalho termina quando o conjunto termina, não
+//   quando a réplica mais lenta termina a sua parte fixa.
+
+struct FaixaTexto {
+    size_t inicio;
+    size_t fim;
+
+    size_t tamanho() const { return fim - inicio; }
+};
+
+struct PlanoFragmentos {
+    std::vector<FaixaTexto> faixas;
+    std::vector<size_t> dono; // réplica planejada para cada faixa
+};
+
+// pesos: vazão de cada réplica; valores <= 0 (ainda não medidos) usam a média dos conhecidos
+inline PlanoFragmentos planejarFragmentos(const std::string& texto, std::vector<double> pesos, size_t porReplica,
+                                          size_t minimo, size_t maximo) {
+    PlanoFragmentos plano;
+    if (pesos.empty()) {
+        pesos.push_back(1.0);
+    }
+    double soma = 0.0;
+    size_t conhecidos = 0;
+    for (double p : pesos) {
+        if (p > 0.0) {
+            soma += p;
+            conhecidos++;
+        }
+    }
+    double media = conhecidos > 0 ? soma / conhecidos : 1.0;
+    soma = 0.0;
+    for (double& p : pesos) {
+        if (p <= 0.0) p = media;
+        soma += p;
+    }
+
+    // Tamanho alvo por réplica: a parte dela no texto dividida em porReplica fragmentos
+    std::vector<size_t> alvos;
+    for (double p : pesos) {
+        double parte = static_cast<double>(texto.size()) * (p / soma) / std::max<size_t>(1, porReplica);
+        alvos.push_back(std::clamp(static_cast<size_t>(parte), std::max<size_t>(1, minimo), std::max(minimo, maximo)));
+    }
+
+    size_t inicio = 0;
+    while (inicio < texto.size()) {
+        for (size_t r = 0; r < alvos.size() && inicio < texto.size(); ++r) {
+            size_t fim = std::min(inicio + alvos[r], texto.size());
+            if (fim < texto.size()) {
+                size_t espaco = texto.find_first_of(" \t\r\n", fim);
+                fim = (espaco == std::string::npos) ? texto.size() : espaco + 1;
+            }
+            plano.faixas.push_back({inicio, fim});
+            plano.dono.push_back(r);
+            inicio = fim;
+        }
+    }
+    return plano;
+}
+
+class FilaFragmentos {
+private:
+    std::mutex mutex;
+    std::condition_variable mudou;
+    const std::vector<FaixaTexto>& faixas;
+    std::vector<std::deque<size_t>> filas;
+    std::vector<size_t> pendentes; // bytes ainda na fila de cada réplica
+    size_t emVoo = 0;              // fragmentos entregues e ainda não concluídos nem devolvidos
+
+    bool retirar(size_t fila, bool daFrente, size_t& fragmento) {
+        if (filas[fila].empty()) {
+            return false;
+        }
+        fragmento = daFrente ? filas[fila].front() : filas[fila].back();
+        if (daFrente) filas[fila].pop_front(); else filas[fila].pop_back();
+        pendentes[fila] -= faixas[fragmento].tamanho();
+        emVoo++;
+        return true;
+    }
+
+public:
+    explicit FilaFragmentos(const PlanoFragmentos& plano, size_t replicas)
+        : faixas(plano.faixas), filas(replicas), pendentes(replicas, 0) {
+        for (size_t i = 0; i < plano.faixas.size(); ++i) {
+            filas[plano.dono[i]].push_back(i);
+            pendentes[plano.dono[i]] += plano.faixas[i].tamanho();
+        }
+    }
+
+    // Próximo fragmento para a réplica; roubado = veio da fila de outra. Com as filas
+    // vazias mas fragmentos em voo, espera: se a réplica que o processa falhar, ele
+    // volta e precisa de quem o assuma. Falso só quando não resta nada a fazer.
+    bool pegar(size_t replica, size_t& fragmento, bool& roubado) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (retirar(replica, true, fragmento)) {
+                roubado = false;
+                return true;
+            }
+            size_t vitima = std::max_element(pendentes.begin(), pendentes.end()) - pendentes.begin();
+            if (retirar(vitima, false, fragmento)) {
+                roubado = true;
+                return true;
+            }
+            if (emVoo == 0) {
+                return false;
+            }
+            mudou.wait(lock);
+        }
+    }
+
+    // Fragmento processado com sucesso
+    void concluir(size_t /*fragmento*/) {
+        std::lock_guard<std::mutex> lock(mutex);
+        emVoo--;
+        if (emVoo == 0) mudou.notify_all();
+    }
+
+    // Fragmento de uma réplica que falhou: volta à fila dela, de onde as demais roubam
+    void devolver(size_t replica, size_t fragmento) {
+        std::lock_guard<std::mutex> lock(mutex);
+        emVoo--;
+        filas[replica].push_front(fragmento);
+        pendentes[replica] += faixas[fragmento].tamanho();
+        mudou.notify_all();
+    }
+};
+
+#endif // DISTRIBUICAO_FRAGMENTOS_H
@@ -0,0 +1,457 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "AfinidadeCpu.h"
+#include "ArenaRequisicao.h"
+#include "ExecucaoServidor.h"
+#include "Rastreamento.h"
+#include "Registro.h"
+
+// Escravo3: frequência de palavras e n-gramas (POST /palavras, porta 8083)
+
+// Tabela de normalização: letras ASCII viram minúsculas, dígitos e bytes UTF-8
+// (>= 0x80) são mantidos, todo o resto é separador (0)
+constexpr std::array<char, 256> gerarTabelaNormalizacao() {
+    std::array<char, 256> tabela{};
+    for (int c = 0; c < 256; ++c) {
+        if (c >= 'A' && c <= 'Z') {
+            tabela[c] = static_cast<char>(c - 'A' + 'a');
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+            tabela[c] = static_cast<char>(c);
+        }
+    }
+    return tabela;
+}
+
+constexpr std::array<char, 256> tabelaNormalizacao = gerarTabelaNormalizacao();
+
+inline uint64_t hashTermo(const char* dados, size_t tamanho) {
+    // FNV-1a 64 bits seguido de uma mistura final para espalhar os bits altos
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < tamanho; ++i) {
+        h ^= static_cast<unsigned char>(dados[i]);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Mapa de contagem com endereçamento aberto (sondagem linear). As chaves são
+// fatias do texto normalizado, que vive enquanto a requisição é processada.
+class MapaContagem {
+public:
+    struct Entrada {
+        uint64_t hash = 0;
+        const char* termo = nullptr;
+        uint32_t tamanho = 0;
+        uint32_t n = 0;
+        uint64_t quantidade = 0;
+    };
+
+private:
+    std::vector<Entrada> entradas;
+    size_t ocupadas = 0;
+    size_t mascara = 0;
+
+    void crescer() {
+        std::vector<Entrada> antigas;
+        antigas.swap(entradas);
+        entradas.resize(antigas.size() * 2);
+        mascara = entradas.size() - 1;
+        for (const auto& e : antigas) {
+            if (e.quantidade == 0) continue;
+            size_t i = e.hash & mascara;
+            while (entradas[i].quantidade != 0) i = (i + 1) & mascara;
+            entradas[i] = e;
+        }
+    }
+
+public:
+    explicit MapaContagem(size_t capacidadeInicial = 1024) {
+        size_t capacidade = 16;
+        while (capacidade < capacidadeInicial) capacidade *= 2;
+        entradas.resize(capacidade);
+        mascara = capacidade - 1;
+    }
+
+    void adicionar(uint64_t hash, const char* termo, uint32_t tamanho, uint32_t n, uint64_t quantidade = 1) {
+        if ((ocupadas + 1) * 10 > entradas.size() * 7) {
+            crescer();
+        }
+        size_t i = hash & mascara;
+        while (true) {
+            Entrada& e = entradas[i];
+            if (e.quantidade == 0) {
+                e.hash = hash;
+                e.termo = termo;
+                e.tamanho = tamanho;
+                e.n = n;
+                e.quantidade = quantidade;
+                ++ocupadas;
+                return;
+            }
+            if (e.hash == hash && e.n == n && e.tamanho == tamanho &&
+                std::memcmp(e.termo, termo, tamanho) == 0) {
+                e.quantidade += quantidade;
+                return;
+            }
+            i = (i + 1) & mascara;
+        }
+    }
+
+    const std::vector<Entrada>& todas() const { return entradas; }
+    size_t tamanho() const { return ocupadas; }
+};
+
+class Escravo3 {
+private:
+    httplib::Server servidor;
+    std::atomic<int> emAndamento{0};
+    std::atomic<uint64_t> requisicoes{0};
+    RegistroMestre registro;
+    static constexpr size_t particoes = 64;
+    static constexpr size_t bytesMinimosPorThread = 1 << 20;
+    static constexpr size_t bytesPorTokenEstimado = 6; // palavra média + separador
+
+    // Capacidade inicial de cada um de 'mapas' mapas que dividem 'bytes' de texto: no máximo um
+    // termo por token e por n, com folga para a carga de 70%; o mapa cresce se faltar
+    static size_t capacidadeMapa(size_t bytes, uint32_t nMaximo, size_t mapas) {
+        size_t termos = bytes / bytesPorTokenEstimado * nMaximo / mapas;
+        return std::clamp<size_t>(termos * 10 / 7 + 1, 16, 1024);
+    }
+
+public:
+    Escravo3() : registro("palavras", 8083, [this]() { return carga(); }) {
+        configurarRotas();
+    }
+
+    // Carga informada ao Mestre nos heartbeats
+    Json::Value carga() const {
+        Json::Value c;
+        c["em_andamento"] = emAndamento.load();
+        c["requisicoes"] = Json::Value::UInt64(requisicoes.load());
+        return c;
+    }
+
+    void configurarRotas() {
+        // Endpoint para contar palavras e n-gramas
+        servidor.Post("/palavras", [this](const httplib::Request& req, httplib::Response& res) {
+            this->contarPalavras(req, res);
+        });
+
+        // Health check
+        servidor.Get("/health", [](const httplib::Request&, httplib::Response& res) {
+            Json::Value resposta;
+            resposta["status"] = "ok";
+            resposta["servico"] = "escravo3-palavras";
+            resposta["funcionalidade"] = "frequência de palavras e n-gramas";
+            resposta["afinidade"] = AfinidadeCpu::instancia().estado();
+
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+        });
+    }
+
+    // Minúsculas e separadores colapsados em um único espaço, sem espaço nas pontas
+    static std::string normalizar(const char* texto, size_t tamanho) {
+        std::string normalizado;
+        normalizado.reserve(tamanho);
+        bool separador = true;
+        for (size_t i = 0; i < tamanho; ++i) {
+            char n = tabelaNormalizacao[static_cast<unsigned char>(texto[i])];
+            if (n != 0) {
+                normalizado.push_back(n);
+                separador = false;
+            } else if (!separador) {
+                normalizado.push_back(' ');
+                separador = true;
+            }
+        }
+        if (!normalizado.empty() && normalizado.back() == ' ') {
+            normalizado.pop_back();
+        }
+        return normalizado;
+    }
+
+    // Conta os n-gramas (1..nMaximo) cujo primeiro token começa em [inicio, fim).
+    // Um n-grama é a fatia contígua do texto normalizado que cobre seus n tokens.
+    static void contarIntervalo(const std::string& texto, size_t inicio, size_t fim, uint32_t nMaximo,
+                                std::vector<MapaContagem>& mapas) {
+        std::vector<size_t> inicios;
+        inicios.reserve(nMaximo);
+
+        size_t pos = inicio;
+        while (pos < texto.size()) {
+            size_t fimToken = texto.find(' ', pos);
+            if (fimToken == std::string::npos) fimToken = texto.size();
+
+            if (inicios.size() == nMaximo) inicios.erase(inicios.begin());
+            inicios.push_back(pos);
+
+            // n-gramas que terminam neste token
+            for (uint32_t n = 1; n <= inicios.size(); ++n) {
+                size_t primeiro = inicios[inicios.size() - n];
+                if (primeiro >= fim) continue;
+                const char* termo = texto.data() + primeiro;
+                uint32_t tamanho = static_cast<uint32_t>(fimToken - primeiro);
+                uint64_t hash = hashTermo(termo, tamanho) ^ n;
+                mapas[(hash >> 32) % mapas.size()].adicionar(hash, termo, tamanho, n);
+            }
+
+            // Depois do fim só interessam tokens que completam n-gramas iniciados antes dele
+            if (inicios.front() >= fim) break;
+            pos = fimToken + 1;
+        }
+    }
+
+    static bool maisFrequente(const MapaContagem::Entrada* a, const MapaContagem::Entrada* b) {
+        if (a->quantidade != b->quantidade) return a->quantidade > b->quantidade;
+        return std::string_view(a->termo, a->tamanho) < std::string_view(b->termo, b->tamanho);
+    }
+
+    static Json::Value topK(std::vector<const MapaContagem::Entrada*>& candidatos, size_t k) {
+        k = std::min(k, candidatos.size());
+        std::partial_sort(candidatos.begin(), candidatos.begin() + k, candidatos.end(), maisFrequente);
+
+        Json::Value lista(Json::arrayValue);
+        for (size_t i = 0; i < k; ++i) {
+            Json::Value item;
+            item["termo"] = std::string(candidatos[i]->termo, candidatos[i]->tamanho);
+            item["quantidade"] = Json::Value::UInt64(candidatos[i]->quantidade);
+            lista.append(item);
+        }
+        return lista;
+    }
+
+    // Texto que cabe em uma thread: um mapa só, contado na thread da requisição, sem partições,
+    // threads auxiliares nem mescla
+    static Json::Value analisarTextoPequeno(const std::string& normalizado, uint32_t nMaximo, size_t top) {
+        std::vector<MapaContagem> mapa;
+        mapa.emplace_back(capacidadeMapa(normalizado.size(), nMaximo, 1));
+        contarIntervalo(normalizado, 0, normalizado.size(), nMaximo, mapa);
+
+        std::vector<std::vector<const MapaContagem::Entrada*>> porN(nMaximo);
+        uint64_t total = 0;
+        for (const auto& e : mapa[0].todas()) {
+            if (e.quantidade == 0) continue;
+            porN[e.n - 1].push_back(&e);
+            if (e.n == 1) total += e.quantidade;
+        }
+        Json::Value ngramas;
+        for (uint32_t n = 1; n <= nMaximo; ++n) {
+            ngramas[std::to_string(n)] = topK(porN[n - 1], top);
+        }
+
+        Json::Value resultado;
+        resultado["ngramas"] = ngramas;
+        resultado["total_palavras"] = Json::Value::UInt64(total);
+        resultado["threads"] = 1;
+        return resultado;
+    }
+
+    Json::Value analisarTexto(const char* texto, size_t tamanho, uint32_t nMaximo, size_t top) {
+        std::string normalizado = normalizar(texto, tamanho);
+
+        // As threads de contagem ficam no nó NUMA da thread que recebeu o texto
+        int no = AfinidadeCpu::instancia().noAtual();
+        size_t numThreads = std::max<size_t>(1, std::min<size_t>(
+            AfinidadeCpu::instancia().cpusDisponiveis(no),
+            normalizado.size() / bytesMinimosPorThread));
+
+        if (numThreads == 1) {
+            return analisarTextoPequeno(normalizado, nMaximo, top);
+        }
+
+        // Fase 1 (map): cada thread conta seu intervalo em mapas próprios, já particionados por hash
+        MapaContagem vazioPorThread(capacidadeMapa(normalizado.size() / numThreads, nMaximo, particoes));
+        std::vector<std::vector<MapaContagem>> mapasPorThread(numThreads,
+                                                              std::vector<MapaContagem>(particoes, vazioPorThread));
+        std::vector<std::thread> threads;
+        size_t inicio = 0;
+        for (size_t t = 0; t < numThreads; ++t) {
+            size_t fim = (t + 1 == numThreads) ? normalizado.size()
+                                               : normalizado.size() * (t + 1) / numThreads;
+            // Ajusta o fim para o início do próximo token
+            fim = std::max(fim, inicio);
+            while (fim < normalizado.size() && fim > 0 && normalizado[fim - 1] != ' ') ++fim;
+            threads.emplace_back([&normalizado, inicio, fim, nMaximo, &mapas = mapasPorThread[t], no]() {
+                AfinidadeCpu::instancia().fixarThreadAtual("contagem", no);
+                contarIntervalo(normalizado, inicio, fim, nMaximo, mapas);
+            });
+            inicio = fim;
+        }
+        for (auto& t : threads) t.join();
+        threads.clear();
+
+        // Fase 2 (reduce): cada partição é mesclada de forma independente e produz seu top-K local
+        std::vector<std::vector<std::vector<const MapaContagem::Entrada*>>> candidatosPorParticao(
+            particoes, std::vector<std::vector<const MapaContagem::Entrada*>>(nMaximo));
+        std::vector<MapaContagem> mesclados(particoes,
+                                            MapaContagem(capacidadeMapa(normalizado.size(), nMaximo, particoes)));
+        std::vector<uint64_t> totalPalavras(particoes, 0);
+
+        auto mesclar = [&](size_t primeira, size_t ultima) {
+            for (size_t p = primeira; p < ultima; ++p) {
+                for (size_t t = 0; t < numThreads; ++t) {
+                    for (const auto& e : mapasPorThread[t][p].todas()) {
+                        if (e.quantidade != 0) mesclados[p].adicionar(e.hash, e.termo, e.tamanho, e.n, e.quantidade);
+                    }
+                }
+                std::vector<std::vector<const MapaContagem::Entrada*>> porN(nMaximo);
+                for (const auto& e : mesclados[p].todas()) {
+                    if (e.quantidade == 0) continue;
+                    porN[e.n - 1].push_back(&e);
+                    if (e.n == 1) totalPalavras[p] += e.quantidade;
+                }
+                for (uint32_t n = 0; n < nMaximo; ++n) {
+                    size_t k = std::min(top, porN[n].size());
+                    std::partial_sort(porN[n].begin(), porN[n].begin() + k, porN[n].end(), maisFrequente);
+                    porN[n].resize(k);
+                }
+                candidatosPorParticao[p] = std::move(porN);
+            }
+        };
+
+        for (size_t t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&mesclar, primeira = particoes * t / numThreads,
+                                  ultima = particoes * (t + 1) / numThreads, no]() {
+                AfinidadeCpu::instancia().fixarThreadAtual("mescla", no);
+                mesclar(primeira, ultima);
+            });
+        }
+        for (auto& t : threads) t.join();
+
+        // Top-K global a partir dos top-K locais (as partições têm chaves disjuntas)
+        Json::Value ngramas;
+        uint64_t total = 0;
+        for (uint32_t n = 1; n <= nMaximo; ++n) {
+            std::vector<const MapaContagem::Entrada*> candidatos;
+            for (size_t p = 0; p < particoes; ++p) {
+                const auto& locais = candidatosPorParticao[p][n - 1];
+                candidatos.insert(candidatos.end(), locais.begin(), locais.end());
+            }
+            ngramas[std::to_string(n)] = topK(candidatos, top);
+        }
+        for (uint64_t t : totalPalavras) total += t;
+
+        Json::Value resultado;
+        resultado["ngramas"] = ngramas;
+        resultado["total_palavras"] = Json::Value::UInt64(total);
+        resultado["threads"] = Json::Value::UInt64(numThreads);
+        return resultado;
+    }
+
+    void contarPalavras(const httplib::Request& req, httplib::Response& res) {
+        emAndamento++;
+        requisicoes++;
+        struct Pendente {
+            std::atomic<int>& contador;
+            ~Pendente() { contador--; }
+        } pendente{emAndamento};
+
+        // Id e amostragem vêm do Mestre; os tempos voltam em "timings" quando há id
+        Rastro rastro(idRequisicaoRecebido(req.get_header_value(cabecalhoRequestId)),
+                      "escravo3-palavras", req.get_header_value(cabecalhoAmostrado) == "1");
+
+        try {
+            // Parse do JSON; o texto é lido direto do Json::Value, sem cópia
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+
+            const char* texto = "";
+            const char* fimTexto = texto;
+            if (requestJson["texto"].isString()) {
+                requestJson["texto"].getString(&texto, &fimTexto);
+            }
+            Json::Value valorN = requestJson.get("n", 2);
+            Json::Value valorTop = requestJson.get("top", 10);
+            if (!valorN.isUInt() || valorN.asUInt() < 1 || valorN.asUInt() > 5) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"n deve estar entre 1 e 5\"}", "application/json");
+                return;
+            }
+            if (!valorTop.isUInt()) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"top deve ser um inteiro não negativo\"}", "application/json");
+                return;
+            }
+            uint32_t nMaximo = valorN.asUInt();
+            size_t top = valorTop.asUInt();
+            medicaoParse.encerrar();
+
+            std::cout << "Escravo3: Contando palavras e n-gramas (n <= " << nMaximo << ") em texto de "
+                     << fimTexto - texto << " caracteres..." << std::endl;
+
+            // Constrói resposta
+            auto medicaoContagem = rastro.medir("contagem");
+            Json::Value resposta = analisarTexto(texto, fimTexto - texto, nMaximo, top);
+            medicaoContagem.encerrar();
+            resposta["tipo"] = "palavras";
+            resposta["processado_por"] = "escravo3";
+            resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+            if (req.has_header(cabecalhoRequestId)) {
+                resposta["timings"] = rastro.timings();
+            }
+
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+
+            std::cout << "Escravo3: Encontradas " << resposta["total_palavras"].asUInt64()
+                     << " palavras" << std::endl;
+
+        } catch (const std::exception& e) {
+            std::cerr << "Escravo3 - Erro: " << e.what() << std::endl;
+
+            Json::Value erro;
+            erro["erro"] = e.what();
+            erro["servico"] = "escravo3";
+
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+
+    int iniciar(int porta = 8083) {
+        std::cout << "Escravo3 (Frequência de Palavras) iniciando na porta " << porta << std::endl;
+        ExecucaoServidor execucao(servidor, "Escravo3", porta,
+                                  [this]() { registro.iniciar(); },
+                                  [this]() { registro.parar(); });
+        return execucao.executar();
+    }
+
+    void parar() {
+        registro.parar();
+        servidor.stop();
+    }
+};
+
+int main() {
+    try {
+        Escravo3 escravo;
+
+        // SIGINT/SIGTERM são tratados por ExecucaoServidor (encerramento com drenagem)
+        return escravo.iniciar(8083);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Erro fatal no Escravo3: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,5 @@
+// Contador de espaços em branco (POST /espacos, porta 8086)
+#include "AnalisadorServico.h"
+#include "ContagemAlocacoes.h"
+
+int main() { return executarAnalisador<PoliticaEspacos>(); }
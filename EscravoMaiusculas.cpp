@@ -0,0 +1,5 @@
+// Contador de letras maiúsculas (POST /maiusculas, porta 8085)
+#include "AnalisadorServico.h"
+#include "ContagemAlocacoes.h"
+
+int main() { return executarAnalisador<PoliticaMaiusculas>(); }
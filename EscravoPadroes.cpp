@@ -0,0 +1,212 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "AfinidadeCpu.h"
+#include "ArenaRequisicao.h"
+#include "BuscaPadroes.h"
+#include "ExecucaoServidor.h"
+#include "Rastreamento.h"
+
+// EscravoPadroes: contagem de vários padrões em uma passada (POST /padroes, porta 8087)
+//
+// Corpo: {"texto": "...", "padroes": ["erro", "falha"], "expressoes": ["[0-9]+ms"], "ignorar_caixa": true}
+// ou, com um conjunto já compilado: {"texto": "...", "conjunto": "<hash devolvido antes>"}
+//
+// Não se registra no Mestre (que não roteia /padroes): é chamado diretamente.
+//
+// Variáveis de ambiente:
+//   PADROES_CACHE_MAX  conjuntos compilados mantidos (padrão: 64)
+
+class EscravoPadroes {
+private:
+    httplib::Server servidor;
+    std::atomic<int> emAndamento{0};
+    std::atomic<uint64_t> requisicoes{0};
+    CacheConjuntos cache;
+
+    static size_t capacidadeCache() {
+        const char* valor = std::getenv("PADROES_CACHE_MAX");
+        return valor ? std::strtoull(valor, nullptr, 10) : 64;
+    }
+
+    static bool lerLista(const Json::Value& valor, std::vector<std::string>& lista) {
+        if (valor.isNull()) {
+            return true;
+        }
+        if (!valor.isArray()) {
+            return false;
+        }
+        for (const auto& item : valor) {
+            if (!item.isString()) {
+                return false;
+            }
+            lista.push_back(item.asString());
+        }
+        return true;
+    }
+
+public:
+    EscravoPadroes() : cache(capacidadeCache()) {
+        configurarRotas();
+    }
+
+    void configurarRotas() {
+        // Endpoint de contagem de padrões
+        servidor.Post("/padroes", [this](const httplib::Request& req, httplib::Response& res) {
+            this->contarPadroes(req, res);
+        });
+
+        // Health check
+        servidor.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+            Json::Value resposta;
+            resposta["status"] = "ok";
+            resposta["servico"] = "escravo-padroes";
+            resposta["funcionalidade"] = "contagem de vários padrões (Aho-Corasick)";
+            resposta["cache"] = cache.estado();
+            resposta["carga"]["em_andamento"] = emAndamento.load();
+            resposta["carga"]["requisicoes"] = Json::Value::UInt64(requisicoes.load());
+            resposta["afinidade"] = AfinidadeCpu::instancia().estado();
+
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+        });
+    }
+
+    void contarPadroes(const httplib::Request& req, httplib::Response& res) {
+        emAndamento++;
+        requisicoes++;
+        struct Pendente {
+            std::atomic<int>& contador;
+            ~Pendente() { contador--; }
+        } pendente{emAndamento};
+
+        // Id e amostragem vêm do Mestre; os tempos voltam em "timings" quando há id
+        Rastro rastro(idRequisicaoRecebido(req.get_header_value(cabecalhoRequestId)),
+                      "escravo-padroes", req.get_header_value(cabecalhoAmostrado) == "1");
+
+        try {
+            // Parse do JSON; o texto é lido direto do Json::Value, sem cópia
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            const char* texto = "";
+            const char* fimTexto = texto;
+            if (requestJson["texto"].isString()) {
+                requestJson["texto"].getString(&texto, &fimTexto);
+            }
+            std::vector<std::string> padroes;
+            std::vector<std::string> expressoes;
+            if (!lerLista(requestJson["padroes"], padroes) || !lerLista(requestJson["expressoes"], expressoes)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"padroes e expressoes devem ser listas de strings\"}", "application/json");
+                return;
+            }
+            bool ignorarCaixa = requestJson.get("ignorar_caixa", false).asBool();
+            medicaoParse.encerrar();
+
+            // Conjunto compilado: do cache (pelo hash informado ou calculado) ou compilado agora
+            auto medicaoCompilacao = rastro.medir("compilacao");
+            std::string chave;
+            std::shared_ptr<const ConjuntoPadroes> conjunto;
+            bool emCache = true;
+            if (padroes.empty() && expressoes.empty()) {
+                chave = requestJson["conjunto"].asString();
+                conjunto = chave.empty() ? nullptr : cache.buscar(chave);
+                if (!conjunto) {
+                    res.status = chave.empty() ? 400 : 404;
+                    res.set_content(chave.empty() ? "{\"erro\": \"informe padroes, expressoes ou conjunto\"}"
+                                                  : "{\"erro\": \"conjunto desconhecido: envie os padrões\"}",
+                                    "application/json");
+                    return;
+                }
+            } else {
+                chave = ConjuntoPadroes::chave(padroes, expressoes, ignorarCaixa);
+                conjunto = cache.buscar(chave);
+                if (!conjunto) {
+                    try {
+                        conjunto = cache.inserir(chave, std::make_shared<const ConjuntoPadroes>(
+                            std::move(padroes), std::move(expressoes), ignorarCaixa));
+                    } catch (const std::invalid_argument& e) {
+                        Json::Value erro;
+                        erro["erro"] = e.what();
+                        res.status = 400;
+                        res.set_content(Json::writeString(escritorJson(), erro), "application/json");
+                        return;
+                    }
+                    emCache = false;
+                }
+            }
+            medicaoCompilacao.encerrar();
+
+            std::cout << "EscravoPadroes: Contando padrões do conjunto " << chave << " em texto de "
+                     << fimTexto - texto << " caracteres..." << std::endl;
+
+            auto medicaoContagem = rastro.medir("contagem");
+            uint64_t total = 0;
+            Json::Value contagens = conjunto->contar(texto, fimTexto - texto, total);
+            medicaoContagem.encerrar();
+
+            Json::Value resposta;
+            resposta["contagens"] = contagens;
+            resposta["total"] = Json::Value::UInt64(total);
+            resposta["conjunto"] = chave;
+            resposta["conjunto_em_cache"] = emCache;
+            resposta["automato"] = conjunto->estado();
+            resposta["tipo"] = "padroes";
+            resposta["processado_por"] = "escravo-padroes";
+            resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+            if (req.has_header(cabecalhoRequestId)) {
+                resposta["timings"] = rastro.timings();
+            }
+
+            res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+
+            std::cout << "EscravoPadroes: Encontradas " << total << " ocorrências" << std::endl;
+
+        } catch (const std::exception& e) {
+            std::cerr << "EscravoPadroes - Erro: " << e.what() << std::endl;
+
+            Json::Value erro;
+            erro["erro"] = e.what();
+            erro["servico"] = "escravo-padroes";
+
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+
+    int iniciar(int porta = 8087) {
+        std::cout << "EscravoPadroes (Contagem de Padrões) iniciando na porta " << porta << std::endl;
+        ExecucaoServidor execucao(servidor, "EscravoPadroes", porta);
+        return execucao.executar();
+    }
+
+    void parar() {
+        servidor.stop();
+    }
+};
+
+int main() {
+    try {
+        EscravoPadroes escravo;
+
+        // SIGINT/SIGTERM são tratados por ExecucaoServidor (encerramento com drenagem)
+        return escravo.iniciar(8087);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Erro fatal no EscravoPadroes: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,468 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "AfinidadeCpu.h"
+#include "ArenaRequisicao.h"
+#include "ClassesCaracteres.h"
+#include "ExecucaoServidor.h"
+#include "Registro.h"
+
+// EscravoSimulado: substituto de Escravo1 e Escravo2 para testes de desempenho (porta 8088)
+//
+// Serve /letras, /numeros e /health com as contagens corretas, mas injeta atrasos e falhas
+// para medir como o Mestre reage (timeouts, novas tentativas, fan-out) em uma só máquina.
+// Aponte o Mestre para ele com ESCRAVOS_LETRAS=localhost:8088 e ESCRAVOS_NUMEROS=localhost:8088,
+// ou, com MESTRE_ENDERECO definido, ele se registra nos dois grupos junto com os escravos reais.
+//
+// Variáveis de ambiente (também alteráveis em execução por POST /simulacao):
+//   SIMULADO_LATENCIA          distribuição do atraso de cada resposta, em ms (padrão: fixa:0)
+//                              fixa:M | uniforme:MIN:MAX | exponencial:MEDIA |
+//                              lognormal:MEDIANA:SIGMA | pareto:MINIMO:ALFA
+//   SIMULADO_ERRO_PROB         probabilidade de responder com erro (padrão: 0)
+//   SIMULADO_ERRO_STATUS       status HTTP do erro (padrão: 500)
+//   SIMULADO_RESET_PROB        probabilidade de enviar o cabeçalho e encerrar a conexão no meio do corpo
+//   SIMULADO_GOTEJAMENTO_PROB  probabilidade de enviar a resposta aos poucos
+//   SIMULADO_GOTEJAMENTO_BYTES_S  vazão do gotejamento (padrão: 64 bytes/s)
+//   SIMULADO_TRAVAMENTO_PROB   probabilidade de segurar a requisição sem responder
+//   SIMULADO_TRAVAMENTO_MS     duração do travamento (padrão: 60000)
+//   SIMULADO_FALHAR_HEALTH     1 para aplicar latência e falhas também ao /health (padrão: 0)
+//   SIMULADO_SEMENTE           semente dos sorteios, para repetir uma execução (padrão: aleatória)
+
+// Atraso sorteado de uma distribuição configurável
+struct DistribuicaoLatencia {
+    std::string tipo = "fixa";
+    double a = 0.0;
+    double b = 0.0;
+
+    static DistribuicaoLatencia ler(const std::string& descricao) {
+        DistribuicaoLatencia d;
+        size_t primeiro = descricao.find(':');
+        d.tipo = descricao.substr(0, primeiro);
+        if (primeiro != std::string::npos) {
+            size_t segundo = descricao.find(':', primeiro + 1);
+            d.a = std::stod(descricao.substr(primeiro + 1, segundo - primeiro - 1));
+            if (segundo != std::string::npos) {
+                d.b = std::stod(descricao.substr(segundo + 1));
+            }
+        }
+        bool valida = (d.tipo == "fixa" && d.a >= 0) || (d.tipo == "uniforme" && d.a >= 0 && d.b >= d.a)
+                   || (d.tipo == "exponencial" && d.a > 0) || (d.tipo == "lognormal" && d.a > 0 && d.b >= 0)
+                   || (d.tipo == "pareto" && d.a > 0 && d.b > 0);
+        if (!valida) {
+            throw std::invalid_argument("distribuição de latência inválida: " + descricao);
+        }
+        return d;
+    }
+
+    double sortearMs(std::mt19937_64& gerador) const {
+        if (tipo == "uniforme") {
+            return std::uniform_real_distribution<double>(a, b)(gerador);
+        }
+        if (tipo == "exponencial") {
+            return std::exponential_distribution<double>(1.0 / a)(gerador);
+        }
+        if (tipo == "lognormal") {
+            return std::lognormal_distribution<double>(std::log(a), b)(gerador);
+        }
+        if (tipo == "pareto") {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(gerador);
+            return a / std::pow(1.0 - u, 1.0 / b);
+        }
+        return a;
+    }
+
+    std::string descricao() const {
+        std::string d = tipo + ":" + std::to_string(a);
+        if (tipo == "uniforme" || tipo == "lognormal" || tipo == "pareto") {
+            d += ":" + std::to_string(b);
+        }
+        return d;
+    }
+};
+
+struct ConfiguracaoFalhas {
+    DistribuicaoLatencia latencia;
+    double probErro = 0.0;
+    int statusErro = 500;
+    double probReset = 0.0;
+    double probGotejamento = 0.0;
+    double gotejamentoBytesS = 64.0;
+    double probTravamento = 0.0;
+    int64_t travamentoMs = 60000;
+    bool falharHealth = false;
+
+    static std::string ambiente(const char* nome, const char* padrao) {
+        const char* valor = std::getenv(nome);
+        return valor ? valor : padrao;
+    }
+
+    static ConfiguracaoFalhas doAmbiente() {
+        ConfiguracaoFalhas c;
+        c.latencia = DistribuicaoLatencia::ler(ambiente("SIMULADO_LATENCIA", "fixa:0"));
+        c.probErro = std::stod(ambiente("SIMULADO_ERRO_PROB", "0"));
+        c.statusErro = std::stoi(ambiente("SIMULADO_ERRO_STATUS", "500"));
+        c.probReset = std::stod(ambiente("SIMULADO_RESET_PROB", "0"));
+        c.probGotejamento = std::stod(ambiente("SIMULADO_GOTEJAMENTO_PROB", "0"));
+        c.gotejamentoBytesS = std::stod(ambiente("SIMULADO_GOTEJAMENTO_BYTES_S", "64"));
+        c.probTravamento = std::stod(ambiente("SIMULADO_TRAVAMENTO_PROB", "0"));
+        c.travamentoMs = std::stoll(ambiente("SIMULADO_TRAVAMENTO_MS", "60000"));
+        c.falharHealth = ambiente("SIMULADO_FALHAR_HEALTH", "0") == "1";
+        c.validar();
+        return c;
+    }
+
+    // Campos presentes no JSON substituem os atuais
+    ConfiguracaoFalhas comAlteracoes(const Json::Value& json) const {
+        ConfiguracaoFalhas c = *this;
+        if (json.isMember("latencia")) c.latencia = DistribuicaoLatencia::ler(json["latencia"].asString());
+        if (json.isMember("erro_prob")) c.probErro = json["erro_prob"].asDouble();
+        if (json.isMember("erro_status")) c.statusErro = json["erro_status"].asInt();
+        if (json.isMember("reset_prob")) c.probReset = json["reset_prob"].asDouble();
+        if (json.isMember("gotejamento_prob")) c.probGotejamento = json["gotejamento_prob"].asDouble();
+        if (json.isMember("gotejamento_bytes_s")) c.gotejamentoBytesS = json["gotejamento_bytes_s"].asDouble();
+        if (json.isMember("travamento_prob")) c.probTravamento = json["travamento_prob"].asDouble();
+        if (json.isMember("travamento_ms")) c.travamentoMs = json["travamento_ms"].asInt64();
+        if (json.isMember("falhar_health")) c.falharHealth = json["falhar_health"].asBool();
+        c.validar();
+        return c;
+    }
+
+    void validar() const {
+        for (double p : {probErro, probReset, probGotejamento, probTravamento}) {
+            if (p < 0.0 || p > 1.0) {
+                throw std::invalid_argument("probabilidades devem estar entre 0 e 1");
+            }
+        }
+        if (statusErro < 400 || statusErro > 599) {
+            throw std::invalid_argument("erro_status deve ser um status HTTP de erro (4xx ou 5xx)");
+        }
+        if (gotejamentoBytesS <= 0.0 || travamentoMs < 0) {
+            throw std::invalid_argument("gotejamento_bytes_s deve ser positivo e travamento_ms não negativo");
+        }
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["latencia"] = latencia.descricao();
+        e["erro_prob"] = probErro;
+        e["erro_status"] = statusErro;
+        e["reset_prob"] = probReset;
+        e["gotejamento_prob"] = probGotejamento;
+        e["gotejamento_bytes_s"] = gotejamentoBytesS;
+        e["travamento_prob"] = probTravamento;
+        e["travamento_ms"] = Json::Value::Int64(travamentoMs);
+        e["falhar_health"] = falharHealth;
+        return e;
+    }
+};
+
+class EscravoSimulado {
+private:
+    enum class Falha { Nenhuma, Erro, Reset, Gotejamento, Travamento };
+
+    httplib::Server servidor;
+    std::atomic<int> emAndamento{0};
+    std::atomic<uint64_t> requisicoes{0};
+    std::atomic<uint64_t> erros{0};
+    std::atomic<uint64_t> resets{0};
+    std::atomic<uint64_t> gotejamentos{0};
+    std::atomic<uint64_t> travamentos{0};
+    std::atomic<uint64_t> latenciaTotalUs{0};
+
+    // Trocada inteira por POST /simulacao; as requisições só carregam o ponteiro atual
+    std::shared_ptr<const ConfiguracaoFalhas> configuracao;
+    uint64_t semente;
+    std::atomic<uint64_t> proximaThread{0};
+
+    // Esperas (latência, gotejamento, travamento) são interrompidas no encerramento
+    std::mutex mutexEspera;
+    std::condition_variable cvEspera;
+    bool encerrando = false;
+
+    RegistroMestre registroLetras;
+    RegistroMestre registroNumeros;
+
+    std::mt19937_64& gerador() {
+        thread_local std::mt19937_64 g(semente + 0x9E3779B97F4A7C15ULL * proximaThread.fetch_add(1));
+        return g;
+    }
+
+    bool sortear(double probabilidade) {
+        return probabilidade > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(gerador()) < probabilidade;
+    }
+
+    // false se o serviço está encerrando
+    bool esperar(double ms) {
+        if (ms <= 0.0) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutexEspera);
+        return !cvEspera.wait_for(lock, std::chrono::duration<double, std::milli>(ms), [this]() { return encerrando; });
+    }
+
+    std::shared_ptr<const ConfiguracaoFalhas> configuracaoAtual() const {
+        return std::atomic_load(&configuracao);
+    }
+
+    Falha sortearFalha(const ConfiguracaoFalhas& c) {
+        if (sortear(c.probTravamento)) return Falha::Travamento;
+        if (sortear(c.probReset)) return Falha::Reset;
+        if (sortear(c.probErro)) return Falha::Erro;
+        if (sortear(c.probGotejamento)) return Falha::Gotejamento;
+        return Falha::Nenhuma;
+    }
+
+    // Aplica latência e a falha sorteada; true se a resposta já foi definida (ou abandonada)
+    bool injetar(const ConfiguracaoFalhas& c, httplib::Response& res, Falha& falha) {
+        double atrasoMs = c.latencia.sortearMs(gerador());
+        latenciaTotalUs.fetch_add(static_cast<uint64_t>(atrasoMs * 1000.0), std::memory_order_relaxed);
+        falha = sortearFalha(c);
+        if (falha == Falha::Travamento) {
+            travamentos++;
+            atrasoMs += c.travamentoMs;
+        }
+        if (!esperar(atrasoMs)) {
+            res.status = 503;
+            res.set_content("{\"erro\": \"serviço encerrando\"}", "application/json");
+            return true;
+        }
+        if (falha == Falha::Reset) {
+            // Cabeçalho com o tamanho prometido, depois a conexão cai sem nenhum byte do corpo
+            resets++;
+            res.set_content_provider(64, "application/json",
+                                     [](size_t, size_t, httplib::DataSink&) { return false; });
+            return true;
+        }
+        if (falha == Falha::Erro) {
+            erros++;
+            res.status = c.statusErro;
+            res.set_content("{\"erro\": \"falha injetada\", \"servico\": \"escravo-simulado\"}", "application/json");
+            return true;
+        }
+        return false;
+    }
+
+    // Resposta entregue em pedaços pequenos, no ritmo de gotejamentoBytesS
+    void gotejar(const ConfiguracaoFalhas& c, httplib::Response& res, std::string corpo) {
+        gotejamentos++;
+        size_t porPasso = std::max<size_t>(1, static_cast<size_t>(c.gotejamentoBytesS / 10.0));
+        double passoMs = 1000.0 * porPasso / c.gotejamentoBytesS;
+        auto conteudo = std::make_shared<std::string>(std::move(corpo));
+        res.set_content_provider(conteudo->size(), "application/json",
+            [this, conteudo, porPasso, passoMs](size_t offset, size_t tamanho, httplib::DataSink& sink) {
+                if (!esperar(passoMs)) {
+                    return false;
+                }
+                size_t n = std::min(porPasso, tamanho);
+                return sink.write(conteudo->data() + offset, n);
+            });
+    }
+
+    template <typename Politica>
+    void contar(const httplib::Request& req, httplib::Response& res) {
+        emAndamento++;
+        requisicoes++;
+        struct Pendente {
+            std::atomic<int>& contador;
+            ~Pendente() { contador--; }
+        } pendente{emAndamento};
+
+        auto c = configuracaoAtual();
+        try {
+            Falha falha;
+            if (injetar(*c, res, falha)) {
+                return;
+            }
+
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+
+            // Mesmo formato de resposta dos escravos reais, inclusive o lote de fragmentos
+            Json::Value resposta;
+            const Json::Value& fragmentos = requestJson["fragmentos"];
+            uint64_t quantidade = 0;
+            if (fragmentos.isArray()) {
+                resposta["quantidades"] = Json::Value(Json::arrayValue);
+                for (const auto& fragmento : fragmentos) {
+                    uint64_t q = fragmento.isString() ? contarClasse<Politica>(fragmento.asString()) : 0;
+                    resposta["quantidades"].append(Json::Value::UInt64(q));
+                    quantidade += q;
+                }
+            } else if (requestJson["texto"].isString()) {
+                const char* texto = nullptr;
+                const char* fim = nullptr;
+                requestJson["texto"].getString(&texto, &fim);
+                quantidade = contarClasse<Politica>(texto, fim - texto);
+            }
+            resposta["quantidade"] = Json::Value::UInt64(quantidade);
+            resposta["tipo"] = Politica::tipo;
+            resposta["processado_por"] = "escravo-simulado";
+            resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+
+            std::string corpo = Json::writeString(escritorJson(), resposta);
+            if (falha == Falha::Gotejamento) {
+                gotejar(*c, res, std::move(corpo));
+            } else {
+                res.set_content(corpo, "application/json");
+            }
+
+        } catch (const std::exception& e) {
+            std::cerr << "EscravoSimulado - Erro: " << e.what() << std::endl;
+
+            Json::Value erro;
+            erro["erro"] = e.what();
+            erro["servico"] = "escravo-simulado";
+
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+
+    Json::Value estadoSimulacao() const {
+        uint64_t total = requisicoes.load();
+        Json::Value e;
+        e["configuracao"] = configuracaoAtual()->estado();
+        e["semente"] = Json::Value::UInt64(semente);
+        e["requisicoes"] = Json::Value::UInt64(total);
+        e["erros"] = Json::Value::UInt64(erros.load());
+        e["resets"] = Json::Value::UInt64(resets.load());
+        e["gotejamentos"] = Json::Value::UInt64(gotejamentos.load());
+        e["travamentos"] = Json::Value::UInt64(travamentos.load());
+        e["latencia_media_ms"] = total > 0 ? latenciaTotalUs.load() / 1000.0 / total : 0.0;
+        return e;
+    }
+
+    static uint64_t sementeInicial() {
+        const char* valor = std::getenv("SIMULADO_SEMENTE");
+        return valor ? std::strtoull(valor, nullptr, 10) : std::random_device{}();
+    }
+
+public:
+    EscravoSimulado()
+        : configuracao(std::make_shared<const ConfiguracaoFalhas>(ConfiguracaoFalhas::doAmbiente())),
+          semente(sementeInicial()),
+          registroLetras("letras", 8088, [this]() { return carga(); }),
+          registroNumeros("numeros", 8088, [this]() { return carga(); }) {
+        configurarRotas();
+    }
+
+    // Carga informada ao Mestre nos heartbeats
+    Json::Value carga() const {
+        Json::Value c;
+        c["em_andamento"] = emAndamento.load();
+        c["requisicoes"] = Json::Value::UInt64(requisicoes.load());
+        return c;
+    }
+
+    void configurarRotas() {
+        servidor.Post(PoliticaLetras::rota, [this](const httplib::Request& req, httplib::Response& res) {
+            this->contar<PoliticaLetras>(req, res);
+        });
+        servidor.Post(PoliticaNumeros::rota, [this](const httplib::Request& req, httplib::Response& res) {
+            this->contar<PoliticaNumeros>(req, res);
+        });
+
+        // Configuração das falhas em execução: GET consulta, POST altera (só os campos enviados)
+        servidor.Get("/simulacao", [this](const httplib::Request&, httplib::Response& res) {
+            res.set_content(Json::writeString(escritorJson(), estadoSimulacao()), "application/json");
+        });
+        servidor.Post("/simulacao", [this](const httplib::Request& req, httplib::Response& res) {
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson) || !requestJson.isObject()) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            try {
+                auto nova = std::make_shared<const ConfiguracaoFalhas>(configuracaoAtual()->comAlteracoes(requestJson));
+                std::atomic_store(&configuracao, nova);
+                std::cout << "EscravoSimulado: configuração alterada: "
+                         << Json::writeString(escritorJson(), nova->estado()) << std::endl;
+            } catch (const std::exception& e) {
+                Json::Value erro;
+                erro["erro"] = e.what();
+                res.status = 400;
+                res.set_content(Json::writeString(escritorJson(), erro), "application/json");
+                return;
+            }
+            res.set_content(Json::writeString(escritorJson(), estadoSimulacao()), "application/json");
+        });
+
+        // Health check; com falhar_health recebe a mesma latência e falhas das contagens
+        servidor.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+            auto c = configuracaoAtual();
+            Falha falha;
+            if (c->falharHealth && injetar(*c, res, falha)) {
+                return;
+            }
+            Json::Value resposta;
+            resposta["status"] = "ok";
+            resposta["servico"] = "escravo-simulado";
+            resposta["funcionalidade"] = "contador de letras e números com falhas injetadas";
+            resposta["simulacao"] = estadoSimulacao();
+            resposta["afinidade"] = AfinidadeCpu::instancia().estado();
+
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+        });
+    }
+
+    void interromperEsperas() {
+        {
+            std::lock_guard<std::mutex> lock(mutexEspera);
+            encerrando = true;
+        }
+        cvEspera.notify_all();
+    }
+
+    int iniciar(int porta = 8088) {
+        std::cout << "EscravoSimulado (falhas injetadas) iniciando na porta " << porta << ": "
+                 << Json::writeString(escritorJson(), configuracaoAtual()->estado()) << std::endl;
+        // Travamentos e gotejamentos em andamento não seguram a drenagem
+        ExecucaoServidor execucao(servidor, "EscravoSimulado", porta,
+                                  [this]() { registroLetras.iniciar(); registroNumeros.iniciar(); },
+                                  [this]() { registroLetras.parar(); registroNumeros.parar(); interromperEsperas(); });
+        return execucao.executar();
+    }
+
+    void parar() {
+        registroLetras.parar();
+        registroNumeros.parar();
+        interromperEsperas();
+        servidor.stop();
+    }
+};
+
+int main() {
+    try {
+        EscravoSimulado escravo;
+
+        // SIGINT/SIGTERM são tratados por ExecucaoServidor (encerramento com drenagem)
+        return escravo.iniciar(8088);
+
+    } catch (const std::exception& e) {
+        std::cerr << "Erro fatal no EscravoSimulado: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,5 @@
+// Contador de vogais (POST /vogais, porta 8084)
+#include "AnalisadorServico.h"
+#include "ContagemAlocacoes.h"
+
+int main() { return executarAnalisador<PoliticaVogais>(); }
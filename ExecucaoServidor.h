@@ -0,0 +1,288 @@
+#ifndef EXECUCAO_SERVIDOR_H
+#define EXECUCAO_SERVIDOR_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <ctime>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <httplib.h>
+#include "AfinidadeCpu.h"
+
+// Pool de workers do httplib cujas threads se prendem (AfinidadeCpu) antes da primeira requisição
+class FilaTarefasAfinidade : public httplib::TaskQueue {
+private:
+    httplib::ThreadPool pool;
+
+public:
+    explicit FilaTarefasAfinidade(size_t threads) : pool(threads) {}
+
+    bool enqueue(std::function<void()> tarefa) override {
+        return pool.enqueue([tarefa = std::move(tarefa)]() {
+            AfinidadeCpu::instancia().fixarThreadAtual("http");
+            tarefa();
+        });
+    }
+
+    void shutdown() override {
+        pool.shutdown();
+    }
+};
+
+// Execução de um servidor (httplib::Server ou outro que saiba escutar e parar) com encerramento
+// gracioso e, opcionalmente, vários processos na mesma porta via SO_REUSEPORT (o kernel
+// distribui as conexões).
+//
+// Variáveis de ambiente:
+//   PROCESSOS        número de processos servindo a porta (padrão: 1)
+//   DRENAGEM_MAX_MS  tempo máximo para concluir as requisições em andamento (padrão: 30000)
+//   AFINIDADE        CPUs/nós NUMA das threads de cada processo (ver AfinidadeCpu.h)
+//
+// SIGINT/SIGTERM não encerram o processo de imediato: o socket de escuta é fechado
+// (novas conexões vão para os demais processos ou são recusadas) e o processo só sai
+// depois que as requisições em andamento terminam. O processo pai apenas supervisiona:
+// repassa o sinal aos filhos, aguarda a drenagem e recria filhos derrubados por sinal (com
+// atraso crescente se caem logo depois de subir). Filhos que saem com status, como na falha ao
+// escutar a porta, não são recriados; se todos saem assim, o supervisor termina com erro.
+class ExecucaoServidor {
+public:
+    // Operações usadas do servidor: escutar bloqueia até parar ser chamado
+    struct Servidor {
+        std::function<bool(const std::string& host, int porta)> escutar;
+        std::function<void()> parar;
+    };
+
+private:
+    Servidor servidor;
+    std::string nome;
+    int porta;
+    std::function<void()> antesDeServir;
+    std::function<void()> aoEncerrar;
+    int64_t drenagemMaxMs = 30000;
+
+    static sigset_t sinaisControlados() {
+        sigset_t sinais;
+        sigemptyset(&sinais);
+        sigaddset(&sinais, SIGINT);
+        sigaddset(&sinais, SIGTERM);
+        sigaddset(&sinais, SIGCHLD);
+        return sinais;
+    }
+
+    // Serve a porta neste processo até receber SIGINT/SIGTERM e drenar as requisições
+    int servir() {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool encerrado = false;
+
+        // Thread dedicada aos sinais: fora do contexto de signal handler é seguro
+        // parar o servidor e esperar a drenagem
+        std::thread threadSinais([&]() {
+            sigset_t sinais;
+            sigemptyset(&sinais);
+            sigaddset(&sinais, SIGINT);
+            sigaddset(&sinais, SIGTERM);
+            int sinal = 0;
+            sigwait(&sinais, &sinal);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (encerrado) {
+                return;
+            }
+            std::cout << "\nEncerrando " << nome << " (pid " << getpid()
+                     << "): drenando requisições em andamento..." << std::endl;
+            if (aoEncerrar) {
+                aoEncerrar();
+            }
+            servidor.parar();
+
+            if (!cv.wait_for(lock, std::chrono::milliseconds(drenagemMaxMs), [&]() { return encerrado; })) {
+                std::cerr << nome << ": drenagem excedeu " << drenagemMaxMs << " ms, encerrando à força" << std::endl;
+                std::_Exit(1);
+            }
+        });
+
+        if (antesDeServir) {
+            antesDeServir();
+        }
+        AfinidadeCpu::instancia().fixarThreadAtual("aceitacao");
+        bool ok = servidor.escutar("0.0.0.0", porta);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            encerrado = true;
+        }
+        cv.notify_all();
+        if (!ok) {
+            // Falha ao abrir a porta: acorda a thread de sinais para que ela termine
+            pthread_kill(threadSinais.native_handle(), SIGTERM);
+            std::cerr << nome << ": não foi possível escutar na porta " << porta << std::endl;
+        }
+        threadSinais.join();
+
+        std::cout << nome << " (pid " << getpid() << ") encerrado" << std::endl;
+        return ok ? 0 : 1;
+    }
+
+    pid_t criarProcesso(int indice, int processos) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Cada processo fica com seu nó (ou fatia de CPUs), inclusive quando é recriado
+            AfinidadeCpu::instancia().definirProcesso(indice, processos);
+            std::exit(servir());
+        }
+        return pid;
+    }
+
+    // Filho derrubado por sinal volta após um atraso que dobra a cada queda logo depois de subir
+    static constexpr int64_t atrasoRecriacaoInicialMs = 100;
+    static constexpr int64_t atrasoRecriacaoMaximoMs = 30000;
+    static constexpr int64_t vidaEstavelMs = 10000;
+
+    int supervisionar(int processos) {
+        using Relogio = std::chrono::steady_clock;
+        struct Filho {
+            pid_t pid = -1;
+            Relogio::time_point inicio;
+            bool pendente = false; // caiu e aguarda o atraso para ser recriado
+            Relogio::time_point recriarEm;
+            int64_t atrasoMs = 0;
+        };
+        std::vector<Filho> filhos(processos);
+        for (int i = 0; i < processos; ++i) {
+            filhos[i].pid = criarProcesso(i, processos);
+            filhos[i].inicio = Relogio::now();
+        }
+        std::cout << nome << ": " << processos << " processos na porta " << porta
+                 << " (SO_REUSEPORT)" << std::endl;
+
+        sigset_t sinais = sinaisControlados();
+        bool encerrando = false;
+        int codigo = 0;
+        auto ativos = [&]() {
+            return std::any_of(filhos.begin(), filhos.end(), [](const Filho& f) { return f.pid > 0 || f.pendente; });
+        };
+        while (ativos()) {
+            // A recriação pendente mais próxima limita a espera pelos sinais
+            bool comPrazo = false;
+            Relogio::time_point prazo;
+            for (const auto& f : filhos) {
+                if (f.pendente && (!comPrazo || f.recriarEm < prazo)) {
+                    prazo = f.recriarEm;
+                    comPrazo = true;
+                }
+            }
+            int sinal = 0;
+            if (comPrazo) {
+                auto restante = std::chrono::duration_cast<std::chrono::nanoseconds>(prazo - Relogio::now());
+                int64_t ns = std::max<int64_t>(0, restante.count());
+                timespec espera{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+                sinal = sigtimedwait(&sinais, nullptr, &espera);
+            } else {
+                sigwait(&sinais, &sinal);
+            }
+
+            if (sinal < 0) {
+                // Prazo atingido: recria quem já esperou o atraso
+                auto agora = Relogio::now();
+                for (size_t i = 0; i < filhos.size(); ++i) {
+                    Filho& f = filhos[i];
+                    if (f.pendente && f.recriarEm <= agora) {
+                        f.pendente = false;
+                        f.pid = criarProcesso(static_cast<int>(i), processos);
+                        f.inicio = agora;
+                    }
+                }
+            } else if (sinal == SIGCHLD) {
+                int status = 0;
+                pid_t pid;
+                while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                    for (auto& f : filhos) {
+                        if (f.pid != pid) continue;
+                        f.pid = -1;
+                        if (encerrando) continue;
+                        if (WIFEXITED(status)) {
+                            // Saída com status: o filho desistiu (ex.: porta ocupada); recriar só repetiria
+                            std::cerr << nome << ": processo " << pid << " saiu com status "
+                                      << WEXITSTATUS(status) << ", não será recriado" << std::endl;
+                            if (WEXITSTATUS(status) != 0) codigo = 1;
+                            continue;
+                        }
+                        auto agora = Relogio::now();
+                        int64_t viveuMs = std::chrono::duration_cast<std::chrono::milliseconds>(agora - f.inicio).count();
+                        f.atrasoMs = viveuMs >= vidaEstavelMs
+                                         ? 0
+                                         : std::min(atrasoRecriacaoMaximoMs,
+                                                    std::max(atrasoRecriacaoInicialMs, f.atrasoMs * 2));
+                        std::cerr << nome << ": processo " << pid << " caiu (sinal " << WTERMSIG(status)
+                                  << "), recriando em " << f.atrasoMs << " ms" << std::endl;
+                        f.pendente = true;
+                        f.recriarEm = agora + std::chrono::milliseconds(f.atrasoMs);
+                    }
+                }
+            } else if (!encerrando) {
+                encerrando = true;
+                for (auto& f : filhos) {
+                    f.pendente = false;
+                    if (f.pid > 0) kill(f.pid, SIGTERM);
+                }
+            }
+        }
+        return codigo;
+    }
+
+public:
+    ExecucaoServidor(Servidor s, std::string nomeServico, int portaServico,
+                     std::function<void()> antes = nullptr, std::function<void()> encerrar = nullptr)
+        : servidor(std::move(s)), nome(std::move(nomeServico)), porta(portaServico),
+          antesDeServir(std::move(antes)), aoEncerrar(std::move(encerrar)) {}
+
+    ExecucaoServidor(httplib::Server& s, std::string nomeServico, int portaServico,
+                     std::function<void()> antes = nullptr, std::function<void()> encerrar = nullptr)
+        : ExecucaoServidor(Servidor{
+              [&s](const std::string& host, int p) {
+                  s.new_task_queue = [] { return new FilaTarefasAfinidade(CPPHTTPLIB_THREAD_POOL_COUNT); };
+                  s.set_socket_options([](httplib::socket_t sock) {
+                      int sim = 1;
+                      setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &sim, sizeof(sim));
+                      setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &sim, sizeof(sim));
+                  });
+                  return s.listen(host, p);
+              },
+              [&s]() { s.stop(); }},
+              std::move(nomeServico), portaServico, std::move(antes), std::move(encerrar)) {}
+
+    // Deve ser chamado antes de qualquer thread ser criada (o fork só copia a thread atual)
+    int executar() {
+        if (const char* valor = std::getenv("DRENAGEM_MAX_MS")) {
+            drenagemMaxMs = std::stoll(valor);
+        }
+        int processos = 1;
+        if (const char* valor = std::getenv("PROCESSOS")) {
+            processos = std::max(1, std::atoi(valor));
+        }
+
+        // Sinais bloqueados em todas as threads; são consumidos com sigwait
+        sigset_t sinais = sinaisControlados();
+        pthread_sigmask(SIG_BLOCK, &sinais, nullptr);
+
+        if (processos == 1) {
+            return servir();
+        }
+        return supervisionar(processos);
+    }
+};
+
+#endif // EXECUCAO_SERVIDOR_H
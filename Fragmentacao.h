@@ -0,0 +1,107 @@
+#ifndef FRAGMENTACAO_H
+#define FRAGMENTACAO_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Fragmentação definida pelo conteúdo (content-defined chunking), compartilhada entre
+// cliente e Mestre. As fronteiras são escolhidas por um hash rolante (Gear) sobre os bytes,
+// então uma edição pequena só altera os fragmentos ao redor dela: os demais mantêm o mesmo
+// hash e suas contagens podem ser reaproveitadas do cache do Mestre.
+
+constexpr size_t fragmentoMinimo = 16 * 1024;
+constexpr size_t fragmentoMaximo = 256 * 1024;
+constexpr uint64_t mascaraFronteira = (1ULL << 16) - 1; // tamanho médio ~64 KB acima do mínimo
+
+// Tabela do hash Gear gerada em tempo de compilação (splitmix64)
+constexpr std::array<uint64_t, 256> gerarTabelaGear() {
+    std::array<uint64_t, 256> tabela{};
+    uint64_t estado = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < 256; ++i) {
+        estado += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = estado;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        tabela[i] = z ^ (z >> 31);
+    }
+    return tabela;
+}
+
+constexpr std::array<uint64_t, 256> tabelaGear = gerarTabelaGear();
+
+inline uint64_t misturar64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Hash de conteúdo de 128 bits (duas vias de 64 bits com sementes diferentes), em hexadecimal
+inline std::string hashConteudo(const char* dados, size_t tamanho) {
+    uint64_t a = 0x243f6a8885a308d3ULL ^ tamanho;
+    uint64_t b = 0x13198a2e03707344ULL ^ (tamanho * 0x9e3779b97f4a7c15ULL);
+    size_t i = 0;
+    for (; i + 8 <= tamanho; i += 8) {
+        uint64_t palavra;
+        std::memcpy(&palavra, dados + i, 8);
+        a = misturar64(a ^ palavra) + 0x9e3779b97f4a7c15ULL;
+        b = misturar64(b + palavra) ^ 0xa4093822299f31d0ULL;
+    }
+    uint64_t resto = 0;
+    std::memcpy(&resto, dados + i, tamanho - i);
+    a = misturar64(a ^ resto);
+    b = misturar64(b + resto + a);
+
+    char hex[33];
+    std::snprintf(hex, sizeof(hex), "%016llx%016llx",
+                  static_cast<unsigned long long>(a), static_cast<unsigned long long>(b));
+    return hex;
+}
+
+inline std::string hashConteudo(const std::string& texto) {
+    return hashConteudo(texto.data(), texto.size());
+}
+
+struct Fragmento {
+    size_t inicio;
+    size_t tamanho;
+    std::string hash;
+};
+
+// Posição do fim do fragmento que começa em 'inicio'
+inline size_t proximaFronteira(const char* dados, size_t tamanho, size_t inicio) {
+    size_t restante = tamanho - inicio;
+    if (restante <= fragmentoMinimo) {
+        return tamanho;
+    }
+    size_t limite = inicio + std::min(restante, fragmentoMaximo);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(dados);
+    uint64_t gear = 0;
+    for (size_t i = inicio + fragmentoMinimo; i < limite; ++i) {
+        gear = (gear << 1) + tabelaGear[p[i]];
+        if ((gear & mascaraFronteira) == 0) {
+            return i + 1;
+        }
+    }
+    return limite;
+}
+
+inline std::vector<Fragmento> fragmentar(const std::string& texto) {
+    std::vector<Fragmento> fragmentos;
+    size_t inicio = 0;
+    while (inicio < texto.size()) {
+        size_t fim = proximaFronteira(texto.data(), texto.size(), inicio);
+        fragmentos.push_back({inicio, fim - inicio, hashConteudo(texto.data() + inicio, fim - inicio)});
+        inicio = fim;
+    }
+    return fragmentos;
+}
+
+#endif // FRAGMENTACAO_H
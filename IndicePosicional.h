@@ -0,0 +1,421 @@
+#ifndef INDICE_POSICIONAL_H
+#define INDICE_POSICIONAL_H
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+#include "ClassesCaracteres.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Contagens por intervalo de posições de um documento já processado, sem reler o texto:
+//
+// - IndicePosicional: para cada classe (letras, números, quebras de linha), um bit por byte do
+//   documento e a soma acumulada no início de cada bloco de 512 bytes. A contagem em [0, p) é a
+//   soma do bloco mais no máximo 8 popcounts, então um intervalo custa O(1) nas duas pontas.
+//   São 3 bits por byte de texto (37,5% do tamanho) mais ~5% de somas; o texto não é guardado.
+//   A linha k começa depois da k-ésima quebra, achada por busca binária nas somas.
+// - IndicesDocumentos: índices gravados em arquivos <hash>.pos (pelo hash de Fragmentacao.h),
+//   mapeados com mmap na consulta e compartilhados entre os processos do Mestre. Acima do
+//   limite de bytes em disco, os arquivos mais antigos são apagados.
+//
+// Variáveis de ambiente (lidas pelo Mestre):
+//   INDICE_POSICIONAL   0 desativa a construção dos índices (padrão: 1)
+//   INDICES_MAX_BYTES   espaço em disco dos índices (padrão: 1 GB)
+
+class IndicePosicional {
+public:
+    enum Classe { Letras = 0, Numeros = 1, Linhas = 2 };
+    static constexpr size_t numClasses = 3;
+    static constexpr size_t palavrasPorBloco = 8; // 8 x 64 bits = 512 bytes de texto por bloco
+
+    static const char* nomeClasse(size_t c) {
+        static const char* nomes[numClasses] = {"letras", "numeros", "linhas"};
+        return nomes[c];
+    }
+
+private:
+    static constexpr uint64_t magia = 0x31304c534f505849ULL; // "IXPOSL01"
+
+    // Arquivo: Cabecalho | bits[classe][palavras] | acumulado[classe][blocos + 1]
+    struct Cabecalho {
+        uint64_t magia;
+        uint64_t tamanho;  // bytes do documento
+        uint64_t palavras; // ceil(tamanho / 64)
+        uint64_t blocos;   // ceil(palavras / 8)
+        uint64_t totais[numClasses];
+        uint64_t reservado;
+    };
+
+    std::vector<uint64_t> memoria; // índice construído neste processo
+    void* mapa = nullptr;          // ou aberto de um arquivo
+    size_t tamanhoMapa = 0;
+
+    const Cabecalho* cabecalho = nullptr;
+    const uint64_t* bits[numClasses] = {};
+    const uint64_t* acumulado[numClasses] = {};
+
+    static size_t palavrasTotais(uint64_t palavras, uint64_t blocos) {
+        return sizeof(Cabecalho) / 8 + numClasses * (palavras + blocos + 1);
+    }
+
+    void apontar(const uint64_t* base) {
+        cabecalho = reinterpret_cast<const Cabecalho*>(base);
+        const uint64_t* p = base + sizeof(Cabecalho) / 8;
+        for (size_t c = 0; c < numClasses; ++c) {
+            bits[c] = p;
+            p += cabecalho->palavras;
+        }
+        for (size_t c = 0; c < numClasses; ++c) {
+            acumulado[c] = p;
+            p += cabecalho->blocos + 1;
+        }
+    }
+
+    // Máscaras de 64 bytes: bit i = byte i pertence à classe
+    static void mascaras(const unsigned char* p, size_t n, uint64_t saida[numClasses]) {
+        saida[Letras] = saida[Numeros] = saida[Linhas] = 0;
+        size_t i = 0;
+#ifdef __SSE2__
+        const __m128i minLetra = _mm_set1_epi8('a' - 1), maxLetra = _mm_set1_epi8('z' + 1);
+        const __m128i minDigito = _mm_set1_epi8('0' - 1), maxDigito = _mm_set1_epi8('9' + 1);
+        const __m128i caixa = _mm_set1_epi8(0x20), quebra = _mm_set1_epi8('\n');
+        for (; i + 16 <= n; i += 16) {
+            // Comparações com sinal: bytes >= 0x80 ficam negativos e não entram em nenhuma faixa
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i minuscula = _mm_or_si128(v, caixa);
+            __m128i letra = _mm_and_si128(_mm_cmpgt_epi8(minuscula, minLetra), _mm_cmplt_epi8(minuscula, maxLetra));
+            __m128i digito = _mm_and_si128(_mm_cmpgt_epi8(v, minDigito), _mm_cmplt_epi8(v, maxDigito));
+            saida[Letras] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(letra))) << i;
+            saida[Numeros] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(digito))) << i;
+            saida[Linhas] |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quebra)))) << i;
+        }
+#endif
+        for (; i < n; ++i) {
+            saida[Letras] |= static_cast<uint64_t>(PoliticaLetras::pertence(p[i])) << i;
+            saida[Numeros] |= static_cast<uint64_t>(PoliticaNumeros::pertence(p[i])) << i;
+            saida[Linhas] |= static_cast<uint64_t>(p[i] == '\n') << i;
+        }
+    }
+
+public:
+    // Constrói o índice de um texto (uma passada)
+    IndicePosicional(const char* texto, size_t tamanho) {
+        uint64_t palavras = (tamanho + 63) / 64;
+        uint64_t blocos = (palavras + palavrasPorBloco - 1) / palavrasPorBloco;
+        memoria.assign(palavrasTotais(palavras, blocos), 0);
+        Cabecalho* c = reinterpret_cast<Cabecalho*>(memoria.data());
+        c->magia = magia;
+        c->tamanho = tamanho;
+        c->palavras = palavras;
+        c->blocos = blocos;
+        apontar(memoria.data());
+
+        uint64_t* bitsEscrita[numClasses];
+        uint64_t* acumuladoEscrita[numClasses];
+        for (size_t k = 0; k < numClasses; ++k) {
+            bitsEscrita[k] = const_cast<uint64_t*>(bits[k]);
+            acumuladoEscrita[k] = const_cast<uint64_t*>(acumulado[k]);
+        }
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(texto);
+        uint64_t soma[numClasses] = {0, 0, 0};
+        for (uint64_t w = 0; w < palavras; ++w) {
+            if (w % palavrasPorBloco == 0) {
+                for (size_t k = 0; k < numClasses; ++k) acumuladoEscrita[k][w / palavrasPorBloco] = soma[k];
+            }
+            uint64_t m[numClasses];
+            mascaras(p + w * 64, std::min<size_t>(64, tamanho - w * 64), m);
+            for (size_t k = 0; k < numClasses; ++k) {
+                bitsEscrita[k][w] = m[k];
+                soma[k] += __builtin_popcountll(m[k]);
+            }
+        }
+        for (size_t k = 0; k < numClasses; ++k) {
+            acumuladoEscrita[k][blocos] = soma[k];
+            c->totais[k] = soma[k];
+        }
+    }
+
+    // Índice gravado por gravar(); nullptr se o arquivo não existe ou não é válido
+    static std::shared_ptr<const IndicePosicional> abrir(const std::string& arquivo) {
+        int fd = open(arquivo.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Cabecalho)) {
+            close(fd);
+            return nullptr;
+        }
+        void* mapa = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapa == MAP_FAILED) {
+            return nullptr;
+        }
+        const Cabecalho* c = static_cast<const Cabecalho*>(mapa);
+        if (c->magia != magia || c->palavras != (c->tamanho + 63) / 64
+            || c->blocos != (c->palavras + palavrasPorBloco - 1) / palavrasPorBloco
+            || static_cast<size_t>(info.st_size) != palavrasTotais(c->palavras, c->blocos) * 8) {
+            munmap(mapa, info.st_size);
+            return nullptr;
+        }
+        std::shared_ptr<IndicePosicional> indice(new IndicePosicional());
+        indice->mapa = mapa;
+        indice->tamanhoMapa = info.st_size;
+        indice->apontar(static_cast<const uint64_t*>(mapa));
+        return indice;
+    }
+
+    ~IndicePosicional() {
+        if (mapa) {
+            munmap(mapa, tamanhoMapa);
+        }
+    }
+
+    IndicePosicional(const IndicePosicional&) = delete;
+    IndicePosicional& operator=(const IndicePosicional&) = delete;
+
+    // Grava em arquivo temporário e troca por rename: quem abre vê o índice inteiro ou nenhum
+    bool gravar(const std::string& arquivo) const {
+        std::string temporario = arquivo + ".tmp." + std::to_string(getpid()) + "."
+                               + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        int fd = open(temporario.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        const char* dados = reinterpret_cast<const char*>(memoria.data());
+        size_t restante = memoria.size() * 8;
+        while (restante > 0) {
+            ssize_t n = write(fd, dados, restante);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                close(fd);
+                unlink(temporario.c_str());
+                return false;
+            }
+            dados += n;
+            restante -= n;
+        }
+        close(fd);
+        if (rename(temporario.c_str(), arquivo.c_str()) != 0) {
+            unlink(temporario.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t tamanho() const { return cabecalho->tamanho; }
+    uint64_t total(Classe c) const { return cabecalho->totais[c]; }
+    size_t bytes() const { return mapa ? tamanhoMapa : memoria.size() * 8; }
+
+    // Linhas do documento; a última pode não terminar em quebra
+    uint64_t linhas() const {
+        uint64_t n = tamanho();
+        bool ultimaAberta = n > 0 && !((bits[Linhas][(n - 1) / 64] >> ((n - 1) % 64)) & 1);
+        return total(Linhas) + (ultimaAberta ? 1 : 0);
+    }
+
+    // Quantos bytes da classe há em [0, posicao)
+    uint64_t ate(Classe c, uint64_t posicao) const {
+        posicao = std::min(posicao, tamanho());
+        uint64_t palavra = posicao / 64;
+        uint64_t bloco = palavra / palavrasPorBloco;
+        uint64_t n = acumulado[c][bloco];
+        for (uint64_t w = bloco * palavrasPorBloco; w < palavra; ++w) {
+            n += __builtin_popcountll(bits[c][w]);
+        }
+        if (posicao % 64) {
+            n += __builtin_popcountll(bits[c][palavra] & ((1ULL << (posicao % 64)) - 1));
+        }
+        return n;
+    }
+
+    // Quantos bytes da classe há em [inicio, fim)
+    uint64_t contar(Classe c, uint64_t inicio, uint64_t fim) const {
+        return fim > inicio ? ate(c, fim) - ate(c, inicio) : 0;
+    }
+
+    // Posição do primeiro byte da linha (0-based); depois da última linha, o tamanho do documento
+    uint64_t inicioLinha(uint64_t linha) const {
+        if (linha == 0) {
+            return 0;
+        }
+        if (linha > total(Linhas)) {
+            return tamanho();
+        }
+        // Bloco que contém a quebra número 'linha': último bloco com acumulado < linha
+        const uint64_t* somas = acumulado[Linhas];
+        uint64_t bloco = std::lower_bound(somas, somas + cabecalho->blocos + 1, linha) - somas - 1;
+        uint64_t restante = linha - somas[bloco];
+        for (uint64_t w = bloco * palavrasPorBloco; w < cabecalho->palavras; ++w) {
+            uint64_t m = bits[Linhas][w];
+            uint64_t n = __builtin_popcountll(m);
+            if (restante > n) {
+                restante -= n;
+                continue;
+            }
+            for (; restante > 1; --restante) {
+                m &= m - 1;
+            }
+            return w * 64 + __builtin_ctzll(m) + 1;
+        }
+        return tamanho();
+    }
+
+private:
+    IndicePosicional() = default;
+};
+
+class IndicesDocumentos {
+private:
+    std::string diretorio;
+    uint64_t maximoBytes;
+    std::atomic<bool> aberto{false}; // só depois de abrir() criar o diretório
+    static constexpr size_t capacidadeAbertos = 16;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const IndicePosicional>> abertos;
+    std::deque<std::string> ordemAbertos;
+    std::atomic<uint64_t> bytesDisco{0}; // estimativa deste processo, corrigida a cada limpeza
+
+    std::atomic<uint64_t> construidos{0};
+    std::atomic<uint64_t> consultas{0};
+    std::atomic<uint64_t> removidos{0};
+    std::atomic<double> construcaoMs{0.0};
+
+    std::string arquivo(const std::string& hash) const {
+        return diretorio + "/" + hash + ".pos";
+    }
+
+    // Apaga os índices mais antigos até caber no limite (com folga de 10%)
+    void limpar() {
+        namespace fs = std::filesystem;
+        std::vector<std::pair<fs::file_time_type, fs::path>> arquivos;
+        uint64_t total = 0;
+        std::error_code erro;
+        for (const auto& entrada : fs::directory_iterator(diretorio, erro)) {
+            if (entrada.path().extension() != ".pos") continue;
+            uint64_t tamanho = entrada.file_size(erro);
+            if (erro) continue;
+            total += tamanho;
+            arquivos.emplace_back(entrada.last_write_time(erro), entrada.path());
+        }
+        std::sort(arquivos.begin(), arquivos.end());
+        for (const auto& [quando, caminho] : arquivos) {
+            if (total <= maximoBytes - maximoBytes / 10) break;
+            uint64_t tamanho = fs::file_size(caminho, erro);
+            if (!erro && fs::remove(caminho, erro)) {
+                total -= tamanho;
+                removidos++;
+            }
+        }
+        bytesDisco = total;
+    }
+
+public:
+    // Diretório vazio desativa os índices; os demais só valem depois de abrir()
+    IndicesDocumentos(std::string pasta, uint64_t maximo)
+        : diretorio(std::move(pasta)), maximoBytes(maximo) {}
+
+    bool ativo() const {
+        return aberto.load(std::memory_order_acquire);
+    }
+
+    void abrir() {
+        if (diretorio.empty() || ativo()) {
+            return;
+        }
+        std::error_code erro;
+        std::filesystem::create_directories(diretorio, erro);
+        if (erro) {
+            std::cerr << "Índices posicionais desativados: não foi possível criar " << diretorio << ": "
+                     << erro.message() << std::endl;
+            return;
+        }
+        limpar();
+        aberto.store(true, std::memory_order_release);
+    }
+
+    // Constrói e grava o índice do documento, se ainda não existe (mesmo hash, mesmo conteúdo)
+    void indexar(const std::string& hash, const char* texto, size_t tamanho) {
+        if (!ativo() || access(arquivo(hash).c_str(), F_OK) == 0) {
+            return;
+        }
+        auto inicio = std::chrono::steady_clock::now();
+        IndicePosicional indice(texto, tamanho);
+        if (indice.bytes() > maximoBytes) {
+            return;
+        }
+        if (!indice.gravar(arquivo(hash))) {
+            std::cerr << "Falha ao gravar o índice posicional de " << hash << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        construidos++;
+        construcaoMs.store(ms, std::memory_order_relaxed);
+        if ((bytesDisco += indice.bytes()) > maximoBytes) {
+            limpar();
+        }
+    }
+
+    std::shared_ptr<const IndicePosicional> buscar(const std::string& hash) {
+        if (!ativo()) {
+            return nullptr;
+        }
+        consultas++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = abertos.find(hash);
+            if (it != abertos.end()) {
+                return it->second;
+            }
+        }
+        auto indice = IndicePosicional::abrir(arquivo(hash));
+        if (!indice) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (abertos.emplace(hash, indice).second) {
+            ordemAbertos.push_back(hash);
+            while (abertos.size() > capacidadeAbertos) {
+                abertos.erase(ordemAbertos.front());
+                ordemAbertos.pop_front();
+            }
+        }
+        return indice;
+    }
+
+    Json::Value estado() const {
+        Json::Value e;
+        e["ativo"] = ativo();
+        e["construidos"] = Json::Value::UInt64(construidos.load());
+        e["ultima_construcao_ms"] = construcaoMs.load();
+        e["consultas"] = Json::Value::UInt64(consultas.load());
+        e["bytes_disco"] = Json::Value::UInt64(bytesDisco.load());
+        e["maximo_bytes"] = Json::Value::UInt64(maximoBytes);
+        e["removidos"] = Json::Value::UInt64(removidos.load());
+        return e;
+    }
+};
+
+#endif // INDICE_POSICIONAL_H
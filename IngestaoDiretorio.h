@@ -0,0 +1,376 @@
+#ifndef INGESTAO_DIRETORIO_H
+#define INGESTAO_DIRETORIO_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "Fragmentacao.h"
+
+// Processamento de uma pasta inteira pelo cliente, em pipeline:
+//
+//   varredura (1 thread) -> leitura + hash (N threads) -> envio ao Mestre (M conexões keep-alive)
+//
+// As filas entre as etapas são limitadas, então a memória fica presa a poucos arquivos em voo
+// mesmo com dezenas de milhares de arquivos. Arquivos com o mesmo conteúdo (mesmo hash) são
+// enviados uma única vez, mesmo quando chegam a conexões diferentes ao mesmo tempo. Cancelar
+// interrompe os envios em andamento.
+
+// Fila bloqueante com capacidade máxima; fechar() libera quem espera
+template <typename T>
+class FilaLimitada {
+private:
+    std::deque<T> itens;
+    size_t capacidade;
+    bool fechada = false;
+    std::mutex mutex;
+    std::condition_variable naoCheia;
+    std::condition_variable naoVazia;
+
+public:
+    explicit FilaLimitada(size_t maximo) : capacidade(maximo > 0 ? maximo : 1) {}
+
+    // false se a fila foi fechada
+    bool colocar(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        naoCheia.wait(lock, [this]() { return fechada || itens.size() < capacidade; });
+        if (fechada) {
+            return false;
+        }
+        itens.push_back(std::move(item));
+        naoVazia.notify_one();
+        return true;
+    }
+
+    // nullopt quando a fila está fechada e vazia
+    std::optional<T> retirar() {
+        std::unique_lock<std::mutex> lock(mutex);
+        naoVazia.wait(lock, [this]() { return fechada || !itens.empty(); });
+        if (itens.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(itens.front());
+        itens.pop_front();
+        naoCheia.notify_one();
+        return item;
+    }
+
+    void fechar() {
+        std::lock_guard<std::mutex> lock(mutex);
+        fechada = true;
+        naoCheia.notify_all();
+        naoVazia.notify_all();
+    }
+};
+
+struct ResultadoArquivo {
+    std::string caminho;
+    uint64_t bytes = 0;
+    uint64_t letras = 0;
+    uint64_t numeros = 0;
+    bool reaproveitado = false; // conteúdo idêntico a outro arquivo já enviado
+    std::string erro;
+};
+
+struct ProgressoIngestao {
+    uint64_t arquivosEncontrados = 0;
+    uint64_t arquivosConcluidos = 0;
+    uint64_t falhas = 0;
+    uint64_t bytes = 0;
+    uint64_t letras = 0;
+    uint64_t numeros = 0;
+    double segundos = 0.0;
+    bool varreduraConcluida = false;
+    bool concluido = false;
+
+    double arquivosPorSegundo() const { return segundos > 0 ? arquivosConcluidos / segundos : 0.0; }
+    double megabytesPorSegundo() const { return segundos > 0 ? bytes / 1e6 / segundos : 0.0; }
+};
+
+class IngestaoDiretorio {
+private:
+    struct Documento {
+        std::string caminho;
+        std::string conteudo;
+        std::string hash;
+    };
+
+    std::string diretorio;
+    std::string host;
+    int porta;
+    size_t leitores;
+    size_t conexoes;
+    static constexpr size_t blocoEnvio = 1 << 20;
+
+    FilaLimitada<std::string> caminhos;
+    FilaLimitada<Documento> documentos;
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> cancelado{false};
+    std::atomic<size_t> leitoresAtivos{0};
+    std::atomic<size_t> enviosAtivos{0};
+    std::chrono::steady_clock::time_point inicio;
+
+    mutable std::mutex mutex;
+    ProgressoIngestao progresso;
+    std::vector<ResultadoArquivo> resultados;
+
+    // Conteúdo por hash. A primeira cópia vista deixa a entrada pendente e é a única enviada;
+    // cópias que chegam antes da resposta esperam na entrada e são concluídas junto com ela
+    struct EntradaHash {
+        bool pronta = false;
+        ResultadoArquivo resultado;
+        std::vector<ResultadoArquivo> aguardando;
+    };
+    std::unordered_map<std::string, EntradaHash> porHash;
+
+    // Clientes com requisição possivelmente em andamento: cancelar() os interrompe com stop()
+    std::vector<httplib::Client*> clientesAtivos;
+
+    static bool arquivoTexto(const std::filesystem::path& caminho) {
+        return caminho.extension() == ".txt";
+    }
+
+    void varrer() {
+        std::error_code erro;
+        auto opcoes = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator it(diretorio, opcoes, erro), fim; it != fim && !cancelado;
+             it.increment(erro)) {
+            if (erro) break;
+            if (!it->is_regular_file(erro) || !arquivoTexto(it->path())) continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++progresso.arquivosEncontrados;
+            }
+            if (!caminhos.colocar(it->path().string())) break;
+        }
+        if (erro) {
+            registrar({diretorio, 0, 0, 0, false, "Erro ao percorrer a pasta: " + erro.message()});
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            progresso.varreduraConcluida = true;
+        }
+        caminhos.fechar();
+    }
+
+    void ler() {
+        while (auto caminho = caminhos.retirar()) {
+            if (cancelado) continue;
+            std::ifstream arquivo(*caminho, std::ios::binary);
+            if (!arquivo) {
+                registrar({*caminho, 0, 0, 0, false, "Erro ao abrir arquivo"});
+                continue;
+            }
+            std::ostringstream buffer;
+            buffer << arquivo.rdbuf();
+            Documento documento{*caminho, buffer.str(), ""};
+            documento.hash = hashConteudo(documento.conteudo);
+            if (!documentos.colocar(std::move(documento))) break;
+        }
+    }
+
+    void enviar() {
+        httplib::Client client(host, porta);
+        client.set_keep_alive(true);
+        client.set_read_timeout(300);
+        client.set_write_timeout(300);
+
+        struct RegistroCliente {
+            IngestaoDiretorio& ingestao;
+            httplib::Client* client;
+            ~RegistroCliente() {
+                std::lock_guard<std::mutex> lock(ingestao.mutex);
+                auto& ativos = ingestao.clientesAtivos;
+                ativos.erase(std::remove(ativos.begin(), ativos.end(), client), ativos.end());
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            clientesAtivos.push_back(&client);
+        }
+        RegistroCliente registro{*this, &client};
+
+        while (auto documento = documentos.retirar()) {
+            if (cancelado) continue;
+            ResultadoArquivo resultado;
+            resultado.caminho = documento->caminho;
+            resultado.bytes = documento->conteudo.size();
+
+            // Conteúdo repetido: reaproveita a contagem já obtida ou espera a do envio em andamento
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto [it, novo] = porHash.try_emplace(documento->hash);
+                if (!novo) {
+                    resultado.reaproveitado = true;
+                    if (it->second.pronta) {
+                        resultado.letras = it->second.resultado.letras;
+                        resultado.numeros = it->second.resultado.numeros;
+                        registrarComTrava(resultado);
+                    } else {
+                        it->second.aguardando.push_back(std::move(resultado));
+                    }
+                    continue;
+                }
+            }
+            enviarDocumento(client, *documento, resultado);
+            concluirHash(documento->hash, resultado);
+        }
+    }
+
+    // Resultado do envio de um conteúdo: vale também para as cópias que esperavam por ele. Em caso
+    // de erro a entrada sai do mapa, e uma cópia vista depois tenta de novo
+    void concluirHash(const std::string& hash, const ResultadoArquivo& resultado) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = porHash.find(hash);
+        std::vector<ResultadoArquivo> aguardando = std::move(it->second.aguardando);
+        if (resultado.erro.empty()) {
+            it->second.pronta = true;
+            it->second.resultado = resultado;
+        } else {
+            porHash.erase(it);
+        }
+        registrarComTrava(resultado);
+        for (auto& copia : aguardando) {
+            copia.letras = resultado.letras;
+            copia.numeros = resultado.numeros;
+            copia.erro = resultado.erro;
+            registrarComTrava(copia);
+        }
+    }
+
+    void enviarDocumento(httplib::Client& client, const Documento& documento, ResultadoArquivo& resultado) {
+        Json::Value requestJson;
+        requestJson["texto"] = documento.conteudo;
+        Json::StreamWriterBuilder builder;
+        std::string jsonString = Json::writeString(builder, requestJson);
+
+        // Corpo em blocos que conferem o cancelamento: cobre o intervalo em que cancelar() chega
+        // antes de a conexão existir (stop() não tem o que fechar)
+        auto resposta = client.Post(
+            "/processar", jsonString.size(),
+            [&](size_t offset, size_t length, httplib::DataSink& sink) {
+                if (cancelado) return false;
+                return sink.write(jsonString.data() + offset, std::min<size_t>(length, blocoEnvio));
+            },
+            "application/json");
+        Json::Value json;
+        Json::Reader reader;
+        if (!resposta) {
+            resultado.erro = "Erro na comunicação com o servidor mestre";
+        } else if (resposta->status != 200) {
+            resultado.erro = "Erro do servidor: " + std::to_string(resposta->status);
+        } else if (!reader.parse(resposta->body, json)) {
+            resultado.erro = "Erro ao parsear resposta JSON";
+        } else {
+            resultado.letras = json["letras"].asUInt64();
+            resultado.numeros = json["numeros"].asUInt64();
+        }
+    }
+
+    void registrar(const ResultadoArquivo& resultado) {
+        std::lock_guard<std::mutex> lock(mutex);
+        registrarComTrava(resultado);
+    }
+
+    void registrarComTrava(const ResultadoArquivo& resultado) {
+        if (resultado.erro.empty()) {
+            ++progresso.arquivosConcluidos;
+            progresso.bytes += resultado.bytes;
+            progresso.letras += resultado.letras;
+            progresso.numeros += resultado.numeros;
+        } else {
+            ++progresso.falhas;
+        }
+        resultados.push_back(resultado);
+    }
+
+public:
+    IngestaoDiretorio(std::string pasta, std::string hostMestre, int portaMestre,
+                      size_t threadsLeitura = 4, size_t conexoesMestre = 4)
+        : diretorio(std::move(pasta)), host(std::move(hostMestre)), porta(portaMestre),
+          leitores(std::max<size_t>(1, threadsLeitura)), conexoes(std::max<size_t>(1, conexoesMestre)),
+          caminhos(1024), documentos(conexoes * 2) {}
+
+    ~IngestaoDiretorio() {
+        cancelar();
+        aguardar();
+    }
+
+    void iniciar() {
+        inicio = std::chrono::steady_clock::now();
+        leitoresAtivos = leitores;
+        enviosAtivos = conexoes;
+
+        threads.emplace_back([this]() { varrer(); });
+        for (size_t i = 0; i < leitores; ++i) {
+            threads.emplace_back([this]() {
+                ler();
+                // O último leitor fecha a fila de documentos
+                if (--leitoresAtivos == 0) documentos.fechar();
+            });
+        }
+        for (size_t i = 0; i < conexoes; ++i) {
+            threads.emplace_back([this]() {
+                enviar();
+                if (--enviosAtivos == 0) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    progresso.concluido = true;
+                    progresso.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+                }
+            });
+        }
+    }
+
+    // Interrompe também as requisições em andamento: sem isso o destrutor (na GUI) esperaria
+    // até o timeout de leitura de 300 s de cada envio
+    void cancelar() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelado = true;
+            for (httplib::Client* client : clientesAtivos) {
+                client->stop();
+            }
+        }
+        caminhos.fechar();
+        documentos.fechar();
+    }
+
+    void aguardar() {
+        for (auto& t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+    ProgressoIngestao estado() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        ProgressoIngestao atual = progresso;
+        if (!atual.concluido) {
+            atual.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        }
+        return atual;
+    }
+
+    // Resultados por arquivo a partir da posição 'desde' (para exibição incremental)
+    std::vector<ResultadoArquivo> resultadosDesde(size_t desde) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (desde >= resultados.size()) {
+            return {};
+        }
+        return std::vector<ResultadoArquivo>(resultados.begin() + desde, resultados.end());
+    }
+};
+
+#endif // INGESTAO_DIRETORIO_H
@@ -0,0 +1,432 @@
+#ifndef JSON_INCREMENTAL_H
+#define JSON_INCREMENTAL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Leitura do payload dos escravos ({"texto": "..."} ou {"fragmentos": ["...", ...]}) pedaço a
+// pedaço, à medida que o corpo chega, sem montar o documento nem o texto em memória.
+//
+// LeitorTextoJson valida a estrutura do JSON inteiro e repassa ao receptor só os bytes já
+// decodificados (escapes resolvidos, \uXXXX em UTF-8) do campo "texto" e de cada elemento de
+// "fragmentos" no objeto de nível superior. Trechos sem escape são repassados direto do pedaço
+// recebido, sem cópia; um escape dividido entre dois pedaços é guardado no próprio estado.
+// A memória usada não depende do tamanho do corpo.
+//
+// O receptor implementa:
+//   void texto(const char* dados, size_t tamanho);
+//   void inicioFragmento();   // um por elemento de "fragmentos", mesmo que não seja string
+//   void fragmento(const char* dados, size_t tamanho);
+
+template <typename Receptor>
+class LeitorTextoJson {
+private:
+    enum class Estado {
+        Valor,          // espera um valor
+        ValorOuFecha,   // logo após '[': valor ou ']'
+        ChaveOuFecha,   // logo após '{': chave ou '}'
+        Chave,          // espera a chave após ','
+        DoisPontos,
+        String,
+        Escape,
+        Unicode,
+        Literal,        // número, true, false ou null
+        DepoisValor,    // ',' ou fechamento
+        Fim,
+        Erro
+    };
+
+    // Para onde vão os bytes da string atual
+    enum class Destino { Ignorar, ChaveAtual, Texto, Fragmento };
+
+    // Campo do objeto de nível superior cujo valor está sendo lido
+    enum class Campo { Outro, Texto, Fragmentos };
+
+    static constexpr size_t profundidadeMaxima = 64;
+    static constexpr size_t chaveMaxima = 16;
+    static constexpr size_t literalMaximo = 64;
+
+    Receptor& receptor;
+    Estado estado = Estado::Valor;
+    Destino destino = Destino::Ignorar;
+    Campo campo = Campo::Outro;
+    char pilha[profundidadeMaxima];
+    size_t profundidade = 0;
+    bool emFragmentos = false; // o array em pilha[1] é "fragmentos"
+    bool fragmentosEncontrados = false;
+
+    char chave[chaveMaxima];
+    size_t tamanhoChave = 0;
+    bool chaveLonga = false;
+
+    char literal[literalMaximo];
+    size_t tamanhoLiteral = 0;
+
+    uint32_t codigo = 0;         // \uXXXX em leitura
+    int digitosUnicode = 0;
+    uint32_t surrogateAlto = 0;  // primeira metade de um par \uD8xx\uDCxx
+    bool esperaSurrogate = false;
+
+    uint64_t bytesLidos = 0;
+    const char* aspasPedaco = nullptr; // próximas aspas no pedaço atual (fim se não há)
+
+    void emitir(const char* dados, size_t tamanho) {
+        if (tamanho == 0) {
+            return;
+        }
+        switch (destino) {
+            case Destino::Texto: receptor.texto(dados, tamanho); break;
+            case Destino::Fragmento: receptor.fragmento(dados, tamanho); break;
+            case Destino::ChaveAtual:
+                if (tamanhoChave + tamanho > chaveMaxima) {
+                    chaveLonga = true;
+                } else {
+                    std::memcpy(chave + tamanhoChave, dados, tamanho);
+                    tamanhoChave += tamanho;
+                }
+                break;
+            case Destino::Ignorar: break;
+        }
+    }
+
+    void emitirCodigo(uint32_t c) {
+        char utf8[4];
+        size_t n;
+        if (c < 0x80) {
+            utf8[0] = static_cast<char>(c);
+            n = 1;
+        } else if (c < 0x800) {
+            utf8[0] = static_cast<char>(0xC0 | (c >> 6));
+            utf8[1] = static_cast<char>(0x80 | (c & 0x3F));
+            n = 2;
+        } else if (c < 0x10000) {
+            utf8[0] = static_cast<char>(0xE0 | (c >> 12));
+            utf8[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            utf8[2] = static_cast<char>(0x80 | (c & 0x3F));
+            n = 3;
+        } else {
+            utf8[0] = static_cast<char>(0xF0 | (c >> 18));
+            utf8[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            utf8[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            utf8[3] = static_cast<char>(0x80 | (c & 0x3F));
+            n = 4;
+        }
+        emitir(utf8, n);
+    }
+
+    static bool espaco(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    static bool caractereLiteral(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+            || c == '-' || c == '+' || c == '.';
+    }
+
+    // true, false, null ou número no formato do JSON: -?(0|[1-9]d*)(.d+)?([eE][+-]?d+)?
+    bool literalValido() const {
+        const char* p = literal;
+        const char* fim = literal + tamanhoLiteral;
+        auto palavra = [&](const char* esperada) {
+            return tamanhoLiteral == std::strlen(esperada) && std::memcmp(literal, esperada, tamanhoLiteral) == 0;
+        };
+        if (palavra("true") || palavra("false") || palavra("null")) {
+            return true;
+        }
+        auto digitos = [&]() {
+            const char* inicio = p;
+            while (p < fim && *p >= '0' && *p <= '9') ++p;
+            return p > inicio;
+        };
+        if (p < fim && *p == '-') ++p;
+        if (p < fim && *p == '0') {
+            ++p;
+        } else if (!digitos()) {
+            return false;
+        }
+        if (p < fim && *p == '.') {
+            ++p;
+            if (!digitos()) return false;
+        }
+        if (p < fim && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < fim && (*p == '+' || *p == '-')) ++p;
+            if (!digitos()) return false;
+        }
+        return p == fim;
+    }
+
+    // Um valor terminou: o próximo estado depende de quem o contém
+    void fimValor() {
+        if (profundidade == 1 && pilha[0] == '{') {
+            campo = Campo::Outro;
+        }
+        estado = profundidade == 0 ? Estado::Fim : Estado::DepoisValor;
+    }
+
+    void fimChave() {
+        if (profundidade == 1) {
+            std::string_view nome(chave, tamanhoChave);
+            campo = chaveLonga ? Campo::Outro
+                  : nome == "texto" ? Campo::Texto
+                  : nome == "fragmentos" ? Campo::Fragmentos
+                  : Campo::Outro;
+        }
+        estado = Estado::DoisPontos;
+    }
+
+    bool empilhar(char c) {
+        if (profundidade == profundidadeMaxima) {
+            return false;
+        }
+        pilha[profundidade++] = c;
+        return true;
+    }
+
+    // Primeiro caractere de um valor (já sem espaços)
+    bool iniciarValor(char c) {
+        bool membroTopo = profundidade == 1 && pilha[0] == '{';
+        bool elementoFragmentos = emFragmentos && profundidade == 2;
+        if (elementoFragmentos) {
+            receptor.inicioFragmento();
+        }
+        if (c == '"') {
+            destino = (membroTopo && campo == Campo::Texto) ? Destino::Texto
+                    : elementoFragmentos ? Destino::Fragmento
+                    : Destino::Ignorar;
+            estado = Estado::String;
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            if (!empilhar(c)) {
+                return false;
+            }
+            if (c == '[' && membroTopo && campo == Campo::Fragmentos) {
+                emFragmentos = true;
+                fragmentosEncontrados = true;
+            }
+            estado = c == '{' ? Estado::ChaveOuFecha : Estado::ValorOuFecha;
+            return true;
+        }
+        if (caractereLiteral(c)) {
+            literal[0] = c;
+            tamanhoLiteral = 1;
+            estado = Estado::Literal;
+            return true;
+        }
+        return false;
+    }
+
+    bool fechar(char c) {
+        if (profundidade == 0 || pilha[profundidade - 1] != (c == '}' ? '{' : '[')) {
+            return false;
+        }
+        --profundidade;
+        if (profundidade == 1 && emFragmentos) {
+            emFragmentos = false;
+        }
+        fimValor();
+        return true;
+    }
+
+    // Caractere após a barra de um escape
+    bool escape(char c) {
+        char decodificado;
+        switch (c) {
+            case '"': decodificado = '"'; break;
+            case '\\': decodificado = '\\'; break;
+            case '/': decodificado = '/'; break;
+            case 'b': decodificado = '\b'; break;
+            case 'f': decodificado = '\f'; break;
+            case 'n': decodificado = '\n'; break;
+            case 'r': decodificado = '\r'; break;
+            case 't': decodificado = '\t'; break;
+            case 'u':
+                codigo = 0;
+                digitosUnicode = 0;
+                estado = Estado::Unicode;
+                return true;
+            default:
+                return false;
+        }
+        if (esperaSurrogate) {
+            return false;
+        }
+        emitir(&decodificado, 1);
+        estado = Estado::String;
+        return true;
+    }
+
+    bool digitoUnicode(char c) {
+        uint32_t valor;
+        if (c >= '0' && c <= '9') valor = c - '0';
+        else if (c >= 'a' && c <= 'f') valor = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') valor = c - 'A' + 10;
+        else return false;
+        codigo = (codigo << 4) | valor;
+        if (++digitosUnicode < 4) {
+            return true;
+        }
+        estado = Estado::String;
+        if (esperaSurrogate) {
+            if (codigo < 0xDC00 || codigo > 0xDFFF) {
+                return false;
+            }
+            esperaSurrogate = false;
+            emitirCodigo(0x10000 + ((surrogateAlto - 0xD800) << 10) + (codigo - 0xDC00));
+        } else if (codigo >= 0xD800 && codigo <= 0xDBFF) {
+            surrogateAlto = codigo;
+            esperaSurrogate = true;
+        } else if (codigo >= 0xDC00 && codigo <= 0xDFFF) {
+            return false;
+        } else {
+            emitirCodigo(codigo);
+        }
+        return true;
+    }
+
+    // Conteúdo de string a partir de p; retorna onde parou (após a barra de um escape,
+    // após as aspas de fechamento ou no fim do pedaço)
+    const char* lerString(const char* p, const char* fim) {
+        if (esperaSurrogate && *p != '\\') {
+            estado = Estado::Erro;
+            return fim;
+        }
+        // As aspas seguintes do pedaço são buscadas uma vez, não a cada escape
+        if (!aspasPedaco || aspasPedaco < p) {
+            const void* achada = std::memchr(p, '"', fim - p);
+            aspasPedaco = achada ? static_cast<const char*>(achada) : fim;
+        }
+        const char* limite = aspasPedaco;
+        const char* barra = static_cast<const char*>(std::memchr(p, '\\', limite - p));
+        if (barra) {
+            // O caractere seguinte pode estar no próximo pedaço
+            emitir(p, barra - p);
+            estado = Estado::Escape;
+            return barra + 1;
+        }
+        emitir(p, limite - p);
+        if (limite == fim) {
+            return fim;
+        }
+        if (destino == Destino::ChaveAtual) {
+            fimChave();
+        } else {
+            destino = Destino::Ignorar;
+            fimValor();
+        }
+        return limite + 1;
+    }
+
+public:
+    explicit LeitorTextoJson(Receptor& r) : receptor(r) {}
+
+    // Consome um pedaço do corpo; false assim que o JSON se mostra inválido
+    bool alimentar(const char* dados, size_t tamanho) {
+        const char* p = dados;
+        const char* fim = dados + tamanho;
+        bytesLidos += tamanho;
+        aspasPedaco = nullptr;
+        while (p < fim && estado != Estado::Erro) {
+            if (estado == Estado::String) {
+                p = lerString(p, fim);
+                continue;
+            }
+            char c = *p;
+            bool ok = true;
+            switch (estado) {
+                case Estado::Valor:
+                case Estado::ValorOuFecha:
+                    if (espaco(c)) break;
+                    if (c == ']' && estado == Estado::ValorOuFecha) {
+                        ok = fechar(c);
+                    } else {
+                        ok = iniciarValor(c);
+                    }
+                    break;
+                case Estado::ChaveOuFecha:
+                case Estado::Chave:
+                    if (espaco(c)) break;
+                    if (c == '}' && estado == Estado::ChaveOuFecha) {
+                        ok = fechar(c);
+                    } else if (c == '"') {
+                        destino = Destino::ChaveAtual;
+                        tamanhoChave = 0;
+                        chaveLonga = false;
+                        estado = Estado::String;
+                    } else {
+                        ok = false;
+                    }
+                    break;
+                case Estado::DoisPontos:
+                    if (espaco(c)) break;
+                    if (c == ':') {
+                        destino = Destino::Ignorar;
+                        estado = Estado::Valor;
+                    } else {
+                        ok = false;
+                    }
+                    break;
+                case Estado::Escape:
+                    ok = escape(c);
+                    break;
+                case Estado::Unicode:
+                    ok = digitoUnicode(c);
+                    break;
+                case Estado::Literal:
+                    if (caractereLiteral(c)) {
+                        ok = tamanhoLiteral < literalMaximo;
+                        if (ok) literal[tamanhoLiteral++] = c;
+                        break;
+                    }
+                    ok = literalValido();
+                    if (ok) {
+                        fimValor();
+                        continue; // o caractere que encerrou o literal é lido no novo estado
+                    }
+                    break;
+                case Estado::DepoisValor:
+                    if (espaco(c)) break;
+                    if (c == ',') {
+                        estado = pilha[profundidade - 1] == '{' ? Estado::Chave : Estado::Valor;
+                    } else if (c == '}' || c == ']') {
+                        ok = fechar(c);
+                    } else {
+                        ok = false;
+                    }
+                    break;
+                case Estado::Fim:
+                    ok = espaco(c);
+                    break;
+                default:
+                    ok = false;
+            }
+            if (!ok) {
+                estado = Estado::Erro;
+                return false;
+            }
+            ++p;
+        }
+        return estado != Estado::Erro;
+    }
+
+    // Fim do corpo: o documento precisa estar completo
+    bool concluir() {
+        if (estado == Estado::Literal && profundidade == 0 && literalValido()) {
+            estado = Estado::Fim;
+        }
+        return estado == Estado::Fim;
+    }
+
+    // "fragmentos" é um array no objeto de nível superior (requisição em lote)
+    bool lote() const {
+        return fragmentosEncontrados;
+    }
+
+    uint64_t bytes() const {
+        return bytesLidos;
+    }
+};
+
+#endif // JSON_INCREMENTAL_H
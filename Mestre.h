@@ -0,0 +1,1356 @@
+#ifndef MESTRE_H
+#define MESTRE_H
+
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <memory_resource>
+#include <string_view>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+#include "AfinidadeCpu.h"
+#include "AmostragemAproximada.h"
+#include "ArenaRequisicao.h"
+#include "ArmazemResultados.h"
+#include "Balanceamento.h"
+#include "CacheFragmentos.h"
+#include "DistribuicaoFragmentos.h"
+#include "ExecucaoServidor.h"
+#include "Fragmentacao.h"
+#include "IndicePosicional.h"
+#include "Rastreamento.h"
+
+class Mestre {
+private:
+    httplib::Server servidor;
+    
+    // Réplicas de cada tipo de escravo, configuradas como "host:porta,host:porta"
+    GrupoReplicas escravosLetras;   // Escravo1 (letras), porta padrão 8081
+    GrupoReplicas escravosNumeros;  // Escravo2 (números), porta padrão 8082
+    GrupoReplicas escravosPalavras; // Escravo3 (palavras/n-gramas), porta padrão 8083
+    
+    // Textos grandes de /palavras: fragmentos por réplica e limites de tamanho (ver DistribuicaoFragmentos.h)
+    size_t fragmentosPorReplica = 4;
+    size_t fragmentoMinimoBytes = 1024 * 1024;
+    size_t fragmentoMaximoBytes = 16 * 1024 * 1024;
+    // Maior top-K aceito: os fragmentos pedem top * 4 + 10 candidatos cada
+    static constexpr unsigned topMaximoPalavras = 100000;
+    
+    // /processar/stream: fragmentos enviados aos escravos e quantos ficam em voo ao mesmo tempo
+    size_t streamFragmentoBytes = 4 * 1024 * 1024;
+    size_t streamParalelismo = 4;
+    
+    // /processar com "aproximado": padrões da amostragem e lotes de blocos em voo por rodada
+    AmostragemAproximada::Parametros parametrosAmostragem;
+    size_t amostragemParalelismo = 4;
+    
+    // Contagens por hash de fragmento para o processamento incremental
+    CacheFragmentos cacheFragmentos;
+    
+    // Resultados persistentes por hash de conteúdo; sobrevivem a reinícios (ver ArmazemResultados.h)
+    ArmazemResultados armazem;
+    
+    // Contagens por intervalo dos documentos processados, ao lado do armazém (ver IndicePosicional.h)
+    IndicesDocumentos indices;
+    
+    // Alocações por requisição nas rotas de processamento (ver ArenaRequisicao.h)
+    MedidorAlocacoes alocacoes;
+    
+    // Membros registrados dinamicamente expiram sem heartbeat por este intervalo
+    int64_t expiracaoMembroMs = 10000;
+    std::thread threadExpiracao;
+    std::atomic<bool> ativo{false};
+    
+    static std::string variavelAmbiente(const char* nome, const char* padrao) {
+        const char* valor = std::getenv(nome);
+        return valor ? valor : padrao;
+    }
+    
+public:
+    Mestre()
+        : escravosLetras("Escravo1 (letras)", variavelAmbiente("ESCRAVOS_LETRAS", "escravo1:8081"),
+                         criarPoliticaBalanceamento(variavelAmbiente("BALANCEAMENTO", "p2c-ewma"))),
+          escravosNumeros("Escravo2 (números)", variavelAmbiente("ESCRAVOS_NUMEROS", "escravo2:8082"),
+                          criarPoliticaBalanceamento(variavelAmbiente("BALANCEAMENTO", "p2c-ewma"))),
+          escravosPalavras("Escravo3 (palavras)", variavelAmbiente("ESCRAVOS_PALAVRAS", "escravo3:8083"),
+                           criarPoliticaBalanceamento(variavelAmbiente("BALANCEAMENTO", "p2c-ewma"))),
+          cacheFragmentos(std::stoull(variavelAmbiente("CACHE_FRAGMENTOS_MAX", "100000"))),
+          armazem(variavelAmbiente("ARMAZEM_DIR", "dados"),
+                  std::stoull(variavelAmbiente("ARMAZEM_MAX_REGISTROS", "10000000"))),
+          indices(variavelAmbiente("ARMAZEM_DIR", "dados").empty() || variavelAmbiente("INDICE_POSICIONAL", "1") == "0"
+                      ? "" : variavelAmbiente("ARMAZEM_DIR", "dados") + "/indices",
+                  std::stoull(variavelAmbiente("INDICES_MAX_BYTES", "1073741824"))) {
+        expiracaoMembroMs = std::stoll(variavelAmbiente("EXPIRACAO_MEMBRO_MS", "10000"));
+        fragmentosPorReplica = std::max<size_t>(1, std::stoull(variavelAmbiente("FRAGMENTOS_POR_REPLICA", "4")));
+        fragmentoMinimoBytes = std::stoull(variavelAmbiente("FRAGMENTO_MINIMO_BYTES", "1048576"));
+        fragmentoMaximoBytes = std::stoull(variavelAmbiente("FRAGMENTO_MAXIMO_BYTES", "16777216"));
+        streamFragmentoBytes = std::max<size_t>(1, std::stoull(variavelAmbiente("STREAM_FRAGMENTO_BYTES", "4194304")));
+        streamParalelismo = std::max<size_t>(1, std::stoull(variavelAmbiente("STREAM_PARALELISMO", "4")));
+        parametrosAmostragem.erroRelativo = std::stod(variavelAmbiente("AMOSTRAGEM_ERRO", "0.001"));
+        parametrosAmostragem.confianca = std::stod(variavelAmbiente("AMOSTRAGEM_CONFIANCA", "0.95"));
+        parametrosAmostragem.blocoBytes = std::max<size_t>(64, std::stoull(variavelAmbiente("AMOSTRAGEM_BLOCO_BYTES", "4096")));
+        amostragemParalelismo = std::max<size_t>(1, std::stoull(variavelAmbiente("AMOSTRAGEM_PARALELISMO", "4")));
+        // Com vários processos na mesma porta, cada um recebe só parte dos heartbeats
+        expiracaoMembroMs *= std::max(1, std::atoi(variavelAmbiente("PROCESSOS", "1").c_str()));
+        configurarRotas();
+    }
+    
+    ~Mestre() {
+        pararTarefasFundo();
+    }
+    
+    GrupoReplicas* grupoPorTipo(const std::string& tipo) {
+        if (tipo == "letras") return &escravosLetras;
+        if (tipo == "numeros") return &escravosNumeros;
+        if (tipo == "palavras") return &escravosPalavras;
+        return nullptr;
+    }
+    
+    void configurarRotas() {
+        // Rota para receber arquivos do cliente
+        servidor.Post("/processar", [this](const httplib::Request& req, httplib::Response& res) {
+            this->processarTexto(req, res);
+        });
+        
+        // Mesmo processamento, com resultados parciais como server-sent events
+        servidor.Post("/processar/stream", [this](const httplib::Request& req, httplib::Response& res) {
+            this->processarTextoStream(req, res);
+        });
+        
+        // Reprocessamento incremental: manifesto de fragmentos + apenas os fragmentos que faltam
+        servidor.Post("/processar/incremental", [this](const httplib::Request& req, httplib::Response& res) {
+            this->processarIncremental(req, res);
+        });
+        
+        // Rota de frequência de palavras e n-gramas (fragmentada entre réplicas do Escravo3)
+        servidor.Post("/palavras", [this](const httplib::Request& req, httplib::Response& res) {
+            this->processarPalavras(req, res);
+        });
+        
+        // Registro dinâmico de escravos e heartbeats periódicos com a carga atual
+        servidor.Post("/registrar", [this](const httplib::Request& req, httplib::Response& res) {
+            this->atualizarMembro(req, res, "registrar");
+        });
+        servidor.Post("/heartbeat", [this](const httplib::Request& req, httplib::Response& res) {
+            this->atualizarMembro(req, res, "heartbeat");
+        });
+        servidor.Post("/desregistrar", [this](const httplib::Request& req, httplib::Response& res) {
+            this->atualizarMembro(req, res, "desregistrar");
+        });
+        
+        // Consulta de resultados já calculados, pelo hash do texto (ver Fragmentacao.h)
+        servidor.Get("/resultados/(.*)", [this](const httplib::Request& req, httplib::Response& res) {
+            this->consultarResultado(req, res);
+        });
+        
+        // Contagem por intervalo de bytes ou de linhas de um documento já processado
+        servidor.Get("/documentos/([0-9a-fA-F]+)/contagem", [this](const httplib::Request& req, httplib::Response& res) {
+            this->consultarIntervalo(req, res);
+        });
+        
+        // Rota de health check
+        servidor.Get("/health", [this](const httplib::Request&, httplib::Response& res) {
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, estadoSaude()), "application/json");
+        });
+    }
+    
+    Json::Value estadoSaude() const {
+        Json::Value resposta;
+        resposta["status"] = "ok";
+        resposta["servico"] = "mestre";
+        resposta["escravos"]["letras"] = escravosLetras.estado();
+        resposta["escravos"]["numeros"] = escravosNumeros.estado();
+        resposta["escravos"]["palavras"] = escravosPalavras.estado();
+        resposta["cache_fragmentos"] = cacheFragmentos.estado();
+        resposta["alocacoes"] = alocacoes.estado();
+        resposta["armazem_resultados"] = armazem.estado();
+        resposta["indices_posicionais"] = indices.estado();
+        resposta["afinidade"] = AfinidadeCpu::instancia().estado();
+        return resposta;
+    }
+    
+    ArmazemResultados& armazemResultados() {
+        return armazem;
+    }
+    
+    IndicesDocumentos& indicesDocumentos() {
+        return indices;
+    }
+    
+    void zerarAlocacoes() {
+        alocacoes.zerar();
+    }
+    
+    // Corpo: {"tipo": "letras", "host": "escravo1", "porta": 8081, "carga": {"em_andamento": 0}}
+    void atualizarMembro(const httplib::Request& req, httplib::Response& res, const std::string& operacao) {
+        Json::Value requestJson;
+        if (!lerJson(req.body, requestJson)) {
+            res.status = 400;
+            res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+            return;
+        }
+        
+        GrupoReplicas* grupo = grupoPorTipo(requestJson["tipo"].asString());
+        std::string host = requestJson["host"].asString();
+        int porta = requestJson["porta"].asInt();
+        if (!grupo || host.empty() || porta <= 0) {
+            res.status = 400;
+            res.set_content("{\"erro\": \"tipo, host ou porta inválidos\"}", "application/json");
+            return;
+        }
+        
+        Json::Value resposta;
+        if (operacao == "registrar") {
+            if (grupo->registrar(host, porta)) {
+                std::cout << "Réplica " << host << ":" << porta << " registrada em " << grupo->nome() << std::endl;
+            }
+            resposta["status"] = "registrado";
+            resposta["expiracao_ms"] = Json::Value::Int64(expiracaoMembroMs);
+        } else if (operacao == "heartbeat") {
+            int carga = requestJson["carga"]["em_andamento"].asInt();
+            if (!grupo->heartbeat(host, porta, carga)) {
+                // Membro desconhecido (expirou, o Mestre reiniciou ou o registro caiu em outro
+                // processo da mesma porta): o heartbeat vale como registro
+                grupo->registrar(host, porta);
+                grupo->heartbeat(host, porta, carga);
+                std::cout << "Réplica " << host << ":" << porta << " registrada em " << grupo->nome()
+                         << " via heartbeat" << std::endl;
+            }
+            resposta["status"] = "ok";
+        } else {
+            if (grupo->remover(host, porta)) {
+                std::cout << "Réplica " << host << ":" << porta << " saiu de " << grupo->nome() << std::endl;
+            }
+            resposta["status"] = "desregistrado";
+        }
+        
+        Json::StreamWriterBuilder builder;
+        res.set_content(Json::writeString(builder, resposta), "application/json");
+    }
+    
+    void iniciarExpiracao() {
+        ativo = true;
+        threadExpiracao = std::thread([this]() {
+            while (ativo) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                for (GrupoReplicas* grupo : {&escravosLetras, &escravosNumeros, &escravosPalavras}) {
+                    grupo->removerExpiradas(expiracaoMembroMs);
+                }
+            }
+        });
+    }
+    
+    void pararExpiracao() {
+        ativo = false;
+        if (threadExpiracao.joinable()) {
+            threadExpiracao.join();
+        }
+    }
+    
+    // Expiração de membros, abertura do armazém (flock por processo) e compactação em segundo plano
+    void iniciarTarefasFundo() {
+        iniciarExpiracao();
+        if (armazem.abrir()) {
+            armazem.iniciarCompactacao();
+        }
+        indices.abrir();
+    }
+    
+    void pararTarefasFundo() {
+        pararExpiracao();
+        armazem.pararCompactacao();
+    }
+    
+    // Hash de conteúdo vindo da URL: 32 dígitos hexadecimais, normalizado para minúsculas
+    static bool normalizarHash(std::string& hash, httplib::Response& res) {
+        bool valido = hash.size() == 32 &&
+                      std::all_of(hash.begin(), hash.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+        if (!valido) {
+            res.status = 400;
+            res.set_content("{\"erro\": \"hash inválido: esperados 32 dígitos hexadecimais\"}", "application/json");
+            return false;
+        }
+        std::transform(hash.begin(), hash.end(), hash.begin(), [](char c) { return std::tolower(static_cast<unsigned char>(c)); });
+        return true;
+    }
+    
+    // GET /resultados/<hash> -> {"hash", "letras", "numeros", "bytes", "timestamp"}
+    void consultarResultado(const httplib::Request& req, httplib::Response& res) {
+        static const std::string prefixo = "/resultados/";
+        std::string hash = req.path.size() > prefixo.size() ? req.path.substr(prefixo.size()) : "";
+        if (!normalizarHash(hash, res)) {
+            return;
+        }
+        
+        ArmazemResultados::Resultado resultado;
+        if (!armazem.buscar(hash, resultado)) {
+            res.status = 404;
+            res.set_content(armazem.ativo() ? "{\"erro\": \"resultado não encontrado\"}"
+                                            : "{\"erro\": \"armazém de resultados desativado\"}",
+                            "application/json");
+            return;
+        }
+        Json::Value resposta;
+        resposta["hash"] = hash;
+        resposta["letras"] = Json::Value::UInt64(resultado.letras);
+        resposta["numeros"] = Json::Value::UInt64(resultado.numeros);
+        resposta["bytes"] = Json::Value::UInt64(resultado.bytes);
+        resposta["timestamp"] = Json::Value::Int64(resultado.timestamp);
+        res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+    }
+    
+    // GET /documentos/<hash>/contagem?classe=letras,numeros&inicio=0&tamanho=4096
+    //  ou ?linha_inicio=10&linhas=50 (linhas contadas a partir de 0)
+    void consultarIntervalo(const httplib::Request& req, httplib::Response& res) {
+        static const std::string prefixo = "/documentos/";
+        static const std::string sufixo = "/contagem";
+        std::string hash;
+        if (req.path.size() > prefixo.size() + sufixo.size()) {
+            hash = req.path.substr(prefixo.size(), req.path.size() - prefixo.size() - sufixo.size());
+        }
+        if (!normalizarHash(hash, res)) {
+            return;
+        }
+        
+        auto erro = [&](int status, const std::string& mensagem) {
+            Json::Value e;
+            e["erro"] = mensagem;
+            res.status = status;
+            res.set_content(Json::writeString(escritorJson(), e), "application/json");
+        };
+        
+        try {
+            auto indice = indices.buscar(hash);
+            if (!indice) {
+                erro(404, indices.ativo() ? "documento sem índice posicional: envie o texto a /processar"
+                                          : "índices posicionais desativados");
+                return;
+            }
+            
+            // Parâmetros numéricos: ausente = padrão; qualquer coisa além de dígitos, ou um valor
+            // que não cabe em 64 bits, é erro
+            auto numero = [&](const char* nome, uint64_t padrao) {
+                if (!req.has_param(nome)) {
+                    return padrao;
+                }
+                std::string valor = req.get_param_value(nome);
+                uint64_t resultado = 0;
+                auto [fim, codigo] = std::from_chars(valor.data(), valor.data() + valor.size(), resultado);
+                if (codigo != std::errc() || fim != valor.data() + valor.size()) {
+                    throw std::invalid_argument(std::string("parâmetro ") + nome + " deve ser um inteiro não negativo de até 64 bits");
+                }
+                return resultado;
+            };
+            
+            std::vector<IndicePosicional::Classe> classes;
+            std::string lista = req.has_param("classe") ? req.get_param_value("classe") : "letras,numeros";
+            size_t inicioNome = 0;
+            while (inicioNome <= lista.size()) {
+                size_t fimNome = std::min(lista.find(',', inicioNome), lista.size());
+                std::string nome = lista.substr(inicioNome, fimNome - inicioNome);
+                size_t c = 0;
+                while (c < IndicePosicional::numClasses && nome != IndicePosicional::nomeClasse(c)) ++c;
+                if (c == IndicePosicional::numClasses) {
+                    erro(400, "classe desconhecida: " + nome + " (use letras, numeros ou linhas)");
+                    return;
+                }
+                classes.push_back(static_cast<IndicePosicional::Classe>(c));
+                inicioNome = fimNome + 1;
+            }
+            
+            Json::Value resposta;
+            uint64_t inicio = 0;
+            uint64_t fim = 0;
+            if (req.has_param("linha_inicio")) {
+                uint64_t linhaInicio = numero("linha_inicio", 0);
+                uint64_t linhas = numero("linhas", 1);
+                uint64_t linhaFim = linhas > UINT64_MAX - linhaInicio ? UINT64_MAX : linhaInicio + linhas;
+                if (linhaInicio >= indice->linhas() && !(linhaInicio == 0 && indice->linhas() == 0)) {
+                    erro(400, "linha_inicio além do fim do documento (" + std::to_string(indice->linhas()) + " linhas)");
+                    return;
+                }
+                inicio = indice->inicioLinha(linhaInicio);
+                fim = indice->inicioLinha(linhaFim);
+                resposta["linha_inicio"] = Json::Value::UInt64(linhaInicio);
+                resposta["linha_fim"] = Json::Value::UInt64(std::min(linhaFim, indice->linhas()));
+            } else {
+                inicio = numero("inicio", 0);
+                if (inicio > indice->tamanho()) {
+                    erro(400, "inicio além do fim do documento (" + std::to_string(indice->tamanho()) + " bytes)");
+                    return;
+                }
+                uint64_t tamanho = numero("tamanho", indice->tamanho() - inicio);
+                fim = inicio + std::min(tamanho, indice->tamanho() - inicio);
+            }
+            
+            resposta["hash"] = hash;
+            resposta["inicio"] = Json::Value::UInt64(inicio);
+            resposta["fim"] = Json::Value::UInt64(fim);
+            resposta["tamanho_documento"] = Json::Value::UInt64(indice->tamanho());
+            resposta["linhas_documento"] = Json::Value::UInt64(indice->linhas());
+            for (auto classe : classes) {
+                resposta["contagens"][IndicePosicional::nomeClasse(classe)] =
+                    Json::Value::UInt64(indice->contar(classe, inicio, fim));
+            }
+            res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+            
+        } catch (const std::invalid_argument& e) {
+            erro(400, e.what());
+        } catch (const std::exception& e) {
+            std::cerr << "Erro na consulta por intervalo: " << e.what() << std::endl;
+            erro(500, e.what());
+        }
+    }
+    
+    bool verificarSaudeEscravo(const std::string& host, int port) {
+        httplib::Client client(host, port);
+        auto resposta = client.Get("/health");
+        
+        if (!resposta || resposta->status != 200) {
+            std::cout << "Escravo " << host << " não está disponível!" << std::endl;
+            return false;
+        }
+        
+        std::cout << "Escravo " << host << " está saudável" << std::endl;
+        return true;
+    }
+    
+    // Escolhe uma réplica saudável do grupo segundo a política de balanceamento
+    std::shared_ptr<Replica> escolherReplicaSaudavel(GrupoReplicas& grupo) {
+        size_t tentativas = std::max<size_t>(1, grupo.membros()->size());
+        for (size_t i = 0; i < tentativas; ++i) {
+            auto replica = grupo.escolher();
+            if (verificarSaudeEscravo(replica->host, replica->port)) {
+                return replica;
+            }
+            replica->registrarFalha(0.0);
+        }
+        throw std::runtime_error(grupo.nome() + " não disponível");
+    }
+    
+    Json::Value enviarParaReplica(GrupoReplicas& grupo, const std::string& rota, const Json::Value& requestJson,
+                                  Rastro& rastro) {
+        auto medicaoSerializacao = rastro.medir(rota.substr(1) + ".serializacao");
+        std::string jsonString = Json::writeString(escritorJson(), requestJson);
+        medicaoSerializacao.encerrar();
+        
+        return enviarCorpoParaReplica(grupo, rota, jsonString, rastro);
+    }
+    
+    // Corpo já serializado (ex.: na arena da requisição), compartilhável entre vários escravos
+    Json::Value enviarCorpoParaReplica(GrupoReplicas& grupo, const std::string& rota, std::string_view corpo,
+                                       Rastro& rastro) {
+        std::string etapa = rota.substr(1);
+        
+        auto medicaoSaude = rastro.medir(etapa + ".saude");
+        auto replica = escolherReplicaSaudavel(grupo);
+        medicaoSaude.encerrar();
+        
+        return enviarCorpoParaReplica(grupo, replica, rota, corpo, rastro);
+    }
+    
+    // Envio para uma réplica já escolhida (sem health check nem política)
+    Json::Value enviarCorpoParaReplica(GrupoReplicas& grupo, const std::shared_ptr<Replica>& replica,
+                                       const std::string& rota, std::string_view corpo, Rastro& rastro) {
+        std::string etapa = rota.substr(1);
+        ReservaReplica reserva(replica);
+        
+        httplib::Client client(replica->host, replica->port);
+        
+        httplib::Headers cabecalhos = {
+            {cabecalhoRequestId, rastro.id()},
+            {cabecalhoAmostrado, rastro.amostra() ? "1" : "0"}
+        };
+        auto inicioIdaEVolta = std::chrono::steady_clock::now();
+        auto resposta = client.Post(rota, cabecalhos, corpo.data(), corpo.size(), "application/json");
+        auto fimIdaEVolta = std::chrono::steady_clock::now();
+        
+        if (!resposta || resposta->status != 200) {
+            throw std::runtime_error("Erro na comunicação com " + grupo.nome() + " em " + replica->endereco());
+        }
+        
+        auto medicaoParse = rastro.medir(etapa + ".parse_resposta");
+        Json::Value resultado;
+        if (!lerJson(resposta->body, resultado)) {
+            throw std::runtime_error("Erro ao parsear resposta do " + grupo.nome());
+        }
+        medicaoParse.encerrar();
+        
+        registrarTemposEscravo(etapa, resultado, inicioIdaEVolta, fimIdaEVolta, rastro);
+        
+        reserva.concluir();
+        return resultado;
+    }
+    
+    // Ida e volta = rede + tempo informado pelo escravo; a parte do escravo é
+    // posicionada no meio do intervalo (rede simétrica) para a visualização
+    static void registrarTemposEscravo(const std::string& etapa, const Json::Value& resultado,
+                                       std::chrono::steady_clock::time_point inicioIdaEVolta,
+                                       std::chrono::steady_clock::time_point fimIdaEVolta, Rastro& rastro) {
+        double idaEVoltaMs = std::chrono::duration<double, std::milli>(fimIdaEVolta - inicioIdaEVolta).count();
+        double escravoMs = std::min(idaEVoltaMs, resultado["timings"]["total_ms"].asDouble());
+        double redeMs = idaEVoltaMs - escravoMs;
+        rastro.registrar(etapa + ".ida_e_volta", inicioIdaEVolta, fimIdaEVolta);
+        rastro.registrarDuracao(etapa + ".rede", inicioIdaEVolta, redeMs);
+        rastro.registrarDuracao(etapa + ".escravo",
+                                inicioIdaEVolta + std::chrono::microseconds(static_cast<int64_t>(redeMs * 500.0)),
+                                escravoMs);
+        for (const auto& nome : resultado["timings"]["etapas"].getMemberNames()) {
+            rastro.registrarDuracao(etapa + ".escravo." + nome, inicioIdaEVolta,
+                                    resultado["timings"]["etapas"][nome].asDouble());
+        }
+    }
+    
+    // O corpo pertence à arena da requisição, que espera o future antes de ser liberada.
+    // A thread de envio fica no nó NUMA da chamadora, onde o corpo foi alocado.
+    std::future<Json::Value> enviarCorpoEmParalelo(GrupoReplicas& grupo, const std::string& rota,
+                                                   std::string_view corpo, Rastro& rastro) {
+        int no = AfinidadeCpu::instancia().noAtual();
+        return std::async(std::launch::async, [this, &grupo, rota, corpo, &rastro, no]() {
+            AfinidadeCpu::instancia().fixarThreadAtual("fanout", no);
+            MedidorAlocacoes::Medicao medicaoAlocacoes(alocacoes, false);
+            return enviarCorpoParaReplica(grupo, rota, corpo, rastro);
+        });
+    }
+    
+    std::future<Json::Value> enviarParaEscravoLetras(std::string_view corpo, Rastro& rastro) {
+        return enviarCorpoEmParalelo(escravosLetras, "/letras", corpo, rastro);
+    }
+    
+    std::future<Json::Value> enviarParaEscravoNumeros(std::string_view corpo, Rastro& rastro) {
+        return enviarCorpoEmParalelo(escravosNumeros, "/numeros", corpo, rastro);
+    }
+    
+    // Reaproveita o id recebido do cliente (se houver) e sorteia a amostragem do trace
+    static std::string idRequisicao(const httplib::Request& req) {
+        return idRequisicaoRecebido(req.get_header_value(cabecalhoRequestId));
+    }
+    
+    static bool pediuTimings(const httplib::Request& req, const Json::Value& requestJson) {
+        return requestJson.get("timings", false).asBool() || req.get_param_value("timings") == "1";
+    }
+    
+    // Conta uma rodada de blocos sorteados: os blocos são repartidos em até
+    // amostragemParalelismo lotes {"fragmentos": [...]}, cada um enviado aos dois escravos
+    void contarBlocos(AmostragemAproximada& amostragem, const std::vector<AmostragemAproximada::Bloco>& blocos,
+                      const char* texto, Rastro& rastro) {
+        size_t numLotes = std::min(amostragemParalelismo, blocos.size());
+        std::vector<std::string> lotes(numLotes);
+        for (size_t l = 0; l < numLotes; ++l) {
+            size_t inicio = blocos.size() * l / numLotes;
+            size_t fim = blocos.size() * (l + 1) / numLotes;
+            std::string& lote = lotes[l];
+            lote.reserve((fim - inicio) * (amostragem.configuracao().blocoBytes * 9 / 8 + 4) + 32);
+            lote += "{\"fragmentos\":[";
+            for (size_t i = inicio; i < fim; ++i) {
+                if (i > inicio) lote += ',';
+                anexarJsonString(lote, texto + blocos[i].inicio, blocos[i].tamanho);
+            }
+            lote += "]}";
+        }
+        
+        std::vector<std::future<Json::Value>> futuresLetras;
+        std::vector<std::future<Json::Value>> futuresNumeros;
+        for (const auto& lote : lotes) {
+            futuresLetras.push_back(enviarParaEscravoLetras(lote, rastro));
+            futuresNumeros.push_back(enviarParaEscravoNumeros(lote, rastro));
+        }
+        // Todos os futures são esperados antes de um erro sair daqui: os lotes pertencem a eles
+        std::vector<Json::Value> letras(numLotes);
+        std::vector<Json::Value> numeros(numLotes);
+        std::string erro;
+        for (size_t l = 0; l < numLotes; ++l) {
+            try {
+                letras[l] = futuresLetras[l].get()["quantidades"];
+            } catch (const std::exception& e) {
+                erro = e.what();
+            }
+            try {
+                numeros[l] = futuresNumeros[l].get()["quantidades"];
+            } catch (const std::exception& e) {
+                erro = e.what();
+            }
+        }
+        if (!erro.empty()) {
+            throw std::runtime_error(erro);
+        }
+        
+        for (size_t l = 0; l < numLotes; ++l) {
+            size_t inicio = blocos.size() * l / numLotes;
+            size_t fim = blocos.size() * (l + 1) / numLotes;
+            if (letras[l].size() != fim - inicio || numeros[l].size() != fim - inicio) {
+                throw std::runtime_error("Escravo não devolveu as quantidades por fragmento");
+            }
+            for (size_t i = inicio; i < fim; ++i) {
+                Json::ArrayIndex k = static_cast<Json::ArrayIndex>(i - inicio);
+                amostragem.registrar(blocos[i], letras[l][k].asUInt64(), numeros[l][k].asUInt64());
+            }
+        }
+    }
+    
+    // Modo aproximado de /processar (ver AmostragemAproximada.h). Sem consulta ao armazém: o hash
+    // leria o texto inteiro antes do primeiro bloco sorteado, dentro do orçamento de tempo_ms.
+    // Estimativas não vão para o armazém nem para o índice.
+    // Parâmetros inválidos lançam std::invalid_argument (400).
+    Json::Value processarAproximado(const Json::Value& pedido, const char* texto, size_t tamanho, Rastro& rastro) {
+        auto inicio = std::chrono::steady_clock::now();
+        AmostragemAproximada::Parametros parametros = AmostragemAproximada::lerParametros(pedido, parametrosAmostragem);
+        
+        AmostragemAproximada amostragem(texto, tamanho, parametros);
+        std::cout << "Processando texto de " << tamanho << " caracteres por amostragem (" << amostragem.blocos()
+                 << " blocos, erro " << parametros.erroRelativo << ", request " << rastro.id() << ")..." << std::endl;
+        
+        auto decorridoMs = [&]() {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+        };
+        
+        size_t proximos = amostragem.blocosNecessarios();
+        size_t rodadas = 0;
+        std::string motivo;
+        while (true) {
+            auto inicioRodada = std::chrono::steady_clock::now();
+            auto medicaoRodada = rastro.medir("amostragem.rodada" + std::to_string(rodadas));
+            auto blocos = amostragem.sortear(proximos);
+            contarBlocos(amostragem, blocos, texto, rastro);
+            medicaoRodada.encerrar();
+            rodadas++;
+            
+            if (amostragem.completo()) {
+                motivo = "completo";
+                break;
+            }
+            if (amostragem.atingiuErro()) {
+                motivo = "erro";
+                break;
+            }
+            
+            // A variância do piloto é ruidosa: cada rodada cresce no máximo 4x antes de reavaliar
+            size_t necessarios = amostragem.blocosNecessarios();
+            size_t faltam = necessarios > amostragem.amostrados() ? necessarios - amostragem.amostrados() : 0;
+            proximos = std::clamp<size_t>(faltam, std::max<size_t>(1, amostragem.amostrados() / 4),
+                                          amostragem.amostrados() * 4);
+            
+            // Orçamento de tempo: a próxima rodada só cabe no que resta, ao ritmo da última
+            if (parametros.tempoMs > 0) {
+                double restanteMs = parametros.tempoMs - decorridoMs();
+                double rodadaMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - inicioRodada).count();
+                double msPorBloco = std::max(rodadaMs / std::max<size_t>(1, blocos.size()), 1e-6);
+                size_t cabem = restanteMs > 0 ? static_cast<size_t>(restanteMs / msPorBloco) : 0;
+                if (cabem == 0) {
+                    motivo = "tempo";
+                    break;
+                }
+                proximos = std::min(proximos, cabem);
+            }
+        }
+        
+        Json::Value letras = amostragem.intervalo(AmostragemAproximada::Letras);
+        Json::Value numeros = amostragem.intervalo(AmostragemAproximada::Numeros);
+        Json::Value resposta;
+        resposta["letras"] = Json::Value::UInt64(static_cast<uint64_t>(std::llround(letras["estimativa"].asDouble())));
+        resposta["numeros"] = Json::Value::UInt64(static_cast<uint64_t>(std::llround(numeros["estimativa"].asDouble())));
+        resposta["aproximado"] = motivo != "completo";
+        resposta["intervalos"]["letras"] = letras;
+        resposta["intervalos"]["numeros"] = numeros;
+        resposta["confianca"] = parametros.confianca;
+        resposta["erro_alvo"] = parametros.erroRelativo;
+        resposta["motivo"] = motivo;
+        resposta["amostra"]["blocos"] = Json::Value::UInt64(amostragem.amostrados());
+        resposta["amostra"]["blocos_total"] = Json::Value::UInt64(amostragem.blocos());
+        resposta["amostra"]["bloco_bytes"] = Json::Value::UInt64(parametros.blocoBytes);
+        resposta["amostra"]["bytes"] = Json::Value::UInt64(amostragem.bytes());
+        resposta["amostra"]["fracao"] = tamanho > 0 ? static_cast<double>(amostragem.bytes()) / tamanho : 1.0;
+        resposta["amostra"]["rodadas"] = Json::Value::UInt64(rodadas);
+        resposta["tempo_ms"] = decorridoMs();
+        resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+        
+        std::cout << "Amostragem concluída (" << motivo << "): ~" << resposta["letras"].asUInt64() << " letras, ~"
+                 << resposta["numeros"].asUInt64() << " números com " << amostragem.amostrados() << " de "
+                 << amostragem.blocos() << " blocos" << std::endl;
+        return resposta;
+    }
+    
+    void processarTexto(const httplib::Request& req, httplib::Response& res) {
+        MedidorAlocacoes::Medicao medicaoAlocacoes(alocacoes);
+        ArenaRequisicao arena;
+        Rastro rastro(idRequisicao(req), "mestre", GravadorTrace::instancia().sortearAmostra());
+        res.set_header(cabecalhoRequestId, rastro.id());
+        
+        try {
+            // Parse do JSON recebido; o texto é lido direto do Json::Value, sem cópia
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            
+            const char* texto = "";
+            const char* fimTexto = texto;
+            if (requestJson["texto"].isString()) {
+                requestJson["texto"].getString(&texto, &fimTexto);
+            }
+            medicaoParse.encerrar();
+            
+            if (requestJson.isMember("aproximado") && requestJson["aproximado"] != false) {
+                Json::Value resposta = processarAproximado(requestJson["aproximado"], texto, fimTexto - texto, rastro);
+                if (pediuTimings(req, requestJson)) {
+                    resposta["timings"] = rastro.timings();
+                }
+                res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+                return;
+            }
+            
+            // Texto já processado antes (inclusive antes de um reinício): responde do armazém
+            auto medicaoArmazem = rastro.medir("armazem");
+            std::string hash = hashConteudo(texto, fimTexto - texto);
+            ArmazemResultados::Resultado armazenado;
+            bool encontrado = armazem.buscar(hash, armazenado);
+            medicaoArmazem.encerrar();
+            if (encontrado) {
+                // Documento armazenado antes dos índices (ou com o índice já descartado): indexa agora
+                auto medicaoIndice = rastro.medir("indice");
+                indices.indexar(hash, texto, fimTexto - texto);
+                medicaoIndice.encerrar();
+                
+                Json::Value resposta;
+                resposta["letras"] = Json::Value::UInt64(armazenado.letras);
+                resposta["numeros"] = Json::Value::UInt64(armazenado.numeros);
+                resposta["timestamp"] = Json::Value::Int64(armazenado.timestamp);
+                resposta["hash"] = hash;
+                resposta["armazenado"] = true;
+                if (pediuTimings(req, requestJson)) {
+                    resposta["timings"] = rastro.timings();
+                }
+                res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+                std::cout << "Resultado armazenado reaproveitado para " << hash << " (request "
+                         << rastro.id() << ")" << std::endl;
+                return;
+            }
+            std::cout << "Processando texto de " << fimTexto - texto << " caracteres (request "
+                     << rastro.id() << ")..." << std::endl;
+            
+            // Um único corpo para os dois escravos, montado na arena da requisição
+            auto medicaoSerializacao = rastro.medir("serializacao");
+            std::pmr::string corpo(arena.memoria());
+            corpo.reserve((fimTexto - texto) + (fimTexto - texto) / 8 + 16);
+            corpo += "{\"texto\":";
+            anexarJsonString(corpo, texto, fimTexto - texto);
+            corpo += '}';
+            medicaoSerializacao.encerrar();
+            
+            // Dispara as duas threads em paralelo
+            auto medicaoFanout = rastro.medir("fanout");
+            auto futureLetras = enviarParaEscravoLetras(corpo, rastro);
+            auto futureNumeros = enviarParaEscravoNumeros(corpo, rastro);
+            
+            // O índice posicional é construído enquanto os escravos contam
+            auto medicaoIndice = rastro.medir("indice");
+            indices.indexar(hash, texto, fimTexto - texto);
+            medicaoIndice.encerrar();
+            
+            // Aguarda os resultados
+            uint64_t quantidadeLetras = futureLetras.get()["quantidade"].asUInt64();
+            uint64_t quantidadeNumeros = futureNumeros.get()["quantidade"].asUInt64();
+            medicaoFanout.encerrar();
+            
+            std::time_t agora = std::time(nullptr);
+            armazem.gravar(hash, {quantidadeLetras, quantidadeNumeros,
+                                  static_cast<uint64_t>(fimTexto - texto), static_cast<int64_t>(agora)});
+            
+            // Constrói resposta consolidada
+            Json::Value resposta;
+            resposta["letras"] = Json::Value::UInt64(quantidadeLetras);
+            resposta["numeros"] = Json::Value::UInt64(quantidadeNumeros);
+            resposta["timestamp"] = agora;
+            resposta["hash"] = hash;
+            if (pediuTimings(req, requestJson)) {
+                resposta["timings"] = rastro.timings();
+            }
+            
+            res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+            
+            std::cout << "Processamento concluído: " << quantidadeLetras 
+                     << " letras, " << quantidadeNumeros << " números" << std::endl;
+            
+        } catch (const std::invalid_argument& e) {
+            Json::Value erro;
+            erro["erro"] = e.what();
+            res.status = 400;
+            res.set_content(Json::writeString(escritorJson(), erro), "application/json");
+        } catch (const std::exception& e) {
+            std::cerr << "Erro no processamento: " << e.what() << std::endl;
+            
+            Json::Value erro;
+            erro["erro"] = e.what();
+            
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+    
+    // Estado de um /processar/stream: pertence ao content provider e vive depois do handler
+    struct ProcessamentoStream {
+        std::string texto;
+        std::string hash;
+        size_t fragmentos = 0;
+        Rastro rastro;
+        std::atomic<size_t> proximaTarefa{0};
+        std::atomic<bool> cancelado{false};
+        std::vector<std::thread> threads;
+        
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::string> eventos;
+        bool encerrado = false; // último evento (resultado ou erro) já está na fila
+        size_t concluidas = 0;
+        uint64_t letras = 0;
+        uint64_t numeros = 0;
+        
+        ProcessamentoStream(std::string idRequisicao, bool amostra)
+            : rastro(std::move(idRequisicao), "mestre", amostra) {}
+        
+        // Cliente desconectado: threads terminam a tarefa em voo e não pegam outra
+        ~ProcessamentoStream() {
+            cancelado = true;
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    };
+    
+    static std::string eventoSse(const char* nome, const Json::Value& dados) {
+        return std::string("event: ") + nome + "\ndata: " + Json::writeString(escritorJson(), dados) + "\n\n";
+    }
+    
+    // Cada fragmento do texto é uma tarefa para letras e outra para números; cada tarefa
+    // concluída vira um evento "parcial" com os totais acumulados até ali
+    void executarTarefasStream(ProcessamentoStream& estado) {
+        size_t totalTarefas = estado.fragmentos * 2;
+        for (size_t t = estado.proximaTarefa++; t < totalTarefas && !estado.cancelado; t = estado.proximaTarefa++) {
+            size_t fragmento = t / 2;
+            bool ehLetras = t % 2 == 0;
+            size_t inicio = std::min(estado.texto.size(), fragmento * streamFragmentoBytes);
+            size_t tamanho = std::min(streamFragmentoBytes, estado.texto.size() - inicio);
+            std::string corpo;
+            corpo.reserve(tamanho + tamanho / 8 + 16);
+            corpo += "{\"texto\":";
+            anexarJsonString(corpo, estado.texto.data() + inicio, tamanho);
+            corpo += '}';
+            
+            uint64_t quantidade = 0;
+            std::string erro;
+            try {
+                Json::Value resultado = ehLetras
+                    ? enviarCorpoParaReplica(escravosLetras, "/letras", corpo, estado.rastro)
+                    : enviarCorpoParaReplica(escravosNumeros, "/numeros", corpo, estado.rastro);
+                quantidade = resultado["quantidade"].asUInt64();
+            } catch (const std::exception& e) {
+                erro = e.what();
+            }
+            
+            std::lock_guard<std::mutex> lock(estado.mutex);
+            if (estado.encerrado) {
+                return;
+            }
+            if (!erro.empty()) {
+                std::cerr << "Erro no processamento em stream: " << erro << std::endl;
+                Json::Value dados;
+                dados["erro"] = erro;
+                estado.eventos.push_back(eventoSse("erro", dados));
+                estado.encerrado = true;
+                estado.cancelado = true;
+                estado.cv.notify_all();
+                return;
+            }
+            (ehLetras ? estado.letras : estado.numeros) += quantidade;
+            estado.concluidas++;
+            
+            Json::Value parcial;
+            parcial["tipo"] = ehLetras ? "letras" : "numeros";
+            parcial["fragmento"] = Json::Value::UInt64(fragmento);
+            parcial["quantidade"] = Json::Value::UInt64(quantidade);
+            parcial["letras"] = Json::Value::UInt64(estado.letras);
+            parcial["numeros"] = Json::Value::UInt64(estado.numeros);
+            parcial["progresso"] = static_cast<double>(estado.concluidas) / totalTarefas;
+            estado.eventos.push_back(eventoSse("parcial", parcial));
+            
+            if (estado.concluidas == totalTarefas) {
+                int64_t agora = std::time(nullptr);
+                armazem.gravar(estado.hash, {estado.letras, estado.numeros, estado.texto.size(), agora});
+                Json::Value resposta;
+                resposta["letras"] = Json::Value::UInt64(estado.letras);
+                resposta["numeros"] = Json::Value::UInt64(estado.numeros);
+                resposta["timestamp"] = Json::Value::Int64(agora);
+                resposta["hash"] = estado.hash;
+                resposta["fragmentos"] = Json::Value::UInt64(estado.fragmentos);
+                estado.eventos.push_back(eventoSse("resultado", resposta));
+                estado.encerrado = true;
+                std::cout << "Processamento em stream concluído: " << estado.letras << " letras, "
+                         << estado.numeros << " números" << std::endl;
+            }
+            estado.cv.notify_all();
+        }
+    }
+    
+    // Resposta text/event-stream: "parcial" a cada fragmento concluído por um escravo e, no fim,
+    // "resultado" (mesmos campos de /processar) ou "erro"
+    void processarTextoStream(const httplib::Request& req, httplib::Response& res) {
+        auto estado = std::make_shared<ProcessamentoStream>(idRequisicao(req), GravadorTrace::instancia().sortearAmostra());
+        res.set_header(cabecalhoRequestId, estado->rastro.id());
+        
+        try {
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            
+            estado->texto = requestJson["texto"].asString();
+            estado->hash = hashConteudo(estado->texto);
+            estado->fragmentos = std::max<size_t>(1, (estado->texto.size() + streamFragmentoBytes - 1) / streamFragmentoBytes);
+            res.set_header("Cache-Control", "no-cache");
+            
+            ArmazemResultados::Resultado armazenado;
+            if (armazem.buscar(estado->hash, armazenado)) {
+                indices.indexar(estado->hash, estado->texto.data(), estado->texto.size());
+                Json::Value resposta;
+                resposta["letras"] = Json::Value::UInt64(armazenado.letras);
+                resposta["numeros"] = Json::Value::UInt64(armazenado.numeros);
+                resposta["timestamp"] = Json::Value::Int64(armazenado.timestamp);
+                resposta["hash"] = estado->hash;
+                resposta["armazenado"] = true;
+                res.set_content(eventoSse("resultado", resposta), "text/event-stream");
+                return;
+            }
+            
+            std::cout << "Processando texto de " << estado->texto.size() << " caracteres em stream ("
+                     << estado->fragmentos << " fragmentos, request " << estado->rastro.id() << ")..." << std::endl;
+            for (size_t t = 0; t < std::min(streamParalelismo, estado->fragmentos * 2); ++t) {
+                estado->threads.emplace_back([this, e = estado.get(), no = AfinidadeCpu::instancia().noAtual()]() {
+                    AfinidadeCpu::instancia().fixarThreadAtual("stream", no);
+                    executarTarefasStream(*e);
+                });
+            }
+            {
+                auto medicaoIndice = estado->rastro.medir("indice");
+                indices.indexar(estado->hash, estado->texto.data(), estado->texto.size());
+            }
+            
+            res.set_chunked_content_provider("text/event-stream", [estado](size_t, httplib::DataSink& sink) {
+                std::unique_lock<std::mutex> lock(estado->mutex);
+                estado->cv.wait(lock, [&]() { return !estado->eventos.empty(); });
+                while (!estado->eventos.empty()) {
+                    std::string evento = std::move(estado->eventos.front());
+                    estado->eventos.pop_front();
+                    lock.unlock();
+                    if (!sink.write(evento.data(), evento.size())) {
+                        estado->cancelado = true;
+                        return false;
+                    }
+                    lock.lock();
+                }
+                if (estado->encerrado) {
+                    sink.done();
+                }
+                return true;
+            });
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Erro no processamento em stream: " << e.what() << std::endl;
+            
+            Json::Value erro;
+            erro["erro"] = e.what();
+            
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+    
+    // Corpo: {"manifesto": [{"hash": "...", "tamanho": N}, ...], "fragmentos": {"<hash>": "texto", ...}}
+    // Fragmentos já em cache não precisam ser enviados; se faltar algum, a resposta é
+    // {"completo": false, "faltando": [hash, ...]} e o cliente repete com esses fragmentos.
+    void processarIncremental(const httplib::Request& req, httplib::Response& res) {
+        MedidorAlocacoes::Medicao medicaoAlocacoes(alocacoes);
+        ArenaRequisicao arena;
+        Rastro rastro(idRequisicao(req), "mestre", GravadorTrace::instancia().sortearAmostra());
+        res.set_header(cabecalhoRequestId, rastro.id());
+        
+        try {
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            bool valido = lerJson(req.body, requestJson);
+            if (!valido || !requestJson["manifesto"].isArray()) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido ou sem manifesto\"}", "application/json");
+                return;
+            }
+            const Json::Value& manifesto = requestJson["manifesto"];
+            const Json::Value& enviados = requestJson["fragmentos"];
+            medicaoParse.encerrar();
+            
+            // Separa o que já está em cache do que precisa ser contado
+            auto medicaoCache = rastro.medir("cache");
+            std::unordered_map<std::string, CacheFragmentos::Contagem> conhecidos;
+            std::vector<std::string> novos;
+            std::vector<uint64_t> tamanhosNovos;
+            Json::Value faltando(Json::arrayValue);
+            uint64_t bytesNovos = 0;
+            for (const auto& item : manifesto) {
+                std::string hash = item["hash"].asString();
+                if (conhecidos.count(hash)) {
+                    continue;
+                }
+                CacheFragmentos::Contagem contagem;
+                if (cacheFragmentos.buscar(hash, contagem)) {
+                    conhecidos[hash] = contagem;
+                    continue;
+                }
+                // Fora do cache em memória (ex.: depois de um reinício): tenta o armazém em disco
+                ArmazemResultados::Resultado armazenado;
+                if (armazem.buscar(hash, armazenado)) {
+                    contagem = {armazenado.letras, armazenado.numeros};
+                    conhecidos[hash] = contagem;
+                    cacheFragmentos.inserir(hash, contagem);
+                    continue;
+                }
+                if (!enviados.isObject() || !enviados.isMember(hash)) {
+                    faltando.append(hash);
+                    conhecidos[hash] = {};
+                    continue;
+                }
+                const char* inicio = "";
+                const char* fim = inicio;
+                if (enviados[hash].isString()) {
+                    enviados[hash].getString(&inicio, &fim);
+                }
+                size_t tamanho = fim - inicio;
+                if (tamanho != item["tamanho"].asUInt64() || hashConteudo(inicio, tamanho) != hash) {
+                    res.status = 400;
+                    res.set_content("{\"erro\": \"fragmento não confere com o manifesto: " + hash + "\"}",
+                                    "application/json");
+                    return;
+                }
+                novos.push_back(hash);
+                tamanhosNovos.push_back(tamanho);
+                conhecidos[hash] = {};
+                bytesNovos += tamanho;
+            }
+            medicaoCache.encerrar();
+            
+            if (!faltando.empty()) {
+                Json::Value resposta;
+                resposta["completo"] = false;
+                resposta["faltando"] = faltando;
+                res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+                std::cout << "Incremental: faltam " << faltando.size() << " de " << manifesto.size()
+                         << " fragmentos (request " << rastro.id() << ")" << std::endl;
+                return;
+            }
+            
+            // Fragmentos novos vão em um único lote para cada tipo de escravo, serializado
+            // uma vez na arena da requisição
+            auto medicaoFanout = rastro.medir("fanout");
+            if (!novos.empty()) {
+                std::pmr::string lote(arena.memoria());
+                lote.reserve(bytesNovos + bytesNovos / 8 + novos.size() * 4 + 32);
+                lote += "{\"fragmentos\":[";
+                for (size_t i = 0; i < novos.size(); ++i) {
+                    const char* inicio = nullptr;
+                    const char* fim = nullptr;
+                    enviados[novos[i]].getString(&inicio, &fim);
+                    if (i > 0) lote += ',';
+                    anexarJsonString(lote, inicio, fim - inicio);
+                }
+                lote += "]}";
+                auto futureLetras = enviarParaEscravoLetras(lote, rastro);
+                auto futureNumeros = enviarParaEscravoNumeros(lote, rastro);
+                Json::Value letras = futureLetras.get()["quantidades"];
+                Json::Value numeros = futureNumeros.get()["quantidades"];
+                if (letras.size() != novos.size() || numeros.size() != novos.size()) {
+                    throw std::runtime_error("Escravo não devolveu as quantidades por fragmento");
+                }
+                int64_t agora = std::time(nullptr);
+                for (Json::ArrayIndex i = 0; i < novos.size(); ++i) {
+                    CacheFragmentos::Contagem contagem{letras[i].asUInt64(), numeros[i].asUInt64()};
+                    conhecidos[novos[i]] = contagem;
+                    cacheFragmentos.inserir(novos[i], contagem);
+                    armazem.gravar(novos[i], {contagem.letras, contagem.numeros, tamanhosNovos[i], agora});
+                }
+            }
+            medicaoFanout.encerrar();
+            
+            uint64_t totalLetras = 0;
+            uint64_t totalNumeros = 0;
+            for (const auto& item : manifesto) {
+                const auto& contagem = conhecidos[item["hash"].asString()];
+                totalLetras += contagem.letras;
+                totalNumeros += contagem.numeros;
+            }
+            
+            Json::Value resposta;
+            resposta["completo"] = true;
+            resposta["letras"] = Json::Value::UInt64(totalLetras);
+            resposta["numeros"] = Json::Value::UInt64(totalNumeros);
+            resposta["fragmentos_total"] = manifesto.size();
+            resposta["fragmentos_novos"] = Json::Value::UInt64(novos.size());
+            resposta["fragmentos_reaproveitados"] = Json::Value::UInt64(conhecidos.size() - novos.size());
+            resposta["bytes_processados"] = Json::Value::UInt64(bytesNovos);
+            resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+            if (pediuTimings(req, requestJson)) {
+                resposta["timings"] = rastro.timings();
+            }
+            
+            res.set_content(Json::writeString(escritorJson(), resposta), "application/json");
+            
+            std::cout << "Incremental concluído: " << novos.size() << " fragmentos novos, "
+                     << conhecidos.size() - novos.size() << " reaproveitados" << std::endl;
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Erro no processamento incremental: " << e.what() << std::endl;
+            
+            Json::Value erro;
+            erro["erro"] = e.what();
+            
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+    
+    void processarPalavras(const httplib::Request& req, httplib::Response& res) {
+        Rastro rastro(idRequisicao(req), "mestre", GravadorTrace::instancia().sortearAmostra());
+        res.set_header(cabecalhoRequestId, rastro.id());
+        
+        try {
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            if (!lerJson(req.body, requestJson)) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"JSON inválido\"}", "application/json");
+                return;
+            }
+            
+            // Mesmos limites do Escravo3, validados antes do fan-out: um valor inválido seria recusado
+            // por todas as réplicas e viraria "nenhuma réplica disponível"
+            Json::Value valorN = requestJson.get("n", 2);
+            Json::Value valorTop = requestJson.get("top", 10);
+            if (!valorN.isUInt() || valorN.asUInt() < 1 || valorN.asUInt() > 5) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"n deve estar entre 1 e 5\"}", "application/json");
+                return;
+            }
+            if (!valorTop.isUInt() || valorTop.asUInt() > topMaximoPalavras) {
+                res.status = 400;
+                res.set_content("{\"erro\": \"top deve estar entre 0 e " + std::to_string(topMaximoPalavras) + "\"}",
+                                "application/json");
+                return;
+            }
+            std::string texto = requestJson["texto"].asString();
+            unsigned n = valorN.asUInt();
+            unsigned top = valorTop.asUInt();
+            medicaoParse.encerrar();
+            
+            // Fragmentos com tamanho proporcional à vazão de cada réplica, cortados em espaço em
+            // branco; n-gramas que cruzam a fronteira entre dois fragmentos não são contados
+            auto medicaoFragmentacao = rastro.medir("fragmentacao");
+            auto replicas = escravosPalavras.membros();
+            if (replicas->empty()) {
+                throw std::runtime_error("Nenhuma réplica disponível para " + escravosPalavras.nome());
+            }
+            std::vector<double> vazoes;
+            for (const auto& replica : *replicas) {
+                vazoes.push_back(replica->vazaoEwmaBytesS.load(std::memory_order_relaxed));
+            }
+            PlanoFragmentos plano = planejarFragmentos(texto, vazoes, fragmentosPorReplica,
+                                                       fragmentoMinimoBytes, fragmentoMaximoBytes);
+            size_t totalFragmentos = plano.faixas.size();
+            // Com mais de um fragmento, cada um devolve mais candidatos que o top-K pedido
+            // para reduzir o erro da mescla de top-K parciais
+            unsigned candidatos = totalFragmentos > 1 ? top * 4 + 10 : top;
+            medicaoFragmentacao.encerrar();
+            
+            std::cout << "Processando palavras em texto de " << texto.length() << " caracteres ("
+                     << totalFragmentos << " fragmentos, " << replicas->size() << " réplicas)..." << std::endl;
+            
+            // Uma thread por réplica, presa a ela: consome a própria fila e, vazia, rouba das
+            // outras. Uma réplica que falha devolve o fragmento e sai; as demais o assumem,
+            // inclusive as que já esvaziaram as filas e aguardam os fragmentos em voo.
+            auto medicaoFanout = rastro.medir("fanout");
+            std::vector<Json::Value> parciais(totalFragmentos);
+            std::vector<char> concluidos(totalFragmentos, 0);
+            FilaFragmentos fila(plano, replicas->size());
+            Json::Value distribuicao(Json::arrayValue);
+            std::atomic<uint64_t> roubados{0};
+            std::mutex mutexErro;
+            std::string ultimoErro;
+            std::vector<std::future<void>> futures;
+            for (size_t r = 0; r < std::min(replicas->size(), totalFragmentos); ++r) {
+                futures.push_back(std::async(std::launch::async, [&, r, no = AfinidadeCpu::instancia().noAtual()]() {
+                    AfinidadeCpu::instancia().fixarThreadAtual("palavras", no);
+                    const auto& replica = (*replicas)[r];
+                    uint64_t bytes = 0;
+                    uint64_t feitos = 0;
+                    size_t i;
+                    bool roubado;
+                    while (fila.pegar(r, i, roubado)) {
+                        const FaixaTexto& faixa = plano.faixas[i];
+                        std::string corpo;
+                        corpo.reserve(faixa.tamanho() + faixa.tamanho() / 8 + 64);
+                        corpo += "{\"texto\":";
+                        anexarJsonString(corpo, texto.data() + faixa.inicio, faixa.tamanho());
+                        corpo += ",\"n\":";
+                        anexarJsonNumero(corpo, n);
+                        corpo += ",\"top\":";
+                        anexarJsonNumero(corpo, candidatos);
+                        corpo += '}';
+                        auto inicio = std::chrono::steady_clock::now();
+                        try {
+                            parciais[i] = enviarCorpoParaReplica(escravosPalavras, replica, "/palavras", corpo, rastro);
+                        } catch (const std::exception& e) {
+                            std::cout << "Réplica " << replica->endereco() << " falhou em um fragmento: "
+                                     << e.what() << std::endl;
+                            fila.devolver(r, i);
+                            std::lock_guard<std::mutex> lock(mutexErro);
+                            ultimoErro = e.what();
+                            break;
+                        }
+                        replica->registrarVazao(faixa.tamanho(), std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - inicio).count());
+                        concluidos[i] = 1;
+                        fila.concluir(i);
+                        bytes += faixa.tamanho();
+                        feitos++;
+                        if (roubado) roubados++;
+                    }
+                    Json::Value item;
+                    item["replica"] = replica->endereco();
+                    item["fragmentos"] = Json::Value::UInt64(feitos);
+                    item["bytes"] = Json::Value::UInt64(bytes);
+                    std::lock_guard<std::mutex> lock(mutexErro);
+                    distribuicao.append(item);
+                }));
+            }
+            for (auto& f : futures) f.get();
+            medicaoFanout.encerrar();
+            if (std::find(concluidos.begin(), concluidos.end(), 0) != concluidos.end()) {
+                throw std::runtime_error(escravosPalavras.nome() + " não disponível" +
+                                         (ultimoErro.empty() ? "" : ": " + ultimoErro));
+            }
+            
+            // Mescla dos top-K parciais
+            auto medicaoMescla = rastro.medir("mescla");
+            Json::Value ngramas;
+            uint64_t totalPalavras = 0;
+            for (unsigned k = 1; k <= n; ++k) {
+                std::unordered_map<std::string, uint64_t> soma;
+                for (const auto& parcial : parciais) {
+                    for (const auto& item : parcial["ngramas"][std::to_string(k)]) {
+                        soma[item["termo"].asString()] += item["quantidade"].asUInt64();
+                    }
+                }
+                std::vector<std::pair<std::string, uint64_t>> ordenados(soma.begin(), soma.end());
+                size_t limite = std::min<size_t>(top, ordenados.size());
+                std::partial_sort(ordenados.begin(), ordenados.begin() + limite, ordenados.end(),
+                    [](const auto& a, const auto& b) {
+                        return a.second != b.second ? a.second > b.second : a.first < b.first;
+                    });
+                
+                Json::Value lista(Json::arrayValue);
+                for (size_t i = 0; i < limite; ++i) {
+                    Json::Value item;
+                    item["termo"] = ordenados[i].first;
+                    item["quantidade"] = Json::Value::UInt64(ordenados[i].second);
+                    lista.append(item);
+                }
+                ngramas[std::to_string(k)] = lista;
+            }
+            for (const auto& parcial : parciais) {
+                totalPalavras += parcial["total_palavras"].asUInt64();
+            }
+            medicaoMescla.encerrar();
+            
+            Json::Value resposta;
+            resposta["ngramas"] = ngramas;
+            resposta["total_palavras"] = Json::Value::UInt64(totalPalavras);
+            resposta["fragmentos"] = Json::Value::UInt64(totalFragmentos);
+            resposta["fragmentos_roubados"] = Json::Value::UInt64(roubados.load());
+            resposta["distribuicao"] = distribuicao;
+            resposta["aproximado"] = totalFragmentos > 1;
+            resposta["timestamp"] = Json::Value::Int64(std::time(nullptr));
+            if (pediuTimings(req, requestJson)) {
+                resposta["timings"] = rastro.timings();
+            }
+            
+            Json::StreamWriterBuilder builder;
+            res.set_content(Json::writeString(builder, resposta), "application/json");
+            
+            std::cout << "Palavras concluídas: " << totalPalavras << " palavras" << std::endl;
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Erro no processamento de palavras: " << e.what() << std::endl;
+            
+            Json::Value erro;
+            erro["erro"] = e.what();
+            
+            Json::StreamWriterBuilder builder;
+            res.status = 500;
+            res.set_content(Json::writeString(builder, erro), "application/json");
+        }
+    }
+    
+    void exibirReplicas() const {
+        for (const GrupoReplicas* grupo : {&escravosLetras, &escravosNumeros, &escravosPalavras}) {
+            std::cout << "Réplicas de " << grupo->nome() << ":";
+            for (const auto& replica : *grupo->membros()) {
+                std::cout << " " << replica->endereco();
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    int iniciar(int porta = 8080) {
+        std::cout << "Servidor Mestre iniciando na porta " << porta << std::endl;
+        exibirReplicas();
+        
+        // Threads e flocks só depois do fork: expiração e armazém abrem em cada processo servidor
+        ExecucaoServidor execucao(servidor, "servidor mestre", porta,
+                                  [this]() { iniciarTarefasFundo(); },
+                                  [this]() { pararTarefasFundo(); });
+        return execucao.executar();
+    }
+    
+    // Uso embutido (ex.: benchmarks com escravos substitutos no mesmo processo): vincula
+    // uma porta livre e escuta sem supervisão de processos nem tratamento de sinais
+    int vincularPortaLivre(const std::string& host) {
+        return servidor.bind_to_any_port(host);
+    }
+    
+    bool escutarVinculado() {
+        return servidor.listen_after_bind();
+    }
+    
+    void parar() {
+        servidor.stop();
+        pararTarefasFundo();
+    }
+};
+
+#endif // MESTRE_H
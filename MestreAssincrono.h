@@ -0,0 +1,1366 @@
+#ifndef MESTRE_ASSINCRONO_H
+#define MESTRE_ASSINCRONO_H
+
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include "Mestre.h"
+
+// Modo assíncrono do Mestre (MESTRE_MODO=assincrono; requer C++20).
+//
+// Cada thread roda um laço de eventos epoll com seu próprio socket de escuta na porta
+// (SO_REUSEPORT). Cada requisição é uma corrotina: o fan-out para os escravos, a E/S com eles
+// e a mescla dos resultados suspendem a corrotina em vez de bloquear a thread, então poucas
+// threads mantêm milhares de requisições em andamento. /processar, /health e as rotas de
+// membros são atendidas no próprio laço; /palavras e /processar/incremental reutilizam os
+// handlers síncronos do Mestre em um pool de threads à parte.
+//
+// Variáveis de ambiente:
+//   THREADS_EVENTOS      laços de eventos (padrão: núcleos disponíveis)
+//   THREADS_BLOQUEANTES  threads para rotas síncronas e resolução de nomes (padrão: 4)
+
+// ---------------------------------------------------------------------------
+// Corrotinas: Tarefa<T> começa suspensa e roda quando aguardada com co_await
+// ---------------------------------------------------------------------------
+
+template <typename T = void>
+class Tarefa;
+
+struct PromessaBase {
+    std::coroutine_handle<> continuacao;
+    std::exception_ptr erro;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Ao terminar, retoma quem aguardava a tarefa (transferência simétrica, sem crescer a pilha)
+    struct RetomarContinuacao {
+        bool await_ready() noexcept { return false; }
+        template <typename Promessa>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promessa> h) noexcept {
+            auto continuacao = h.promise().continuacao;
+            return continuacao ? continuacao : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    RetomarContinuacao final_suspend() noexcept { return {}; }
+    void unhandled_exception() { erro = std::current_exception(); }
+};
+
+template <typename T>
+struct PromessaTarefa : PromessaBase {
+    std::optional<T> valor;
+
+    Tarefa<T> get_return_object();
+
+    template <typename V>
+    void return_value(V&& v) { valor.emplace(std::forward<V>(v)); }
+
+    T resultado() {
+        if (erro) std::rethrow_exception(erro);
+        return std::move(*valor);
+    }
+};
+
+template <>
+struct PromessaTarefa<void> : PromessaBase {
+    Tarefa<void> get_return_object();
+    void return_void() {}
+
+    void resultado() {
+        if (erro) std::rethrow_exception(erro);
+    }
+};
+
+template <typename T>
+class Tarefa {
+public:
+    using promise_type = PromessaTarefa<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+private:
+    Handle handle;
+
+public:
+    explicit Tarefa(Handle h) : handle(h) {}
+    Tarefa(Tarefa&& outra) noexcept : handle(std::exchange(outra.handle, {})) {}
+    Tarefa(const Tarefa&) = delete;
+    Tarefa& operator=(const Tarefa&) = delete;
+    Tarefa& operator=(Tarefa&&) = delete;
+
+    ~Tarefa() {
+        if (handle) handle.destroy();
+    }
+
+    auto operator co_await() noexcept {
+        struct Aguardar {
+            Handle handle;
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> quem) noexcept {
+                handle.promise().continuacao = quem;
+                return handle;
+            }
+            T await_resume() { return handle.promise().resultado(); }
+        };
+        return Aguardar{handle};
+    }
+};
+
+template <typename T>
+Tarefa<T> PromessaTarefa<T>::get_return_object() {
+    return Tarefa<T>(std::coroutine_handle<PromessaTarefa<T>>::from_promise(*this));
+}
+
+inline Tarefa<void> PromessaTarefa<void>::get_return_object() {
+    return Tarefa<void>(std::coroutine_handle<PromessaTarefa<void>>::from_promise(*this));
+}
+
+// Corrotina que começa a executar imediatamente e se destrói ao terminar
+struct Destacada {
+    struct promise_type {
+        Destacada get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Aguarda duas tarefas que avançam ao mesmo tempo (fan-out) e devolve os dois resultados
+template <typename A, typename B>
+struct EstadoJuncao {
+    int pendentes = 2;
+    std::coroutine_handle<> aguardando;
+    std::optional<A> a;
+    std::optional<B> b;
+    std::exception_ptr erro;
+};
+
+template <typename T, typename Estado>
+Destacada concluirJuncao(Tarefa<T> tarefa, std::optional<T>& destino, Estado& estado) {
+    try {
+        destino.emplace(co_await tarefa);
+    } catch (...) {
+        estado.erro = std::current_exception();
+    }
+    if (--estado.pendentes == 0 && estado.aguardando) {
+        estado.aguardando.resume();
+    }
+}
+
+template <typename A, typename B>
+Tarefa<std::pair<A, B>> quandoAmbas(Tarefa<A> a, Tarefa<B> b) {
+    EstadoJuncao<A, B> estado;
+    concluirJuncao(std::move(a), estado.a, estado);
+    concluirJuncao(std::move(b), estado.b, estado);
+
+    struct Aguardar {
+        EstadoJuncao<A, B>& estado;
+        bool await_ready() noexcept { return estado.pendentes == 0; }
+        void await_suspend(std::coroutine_handle<> h) noexcept { estado.aguardando = h; }
+        void await_resume() noexcept {}
+    };
+    co_await Aguardar{estado};
+
+    if (estado.erro) {
+        std::rethrow_exception(estado.erro);
+    }
+    co_return std::pair<A, B>(std::move(*estado.a), std::move(*estado.b));
+}
+
+// ---------------------------------------------------------------------------
+// Laço de eventos (epoll) e pool para chamadas que bloqueiam
+// ---------------------------------------------------------------------------
+
+class LacoEventos {
+public:
+    struct Espera {
+        std::coroutine_handle<> handle;
+        std::chrono::steady_clock::time_point prazo = std::chrono::steady_clock::time_point::max();
+        bool interrompivel = false; // acordada no encerramento (aceitação, keep-alive ocioso)
+        bool expirou = false;
+    };
+
+    // co_await laco.aguardar(fd, EPOLLIN, timeoutMs): false se o prazo esgotou
+    struct AguardarFd {
+        LacoEventos& laco;
+        int fd;
+        uint32_t eventos;
+        int timeoutMs;
+        bool interrompivel;
+        Espera espera;
+
+        bool await_ready() noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            espera.handle = h;
+            espera.interrompivel = interrompivel;
+            return laco.registrar(fd, eventos, timeoutMs, &espera);
+        }
+        bool await_resume() noexcept { return !espera.expirou; }
+    };
+
+private:
+    int epfd = -1;
+    int acordar = -1;
+    std::unordered_map<int, Espera*> esperas;
+    std::set<std::pair<std::chrono::steady_clock::time_point, int>> prazos;
+    std::mutex mutexProntos;
+    std::vector<std::coroutine_handle<>> prontos;
+    std::atomic<bool> encerrando{false};
+    size_t tarefasAtivas = 0;
+
+    bool registrar(int fd, uint32_t eventos, int timeoutMs, Espera* espera) {
+        if (espera->interrompivel && encerrando) {
+            espera->expirou = true;
+            return false;
+        }
+        epoll_event ev{};
+        ev.events = eventos | EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) < 0) {
+            if (errno != ENOENT || epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                throw std::runtime_error(std::string("epoll_ctl: ") + std::strerror(errno));
+            }
+        }
+        esperas[fd] = espera;
+        if (timeoutMs >= 0) {
+            espera->prazo = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            prazos.emplace(espera->prazo, fd);
+        }
+        return true;
+    }
+
+    void retomar(int fd, bool expirou) {
+        auto it = esperas.find(fd);
+        if (it == esperas.end()) {
+            return;
+        }
+        Espera* espera = it->second;
+        esperas.erase(it);
+        if (espera->prazo != std::chrono::steady_clock::time_point::max()) {
+            prazos.erase({espera->prazo, fd});
+        }
+        espera->expirou = expirou;
+        espera->handle.resume();
+    }
+
+    void sinalizar() {
+        uint64_t um = 1;
+        ssize_t escritos = write(acordar, &um, sizeof(um));
+        (void)escritos;
+    }
+
+public:
+    LacoEventos() {
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        acordar = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = acordar;
+        if (epfd < 0 || acordar < 0 || epoll_ctl(epfd, EPOLL_CTL_ADD, acordar, &ev) < 0) {
+            throw std::runtime_error(std::string("Falha ao criar laço de eventos: ") + std::strerror(errno));
+        }
+    }
+
+    ~LacoEventos() {
+        close(acordar);
+        close(epfd);
+    }
+
+    LacoEventos(const LacoEventos&) = delete;
+    LacoEventos& operator=(const LacoEventos&) = delete;
+
+    AguardarFd aguardar(int fd, uint32_t eventos, int timeoutMs, bool interrompivel = false) {
+        return AguardarFd{*this, fd, eventos, timeoutMs, interrompivel, {}};
+    }
+
+    // Retoma a corrotina no laço; pode ser chamado de qualquer thread
+    void agendar(std::coroutine_handle<> h) {
+        {
+            std::lock_guard<std::mutex> lock(mutexProntos);
+            prontos.push_back(h);
+        }
+        sinalizar();
+    }
+
+    // Pode ser chamado de qualquer thread: o laço acorda as esperas ociosas e termina
+    // quando não houver mais tarefas ativas
+    void encerrar() {
+        encerrando = true;
+        sinalizar();
+    }
+
+    bool emEncerramento() const { return encerrando; }
+    void iniciarTarefa() { ++tarefasAtivas; }
+    void concluirTarefa() { --tarefasAtivas; }
+
+    void executar() {
+        epoll_event eventos[256];
+        bool ociosasInterrompidas = false;
+        while (!(encerrando && tarefasAtivas == 0)) {
+            int timeout = -1;
+            if (!prazos.empty()) {
+                auto restante = prazos.begin()->first - std::chrono::steady_clock::now();
+                timeout = std::max<int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(restante).count());
+            }
+            int n = epoll_wait(epfd, eventos, 256, timeout);
+            if (n < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("epoll_wait: ") + std::strerror(errno));
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = eventos[i].data.fd;
+                if (fd != acordar) {
+                    retomar(fd, false);
+                    continue;
+                }
+                uint64_t valor;
+                ssize_t lidos = read(acordar, &valor, sizeof(valor));
+                (void)lidos;
+                std::vector<std::coroutine_handle<>> lote;
+                {
+                    std::lock_guard<std::mutex> lock(mutexProntos);
+                    lote.swap(prontos);
+                }
+                for (auto h : lote) {
+                    h.resume();
+                }
+            }
+
+            auto agora = std::chrono::steady_clock::now();
+            while (!prazos.empty() && prazos.begin()->first <= agora) {
+                retomar(prazos.begin()->second, true);
+            }
+
+            if (encerrando && !ociosasInterrompidas) {
+                ociosasInterrompidas = true;
+                std::vector<int> ociosas;
+                for (const auto& [fd, espera] : esperas) {
+                    if (espera->interrompivel) ociosas.push_back(fd);
+                }
+                for (int fd : ociosas) {
+                    retomar(fd, true);
+                }
+            }
+        }
+    }
+};
+
+// Inicia a tarefa no laço, contando-a como ativa até terminar (o laço só encerra sem tarefas ativas)
+inline Destacada executarNoLaco(LacoEventos& laco, Tarefa<void> tarefa) {
+    laco.iniciarTarefa();
+    try {
+        co_await tarefa;
+    } catch (const std::exception& e) {
+        std::cerr << "Erro em tarefa assíncrona: " << e.what() << std::endl;
+    }
+    laco.concluirTarefa();
+}
+
+class PoolBloqueante {
+private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> fila;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool parando = false;
+
+public:
+    explicit PoolBloqueante(size_t quantidade) {
+        for (size_t i = 0; i < quantidade; ++i) {
+            threads.emplace_back([this]() {
+                AfinidadeCpu::instancia().fixarThreadAtual("bloqueante");
+                while (true) {
+                    std::function<void()> trabalho;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv.wait(lock, [this]() { return parando || !fila.empty(); });
+                        if (fila.empty()) return;
+                        trabalho = std::move(fila.front());
+                        fila.pop_front();
+                    }
+                    trabalho();
+                }
+            });
+        }
+    }
+
+    ~PoolBloqueante() { parar(); }
+
+    void enfileirar(std::function<void()> trabalho) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            fila.push_back(std::move(trabalho));
+        }
+        cv.notify_one();
+    }
+
+    // Conclui o que já está na fila e encerra as threads
+    void parar() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            parando = true;
+        }
+        cv.notify_all();
+        for (auto& t : threads) {
+            if (t.joinable()) t.join();
+        }
+    }
+};
+
+// co_await AguardarBloqueante{pool, laco, funcao}: executa 'funcao' no pool e retoma no laço
+struct AguardarBloqueante {
+    PoolBloqueante& pool;
+    LacoEventos& laco;
+    std::function<void()> funcao;
+    std::exception_ptr erro;
+
+    AguardarBloqueante(PoolBloqueante& p, LacoEventos& l, std::function<void()> f)
+        : pool(p), laco(l), funcao(std::move(f)) {}
+
+    bool await_ready() noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+        pool.enfileirar([this, h]() {
+            try {
+                funcao();
+            } catch (...) {
+                erro = std::current_exception();
+            }
+            laco.agendar(h);
+        });
+    }
+    void await_resume() {
+        if (erro) std::rethrow_exception(erro);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// HTTP/1.1 mínimo sobre sockets não bloqueantes
+// ---------------------------------------------------------------------------
+
+using CabecalhosHttp = std::vector<std::pair<std::string, std::string>>;
+
+inline std::string valorCabecalho(const CabecalhosHttp& cabecalhos, const std::string& nome) {
+    for (const auto& [chave, valor] : cabecalhos) {
+        if (strcasecmp(chave.c_str(), nome.c_str()) == 0) return valor;
+    }
+    return "";
+}
+
+struct RequisicaoHttp {
+    std::string metodo;
+    std::string caminho;
+    std::string consulta;
+    CabecalhosHttp cabecalhos;
+    std::string corpo;
+    bool manterConexao = true;
+    int erro = 0; // status de erro quando a requisição não pôde ser lida (400, 411, 413)
+
+    std::string cabecalho(const std::string& nome) const { return valorCabecalho(cabecalhos, nome); }
+
+    std::string parametro(const std::string& nome) const {
+        size_t inicio = 0;
+        while (inicio <= consulta.size()) {
+            size_t fim = consulta.find('&', inicio);
+            if (fim == std::string::npos) fim = consulta.size();
+            std::string par = consulta.substr(inicio, fim - inicio);
+            size_t igual = par.find('=');
+            if (par.substr(0, igual) == nome) {
+                return igual == std::string::npos ? "" : par.substr(igual + 1);
+            }
+            inicio = fim + 1;
+        }
+        return "";
+    }
+};
+
+struct RespostaHttp {
+    int status = 200;
+    std::string tipoConteudo = "application/json";
+    CabecalhosHttp cabecalhos;
+    std::string corpo;
+};
+
+// Linhas "Nome: valor" após a primeira linha do bloco (que termina em "\r\n\r\n")
+inline bool analisarCabecalhos(std::string_view bloco, std::string& primeiraLinha, CabecalhosHttp& cabecalhos) {
+    size_t fimLinha = bloco.find("\r\n");
+    if (fimLinha == std::string_view::npos) return false;
+    primeiraLinha = std::string(bloco.substr(0, fimLinha));
+    size_t inicio = fimLinha + 2;
+    while (inicio < bloco.size()) {
+        fimLinha = bloco.find("\r\n", inicio);
+        if (fimLinha == std::string_view::npos || fimLinha == inicio) break;
+        std::string_view linha = bloco.substr(inicio, fimLinha - inicio);
+        size_t doisPontos = linha.find(':');
+        if (doisPontos == std::string_view::npos) return false;
+        std::string_view valor = linha.substr(doisPontos + 1);
+        while (!valor.empty() && (valor.front() == ' ' || valor.front() == '\t')) valor.remove_prefix(1);
+        while (!valor.empty() && (valor.back() == ' ' || valor.back() == '\t')) valor.remove_suffix(1);
+        cabecalhos.emplace_back(std::string(linha.substr(0, doisPontos)), std::string(valor));
+        inicio = fimLinha + 2;
+    }
+    return true;
+}
+
+// Content-Length; false se ausente (tamanho 0) ou inválido
+inline bool tamanhoConteudo(const CabecalhosHttp& cabecalhos, size_t& tamanho, bool& presente) {
+    std::string valor = valorCabecalho(cabecalhos, "Content-Length");
+    presente = !valor.empty();
+    tamanho = 0;
+    if (!presente) return true;
+    for (char c : valor) {
+        if (c < '0' || c > '9') return false;
+    }
+    try {
+        tamanho = std::stoull(valor);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+inline const char* motivoStatus(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        default: return "";
+    }
+}
+
+// Socket não bloqueante com buffer de entrada; fecha o descritor ao ser destruído
+class CanalSocket {
+private:
+    LacoEventos& laco;
+    int fd;
+
+public:
+    std::string entrada;
+
+    static constexpr size_t limiteCabecalhos = 64 * 1024;
+    static constexpr size_t blocoLeitura = 64 * 1024;
+
+    CanalSocket(LacoEventos& l, int descritor) : laco(l), fd(descritor) {}
+    ~CanalSocket() {
+        if (fd >= 0) close(fd);
+    }
+
+    CanalSocket(const CanalSocket&) = delete;
+    CanalSocket& operator=(const CanalSocket&) = delete;
+
+    // Entrega o descritor (ex.: de volta ao pool de conexões) sem fechá-lo
+    int liberar() { return std::exchange(fd, -1); }
+
+    // Lê o que estiver disponível; false em fim de conexão, erro ou prazo esgotado
+    Tarefa<bool> lerMais(int timeoutMs, bool interrompivel = false) {
+        char buffer[16 * 1024];
+        while (true) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                entrada.append(buffer, n);
+                co_return true;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                co_return false;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            bool pronto = co_await laco.aguardar(fd, EPOLLIN, timeoutMs, interrompivel);
+            if (!pronto) {
+                co_return false;
+            }
+        }
+    }
+
+    // Garante 'total' bytes em entrada, lendo direto no buffer final (corpos grandes). O buffer
+    // cresce conforme os dados chegam: um Content-Length declarado não reserva memória sozinho
+    Tarefa<bool> lerAte(size_t total, int timeoutMs) {
+        size_t lidos = entrada.size();
+        if (lidos >= total) {
+            co_return true;
+        }
+        while (lidos < total) {
+            if (lidos == entrada.size()) {
+                entrada.resize(std::min(total, std::max(lidos * 2, lidos + blocoLeitura)));
+            }
+            ssize_t n = recv(fd, &entrada[lidos], entrada.size() - lidos, 0);
+            if (n > 0) {
+                lidos += n;
+                continue;
+            }
+            bool pronto = n < 0 && errno == EINTR;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                pronto = co_await laco.aguardar(fd, EPOLLIN, timeoutMs);
+            }
+            if (!pronto) {
+                entrada.resize(lidos);
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    // Aguarda um bloco de cabeçalhos completo; retorna a posição logo após "\r\n\r\n" (0 se não chegou)
+    Tarefa<size_t> lerCabecalhos(int timeoutOciosoMs, int timeoutMs, bool interrompivel) {
+        size_t busca = 0;
+        while (true) {
+            size_t fim = entrada.find("\r\n\r\n", busca);
+            if (fim != std::string::npos) {
+                co_return fim + 4;
+            }
+            if (entrada.size() > limiteCabecalhos) {
+                co_return 0;
+            }
+            busca = entrada.size() >= 3 ? entrada.size() - 3 : 0;
+            bool ocioso = entrada.empty();
+            bool lido = co_await lerMais(ocioso ? timeoutOciosoMs : timeoutMs, ocioso && interrompivel);
+            if (!lido) {
+                co_return 0;
+            }
+        }
+    }
+
+    // Envia a + b com writev, sem concatenar (b costuma ser o corpo)
+    Tarefa<bool> escrever(std::string_view a, std::string_view b, int timeoutMs) {
+        size_t enviadoA = 0;
+        size_t enviadoB = 0;
+        while (enviadoA < a.size() || enviadoB < b.size()) {
+            iovec partes[2];
+            int quantidade = 0;
+            if (enviadoA < a.size()) {
+                partes[quantidade++] = {const_cast<char*>(a.data()) + enviadoA, a.size() - enviadoA};
+            }
+            if (enviadoB < b.size()) {
+                partes[quantidade++] = {const_cast<char*>(b.data()) + enviadoB, b.size() - enviadoB};
+            }
+            msghdr mensagem{};
+            mensagem.msg_iov = partes;
+            mensagem.msg_iovlen = quantidade;
+            ssize_t n = sendmsg(fd, &mensagem, MSG_NOSIGNAL);
+            if (n > 0) {
+                size_t deA = std::min<size_t>(n, a.size() - enviadoA);
+                enviadoA += deA;
+                enviadoB += n - deA;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                co_return false;
+            }
+            bool pronto = co_await laco.aguardar(fd, EPOLLOUT, timeoutMs);
+            if (!pronto) {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+};
+
+struct RespostaEscravo {
+    int status = 0;
+    std::string corpo;
+};
+
+// Conexões keep-alive com os escravos (uma instância por laço) e cache de resolução de nomes
+class ConexoesEscravos {
+private:
+    struct Endereco {
+        sockaddr_storage endereco{};
+        socklen_t tamanho = 0;
+        std::chrono::steady_clock::time_point validade;
+    };
+
+    LacoEventos& laco;
+    PoolBloqueante& pool;
+    std::unordered_map<std::string, std::vector<int>> ociosas;
+    std::unordered_map<std::string, Endereco> enderecos;
+
+    static constexpr size_t maximoOciosasPorEscravo = 64;
+    static constexpr int timeoutConexaoMs = 5000;
+    static constexpr int timeoutLeituraMs = 300000;
+
+    Tarefa<Endereco> resolver(const std::string& host, int porta, const std::string& chave) {
+        auto it = enderecos.find(chave);
+        if (it != enderecos.end() && it->second.validade > std::chrono::steady_clock::now()) {
+            co_return it->second;
+        }
+
+        // getaddrinfo bloqueia (DNS do Docker): roda no pool
+        Endereco resolvido;
+        int erro = 0;
+        co_await AguardarBloqueante{pool, laco, [&]() {
+            addrinfo dicas{};
+            dicas.ai_family = AF_UNSPEC;
+            dicas.ai_socktype = SOCK_STREAM;
+            addrinfo* resultado = nullptr;
+            erro = getaddrinfo(host.c_str(), std::to_string(porta).c_str(), &dicas, &resultado);
+            if (erro == 0) {
+                std::memcpy(&resolvido.endereco, resultado->ai_addr, resultado->ai_addrlen);
+                resolvido.tamanho = resultado->ai_addrlen;
+                freeaddrinfo(resultado);
+            }
+        }};
+        if (erro != 0) {
+            throw std::runtime_error("Não foi possível resolver " + host + ": " + gai_strerror(erro));
+        }
+        resolvido.validade = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        enderecos[chave] = resolvido;
+        co_return resolvido;
+    }
+
+    Tarefa<int> conectar(const std::string& host, int porta, const std::string& chave) {
+        Endereco destino = co_await resolver(host, porta, chave);
+        int fd = socket(destino.endereco.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+        }
+        int sim = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim));
+
+        if (connect(fd, reinterpret_cast<sockaddr*>(&destino.endereco), destino.tamanho) < 0) {
+            bool ok = errno == EINPROGRESS;
+            if (ok) {
+                ok = co_await laco.aguardar(fd, EPOLLOUT, timeoutConexaoMs);
+            }
+            int erro = 0;
+            socklen_t tamanhoErro = sizeof(erro);
+            if (ok) {
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &erro, &tamanhoErro);
+            }
+            if (!ok || erro != 0) {
+                close(fd);
+                enderecos.erase(chave); // o escravo pode ter sido recriado com outro IP
+                throw std::runtime_error("Falha ao conectar em " + chave);
+            }
+        }
+        co_return fd;
+    }
+
+public:
+    ConexoesEscravos(LacoEventos& l, PoolBloqueante& p) : laco(l), pool(p) {}
+
+    ~ConexoesEscravos() {
+        for (auto& [chave, descritores] : ociosas) {
+            for (int fd : descritores) close(fd);
+        }
+    }
+
+    Tarefa<RespostaEscravo> postar(const std::string& host, int porta, const std::string& caminho,
+                                   const CabecalhosHttp& cabecalhos, const std::string& corpo) {
+        std::string chave = host + ":" + std::to_string(porta);
+        std::string cabecalho = "POST " + caminho + " HTTP/1.1\r\nHost: " + chave +
+                                "\r\nContent-Type: application/json\r\nContent-Length: " +
+                                std::to_string(corpo.size()) + "\r\n";
+        for (const auto& [nome, valor] : cabecalhos) {
+            cabecalho += nome + ": " + valor + "\r\n";
+        }
+        cabecalho += "\r\n";
+
+        // Uma conexão reaproveitada pode ter sido fechada pelo escravo enquanto estava ociosa:
+        // nesse caso (nada recebido) a requisição é repetida em uma conexão nova
+        for (int tentativa = 0; tentativa < 2; ++tentativa) {
+            int fd = -1;
+            auto& livres = ociosas[chave];
+            if (!livres.empty()) {
+                fd = livres.back();
+                livres.pop_back();
+            }
+            bool reaproveitada = fd >= 0;
+            if (!reaproveitada) {
+                fd = co_await conectar(host, porta, chave);
+            }
+            CanalSocket canal(laco, fd);
+
+            bool enviado = co_await canal.escrever(cabecalho, corpo, timeoutLeituraMs);
+            size_t fimCabecalhos = 0;
+            if (enviado) {
+                fimCabecalhos = co_await canal.lerCabecalhos(timeoutLeituraMs, timeoutLeituraMs, false);
+            }
+            if (fimCabecalhos == 0) {
+                if (reaproveitada && canal.entrada.empty()) continue;
+                throw std::runtime_error("Sem resposta de " + chave);
+            }
+
+            std::string linhaStatus;
+            CabecalhosHttp cabecalhosResposta;
+            size_t tamanho = 0;
+            bool temTamanho = false;
+            if (!analisarCabecalhos(std::string_view(canal.entrada).substr(0, fimCabecalhos), linhaStatus, cabecalhosResposta) ||
+                linhaStatus.size() < 12 || !tamanhoConteudo(cabecalhosResposta, tamanho, temTamanho) || !temTamanho) {
+                throw std::runtime_error("Resposta HTTP inválida de " + chave);
+            }
+            bool completa = co_await canal.lerAte(fimCabecalhos + tamanho, timeoutLeituraMs);
+            if (!completa) {
+                throw std::runtime_error("Resposta incompleta de " + chave);
+            }
+
+            RespostaEscravo resposta;
+            resposta.status = std::atoi(linhaStatus.c_str() + 9);
+            resposta.corpo = canal.entrada.substr(fimCabecalhos, tamanho);
+
+            bool fechar = strcasecmp(valorCabecalho(cabecalhosResposta, "Connection").c_str(), "close") == 0;
+            if (!fechar && canal.entrada.size() == fimCabecalhos + tamanho &&
+                ociosas[chave].size() < maximoOciosasPorEscravo) {
+                ociosas[chave].push_back(canal.liberar());
+            }
+            co_return resposta;
+        }
+        throw std::runtime_error("Sem resposta de " + chave);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Servidor
+// ---------------------------------------------------------------------------
+
+class MestreAssincrono {
+private:
+    // Estado de cada thread de eventos
+    struct ContextoLaco {
+        LacoEventos laco;
+        ConexoesEscravos conexoes;
+
+        explicit ContextoLaco(PoolBloqueante& pool) : conexoes(laco, pool) {}
+    };
+
+    using HandlerSincrono = void (Mestre::*)(const httplib::Request&, httplib::Response&);
+
+    Mestre& mestre;
+    size_t threadsEventos;
+    size_t threadsBloqueantes;
+    size_t corpoMaximo; // bytes; acima disso a requisição recebe 413 sem que o corpo seja lido
+    std::unique_ptr<PoolBloqueante> pool;
+    std::vector<std::unique_ptr<ContextoLaco>> contextos;
+    std::mutex mutexContextos;
+    bool parado = false;
+
+    static constexpr int timeoutOciosoMs = 5000; // keep-alive, como no httplib
+    static constexpr int timeoutLeituraMs = 300000;
+
+    static size_t variavelNumerica(const char* nome, size_t padrao) {
+        const char* valor = std::getenv(nome);
+        return valor ? std::max(1, std::atoi(valor)) : padrao;
+    }
+
+    static RespostaHttp respostaJson(int status, const Json::Value& json) {
+        RespostaHttp res;
+        res.status = status;
+        Json::StreamWriterBuilder builder;
+        res.corpo = Json::writeString(builder, json);
+        return res;
+    }
+
+    static RespostaHttp respostaErro(int status, const std::string& mensagem) {
+        Json::Value erro;
+        erro["erro"] = mensagem;
+        return respostaJson(status, erro);
+    }
+
+    static int abrirEscuta(const std::string& host, int porta) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        int sim = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &sim, sizeof(sim));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &sim, sizeof(sim));
+
+        sockaddr_in endereco{};
+        endereco.sin_family = AF_INET;
+        endereco.sin_port = htons(porta);
+        if (inet_pton(AF_INET, host.c_str(), &endereco.sin_addr) != 1 ||
+            bind(fd, reinterpret_cast<sockaddr*>(&endereco), sizeof(endereco)) < 0 || listen(fd, SOMAXCONN) < 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    Tarefa<void> aceitarConexoes(ContextoLaco& contexto, int fdEscuta) {
+        while (!contexto.laco.emEncerramento()) {
+            int fd = accept4(fdEscuta, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                int sim = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim));
+                executarNoLaco(contexto.laco, atenderConexao(contexto, fd));
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                co_await contexto.laco.aguardar(fdEscuta, EPOLLIN, -1, true);
+                continue;
+            }
+            // Ex.: limite de descritores atingido; tenta de novo em seguida sem girar em falso
+            std::cerr << "Erro ao aceitar conexão: " << std::strerror(errno) << std::endl;
+            co_await contexto.laco.aguardar(fdEscuta, 0, 100, true);
+        }
+        close(fdEscuta);
+    }
+
+    // Lê uma requisição; nullopt se a conexão terminou (ou ficou ociosa) antes de uma requisição completa
+    Tarefa<std::optional<RequisicaoHttp>> lerRequisicao(CanalSocket& canal) {
+        size_t fimCabecalhos = co_await canal.lerCabecalhos(timeoutOciosoMs, timeoutLeituraMs, true);
+        if (fimCabecalhos == 0) {
+            co_return std::nullopt;
+        }
+
+        RequisicaoHttp req;
+        std::string linha;
+        size_t tamanho = 0;
+        bool temTamanho = false;
+        if (!analisarCabecalhos(std::string_view(canal.entrada).substr(0, fimCabecalhos), linha, req.cabecalhos) ||
+            !tamanhoConteudo(req.cabecalhos, tamanho, temTamanho)) {
+            req.erro = 400;
+            co_return std::move(req);
+        }
+        size_t espaco1 = linha.find(' ');
+        size_t espaco2 = linha.rfind(' ');
+        if (espaco1 == std::string::npos || espaco2 == espaco1) {
+            req.erro = 400;
+            co_return std::move(req);
+        }
+        req.metodo = linha.substr(0, espaco1);
+        std::string alvo = linha.substr(espaco1 + 1, espaco2 - espaco1 - 1);
+        size_t interrogacao = alvo.find('?');
+        req.caminho = alvo.substr(0, interrogacao);
+        if (interrogacao != std::string::npos) {
+            req.consulta = alvo.substr(interrogacao + 1);
+        }
+        std::string conexao = req.cabecalho("Connection");
+        req.manterConexao = linha.compare(espaco2 + 1, std::string::npos, "HTTP/1.0") == 0
+            ? strcasecmp(conexao.c_str(), "keep-alive") == 0
+            : strcasecmp(conexao.c_str(), "close") != 0;
+
+        if (!req.cabecalho("Transfer-Encoding").empty()) {
+            req.erro = 411;
+            co_return std::move(req);
+        }
+        if (tamanho > corpoMaximo) {
+            req.erro = 413;
+            co_return std::move(req);
+        }
+        if (strcasecmp(req.cabecalho("Expect").c_str(), "100-continue") == 0 && canal.entrada.size() == fimCabecalhos) {
+            co_await canal.escrever("HTTP/1.1 100 Continue\r\n\r\n", {}, timeoutLeituraMs);
+        }
+        bool completa = co_await canal.lerAte(fimCabecalhos + tamanho, timeoutLeituraMs);
+        if (!completa) {
+            co_return std::nullopt;
+        }
+
+        // Corpo grande: reaproveita o buffer de entrada em vez de copiar
+        if (canal.entrada.size() == fimCabecalhos + tamanho) {
+            req.corpo = std::move(canal.entrada);
+            req.corpo.erase(0, fimCabecalhos);
+            canal.entrada.clear();
+        } else {
+            req.corpo = canal.entrada.substr(fimCabecalhos, tamanho);
+            canal.entrada.erase(0, fimCabecalhos + tamanho);
+        }
+        co_return std::move(req);
+    }
+
+    Tarefa<void> atenderConexao(ContextoLaco& contexto, int fd) {
+        CanalSocket canal(contexto.laco, fd);
+        while (true) {
+            std::optional<RequisicaoHttp> req = co_await lerRequisicao(canal);
+            if (!req) {
+                break;
+            }
+
+            RespostaHttp res;
+            if (req->erro != 0) {
+                res = respostaErro(req->erro, req->erro == 411 ? "Transfer-Encoding não suportado"
+                                              : req->erro == 413 ? "Corpo da requisição excede CORPO_MAXIMO_MB"
+                                              : "Requisição HTTP inválida");
+            } else {
+                res = co_await despachar(contexto, *req);
+            }
+            bool manter = req->erro == 0 && req->manterConexao && !contexto.laco.emEncerramento();
+
+            std::string cabecalho = "HTTP/1.1 " + std::to_string(res.status) + " " + motivoStatus(res.status) +
+                                    "\r\nContent-Type: " + res.tipoConteudo +
+                                    "\r\nContent-Length: " + std::to_string(res.corpo.size()) + "\r\n";
+            for (const auto& [nome, valor] : res.cabecalhos) {
+                cabecalho += nome + ": " + valor + "\r\n";
+            }
+            cabecalho += manter ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+            bool enviada = co_await canal.escrever(cabecalho, res.corpo, timeoutLeituraMs);
+            if (!enviada || !manter) {
+                break;
+            }
+        }
+    }
+
+    // Executa um handler síncrono do Mestre convertendo a requisição para httplib
+    RespostaHttp chamarSincrono(const RequisicaoHttp& req, HandlerSincrono handler) {
+        httplib::Request requisicao;
+        requisicao.method = req.metodo;
+        requisicao.path = req.caminho;
+        requisicao.body = req.corpo;
+        for (const auto& [nome, valor] : req.cabecalhos) {
+            requisicao.headers.emplace(nome, valor);
+        }
+        size_t inicio = 0;
+        while (!req.consulta.empty() && inicio <= req.consulta.size()) {
+            size_t fim = req.consulta.find('&', inicio);
+            if (fim == std::string::npos) fim = req.consulta.size();
+            std::string par = req.consulta.substr(inicio, fim - inicio);
+            size_t igual = par.find('=');
+            requisicao.params.emplace(par.substr(0, igual), igual == std::string::npos ? "" : par.substr(igual + 1));
+            inicio = fim + 1;
+        }
+
+        httplib::Response resposta;
+        (mestre.*handler)(requisicao, resposta);
+
+        RespostaHttp res;
+        res.status = resposta.status > 0 ? resposta.status : 200;
+        res.corpo = std::move(resposta.body);
+        for (const auto& [nome, valor] : resposta.headers) {
+            if (strcasecmp(nome.c_str(), "Content-Type") == 0) {
+                res.tipoConteudo = valor;
+            } else if (strcasecmp(nome.c_str(), "Content-Length") != 0) {
+                res.cabecalhos.emplace_back(nome, valor);
+            }
+        }
+        return res;
+    }
+
+    Tarefa<RespostaHttp> despachar(ContextoLaco& contexto, const RequisicaoHttp& req) {
+        if (req.metodo == "POST" && req.caminho == "/processar") {
+            RespostaHttp res = co_await processarTexto(contexto, req);
+            co_return res;
+        }
+        if (req.metodo == "GET" && req.caminho == "/health") {
+            Json::Value estado = mestre.estadoSaude();
+            estado["modo"] = "assincrono";
+            estado["threads_eventos"] = Json::Value::UInt64(threadsEventos);
+            co_return respostaJson(200, estado);
+        }
+        if (req.metodo == "GET" && req.caminho.rfind("/resultados/", 0) == 0) {
+            // Leitura no log em disco: vai para o pool como as demais rotas com E/S síncrona
+            RespostaHttp res;
+            co_await AguardarBloqueante{*pool, contexto.laco, [&]() { res = chamarSincrono(req, &Mestre::consultarResultado); }};
+            co_return res;
+        }
+        if (req.metodo == "GET" && req.caminho.rfind("/documentos/", 0) == 0) {
+            // A primeira consulta a um documento mapeia o índice do disco: também no pool
+            RespostaHttp res;
+            co_await AguardarBloqueante{*pool, contexto.laco, [&]() { res = chamarSincrono(req, &Mestre::consultarIntervalo); }};
+            co_return res;
+        }
+        if (req.metodo == "POST" && req.caminho == "/processar/stream") {
+            // As respostas deste laço são escritas de uma vez; eventos parciais exigem o modo síncrono
+            co_return respostaErro(501, "/processar/stream disponível apenas com MESTRE_MODO=sincrono");
+        }
+        if (req.metodo == "POST") {
+            // Rotas de membros são rápidas e não fazem E/S: rodam no próprio laço
+            if (req.caminho == "/registrar" || req.caminho == "/heartbeat" || req.caminho == "/desregistrar") {
+                std::string operacao = req.caminho.substr(1);
+                httplib::Request requisicao;
+                requisicao.body = req.corpo;
+                httplib::Response resposta;
+                mestre.atualizarMembro(requisicao, resposta, operacao);
+                RespostaHttp res;
+                res.status = resposta.status > 0 ? resposta.status : 200;
+                res.corpo = std::move(resposta.body);
+                co_return res;
+            }
+
+            // Rotas que bloqueiam em E/S síncrona vão para o pool
+            HandlerSincrono handler = nullptr;
+            if (req.caminho == "/palavras") handler = &Mestre::processarPalavras;
+            if (req.caminho == "/processar/incremental") handler = &Mestre::processarIncremental;
+            if (handler) {
+                RespostaHttp res;
+                co_await AguardarBloqueante{*pool, contexto.laco, [&]() { res = chamarSincrono(req, handler); }};
+                co_return res;
+            }
+        }
+        co_return respostaErro(404, "Rota não encontrada: " + req.metodo + " " + req.caminho);
+    }
+
+    // Envia o corpo a uma réplica do grupo; se a conexão falhar, tenta as demais réplicas
+    Tarefa<Json::Value> enviarParaReplica(ContextoLaco& contexto, GrupoReplicas& grupo, std::string rota,
+                                          const std::string& corpo, Rastro& rastro) {
+        std::string etapa = rota.substr(1);
+        CabecalhosHttp cabecalhos = {
+            {cabecalhoRequestId, rastro.id()},
+            {cabecalhoAmostrado, rastro.amostra() ? "1" : "0"}
+        };
+
+        auto membros = grupo.membros();
+        size_t tentativas = std::max<size_t>(1, membros->size());
+        std::vector<std::shared_ptr<Replica>> tentadas;
+        std::string ultimoErro;
+        for (size_t i = 0; i < tentativas; ++i) {
+            // A política pode sortear de novo uma réplica que acabou de falhar: usa outra ainda não tentada
+            auto replica = grupo.escolher();
+            if (std::find(tentadas.begin(), tentadas.end(), replica) != tentadas.end()) {
+                for (const auto& candidata : *membros) {
+                    if (std::find(tentadas.begin(), tentadas.end(), candidata) == tentadas.end()) {
+                        replica = candidata;
+                        break;
+                    }
+                }
+            }
+            tentadas.push_back(replica);
+            ReservaReplica reserva(replica);
+
+            auto inicioIdaEVolta = std::chrono::steady_clock::now();
+            std::optional<RespostaEscravo> resposta;
+            try {
+                resposta = co_await contexto.conexoes.postar(replica->host, replica->port, rota, cabecalhos, corpo);
+            } catch (const std::exception& e) {
+                ultimoErro = e.what();
+            }
+            auto fimIdaEVolta = std::chrono::steady_clock::now();
+
+            if (!resposta) {
+                std::cout << "Escravo " << replica->host << " não está disponível!" << std::endl;
+                continue;
+            }
+            if (resposta->status != 200) {
+                throw std::runtime_error("Erro na comunicação com " + grupo.nome() + " em " + replica->endereco());
+            }
+
+            auto medicaoParse = rastro.medir(etapa + ".parse_resposta");
+            Json::Value resultado;
+            Json::Reader reader;
+            if (!reader.parse(resposta->corpo, resultado)) {
+                throw std::runtime_error("Erro ao parsear resposta do " + grupo.nome());
+            }
+            medicaoParse.encerrar();
+
+            Mestre::registrarTemposEscravo(etapa, resultado, inicioIdaEVolta, fimIdaEVolta, rastro);
+            reserva.concluir();
+            co_return resultado;
+        }
+        throw std::runtime_error(grupo.nome() + " não disponível" + (ultimoErro.empty() ? "" : ": " + ultimoErro));
+    }
+
+    Tarefa<RespostaHttp> processarTexto(ContextoLaco& contexto, const RequisicaoHttp& req) {
+        Rastro rastro(idRequisicaoRecebido(req.cabecalho(cabecalhoRequestId)), "mestre",
+                      GravadorTrace::instancia().sortearAmostra());
+        RespostaHttp res;
+
+        try {
+            auto medicaoParse = rastro.medir("parse");
+            Json::Value requestJson;
+            Json::Reader reader;
+            if (!reader.parse(req.corpo, requestJson)) {
+                res = respostaErro(400, "JSON inválido");
+                res.cabecalhos.emplace_back(cabecalhoRequestId, rastro.id());
+                co_return res;
+            }
+            medicaoParse.encerrar();
+
+            const char* texto = "";
+            const char* fimTexto = texto;
+            if (requestJson["texto"].isString()) {
+                requestJson["texto"].getString(&texto, &fimTexto);
+            }
+
+            // Modo aproximado: rodadas de fan-out síncronas, no pool como as demais rotas bloqueantes
+            if (requestJson.isMember("aproximado") && requestJson["aproximado"] != false) {
+                Json::Value resposta;
+                co_await AguardarBloqueante{*pool, contexto.laco, [&]() {
+                    resposta = mestre.processarAproximado(requestJson["aproximado"], texto, fimTexto - texto, rastro);
+                }};
+                if (requestJson.get("timings", false).asBool() || req.parametro("timings") == "1") {
+                    resposta["timings"] = rastro.timings();
+                }
+                res = respostaJson(200, resposta);
+                res.cabecalhos.emplace_back(cabecalhoRequestId, rastro.id());
+                co_return res;
+            }
+
+            // Consulta ao armazém no pool, como /resultados: hash do texto inteiro, flock e, se outro
+            // processo cresceu ou substituiu o log, cópia ou reconstrução do índice
+            auto medicaoArmazem = rastro.medir("armazem");
+            std::string hash;
+            ArmazemResultados::Resultado armazenado;
+            bool encontrado = false;
+            co_await AguardarBloqueante{*pool, contexto.laco, [&]() {
+                hash = hashConteudo(texto, fimTexto - texto);
+                encontrado = mestre.armazemResultados().buscar(hash, armazenado);
+            }};
+            medicaoArmazem.encerrar();
+            if (encontrado) {
+                auto medicaoIndice = rastro.medir("indice");
+                co_await AguardarBloqueante{*pool, contexto.laco, [&]() {
+                    mestre.indicesDocumentos().indexar(hash, texto, fimTexto - texto);
+                }};
+                medicaoIndice.encerrar();
+
+                Json::Value resposta;
+                resposta["letras"] = Json::Value::UInt64(armazenado.letras);
+                resposta["numeros"] = Json::Value::UInt64(armazenado.numeros);
+                resposta["timestamp"] = Json::Value::Int64(armazenado.timestamp);
+                resposta["hash"] = hash;
+                resposta["armazenado"] = true;
+                if (requestJson.get("timings", false).asBool() || req.parametro("timings") == "1") {
+                    resposta["timings"] = rastro.timings();
+                }
+                res = respostaJson(200, resposta);
+                res.cabecalhos.emplace_back(cabecalhoRequestId, rastro.id());
+                co_return res;
+            }
+
+            // Os dois escravos recebem o mesmo corpo: serializado uma única vez
+            auto medicaoSerializacao = rastro.medir("serializacao");
+            std::string corpo;
+            corpo.reserve((fimTexto - texto) + (fimTexto - texto) / 8 + 16);
+            corpo += "{\"texto\":";
+            anexarJsonString(corpo, texto, fimTexto - texto);
+            corpo += '}';
+            medicaoSerializacao.encerrar();
+            std::cout << "Processando texto de " << fimTexto - texto
+                     << " caracteres (request " << rastro.id() << ", assíncrono)..." << std::endl;
+
+            // Fan-out: a corrotina suspende até as duas respostas chegarem
+            auto medicaoFanout = rastro.medir("fanout");
+            Tarefa<Json::Value> tarefaLetras =
+                enviarParaReplica(contexto, *mestre.grupoPorTipo("letras"), "/letras", corpo, rastro);
+            Tarefa<Json::Value> tarefaNumeros =
+                enviarParaReplica(contexto, *mestre.grupoPorTipo("numeros"), "/numeros", corpo, rastro);
+            Tarefa<std::pair<Json::Value, Json::Value>> ambas =
+                quandoAmbas(std::move(tarefaLetras), std::move(tarefaNumeros));
+            std::pair<Json::Value, Json::Value> resultados = co_await ambas;
+            medicaoFanout.encerrar();
+
+            // Construção do índice posicional: varre o texto inteiro, fora do laço
+            auto medicaoIndice = rastro.medir("indice");
+            co_await AguardarBloqueante{*pool, contexto.laco, [&]() {
+                mestre.indicesDocumentos().indexar(hash, texto, fimTexto - texto);
+            }};
+            medicaoIndice.encerrar();
+
+            uint64_t quantidadeLetras = resultados.first["quantidade"].asUInt64();
+            uint64_t quantidadeNumeros = resultados.second["quantidade"].asUInt64();
+
+            int64_t agora = std::time(nullptr);
+            co_await AguardarBloqueante{*pool, contexto.laco, [&]() {
+                mestre.armazemResultados().gravar(
+                    hash, {quantidadeLetras, quantidadeNumeros, static_cast<uint64_t>(fimTexto - texto), agora});
+            }};
+
+            Json::Value resposta;
+            resposta["letras"] = Json::Value::UInt64(quantidadeLetras);
+            resposta["numeros"] = Json::Value::UInt64(quantidadeNumeros);
+            resposta["timestamp"] = Json::Value::Int64(agora);
+            resposta["hash"] = hash;
+            if (requestJson.get("timings", false).asBool() || req.parametro("timings") == "1") {
+                resposta["timings"] = rastro.timings();
+            }
+            res = respostaJson(200, resposta);
+
+            std::cout << "Processamento concluído: " << quantidadeLetras
+                     << " letras, " << quantidadeNumeros << " números" << std::endl;
+
+        } catch (const std::invalid_argument& e) {
+            res = respostaErro(400, e.what());
+        } catch (const std::exception& e) {
+            std::cerr << "Erro no processamento: " << e.what() << std::endl;
+            res = respostaErro(500, e.what());
+        }
+        res.cabecalhos.emplace_back(cabecalhoRequestId, rastro.id());
+        co_return res;
+    }
+
+public:
+    explicit MestreAssincrono(Mestre& m)
+        : mestre(m),
+          threadsEventos(variavelNumerica("THREADS_EVENTOS", std::max(1u, std::thread::hardware_concurrency()))),
+          threadsBloqueantes(variavelNumerica("THREADS_BLOQUEANTES", 4)),
+          corpoMaximo(variavelNumerica("CORPO_MAXIMO_MB", 1024) << 20) {}
+
+    // Bloqueia servindo a porta até parar() ser chamado e as requisições em andamento terminarem
+    bool escutar(const std::string& host, int porta) {
+        std::vector<int> sockets;
+        for (size_t i = 0; i < threadsEventos; ++i) {
+            int fd = abrirEscuta(host, porta);
+            if (fd < 0) {
+                for (int aberto : sockets) close(aberto);
+                return false;
+            }
+            sockets.push_back(fd);
+        }
+
+        pool = std::make_unique<PoolBloqueante>(threadsBloqueantes);
+        {
+            std::lock_guard<std::mutex> lock(mutexContextos);
+            for (size_t i = 0; i < threadsEventos; ++i) {
+                contextos.push_back(std::make_unique<ContextoLaco>(*pool));
+                if (parado) contextos.back()->laco.encerrar();
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadsEventos; ++i) {
+            threads.emplace_back([this, i, fd = sockets[i]]() {
+                // Cada laço e o que ele aloca ficam em um nó (AFINIDADE); o rodízio alterna os nós
+                AfinidadeCpu::instancia().fixarThreadAtual("eventos");
+                ContextoLaco& contexto = *contextos[i];
+                executarNoLaco(contexto.laco, aceitarConexoes(contexto, fd));
+                contexto.laco.executar();
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        pool->parar();
+        std::lock_guard<std::mutex> lock(mutexContextos);
+        contextos.clear();
+        return true;
+    }
+
+    // Para de aceitar conexões; cada laço termina quando suas requisições em andamento concluírem
+    void parar() {
+        std::lock_guard<std::mutex> lock(mutexContextos);
+        parado = true;
+        for (auto& contexto : contextos) {
+            contexto->laco.encerrar();
+        }
+    }
+
+    int iniciar(int porta = 8080) {
+        std::cout << "Servidor Mestre (assíncrono, " << threadsEventos << " laços de eventos) iniciando na porta "
+                 << porta << std::endl;
+        mestre.exibirReplicas();
+
+        ExecucaoServidor execucao(
+            ExecucaoServidor::Servidor{
+                [this](const std::string& host, int p) { return escutar(host, p); },
+                [this]() { parar(); }},
+            "servidor mestre", porta,
+            [this]() { mestre.iniciarTarefasFundo(); },
+            [this]() { mestre.pararTarefasFundo(); });
+        return execucao.executar();
+    }
+};
+
+#endif // MESTRE_ASSINCRONO_H
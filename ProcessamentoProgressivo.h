@@ -0,0 +1,204 @@
+#ifndef PROCESSAMENTO_PROGRESSIVO_H
+#define PROCESSAMENTO_PROGRESSIVO_H
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+
+// Processamento de um arquivo pelo cliente com resultados parciais (POST /processar/stream):
+// o Mestre responde em server-sent events ("parcial" a cada fragmento contado, depois
+// "resultado" ou "erro"). A conexão roda em uma thread própria e a janela consulta os
+// eventos já recebidos pelo timer, como em IngestaoDiretorio.
+
+struct EventoProcessamento {
+    std::string tipo; // "parcial", "resultado" ou "erro"
+    Json::Value dados;
+};
+
+class ProcessamentoProgressivo {
+private:
+    std::string host;
+    int porta;
+    std::string corpo;
+    std::thread thread;
+    std::atomic<bool> concluido{false};
+    std::atomic<bool> cancelado{false};
+    static constexpr size_t blocoEnvio = 1 << 20;
+
+    mutable std::mutex mutex;
+    std::vector<EventoProcessamento> eventos;
+    std::string pendente; // bytes recebidos que ainda não formam um evento completo
+    bool finalRecebido = false;
+    // Cliente com a requisição em andamento: cancelar() o interrompe com stop()
+    httplib::Client* clienteAtivo = nullptr;
+
+    void publicar(EventoProcessamento evento) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (evento.tipo != "parcial") {
+            finalRecebido = true;
+        }
+        eventos.push_back(std::move(evento));
+    }
+
+    void publicarErro(const std::string& mensagem) {
+        EventoProcessamento evento;
+        evento.tipo = "erro";
+        evento.dados["erro"] = mensagem;
+        publicar(std::move(evento));
+    }
+
+    // Um evento SSE: linhas "event:" e "data:" terminadas por uma linha vazia
+    void interpretarBloco(const std::string& bloco) {
+        EventoProcessamento evento;
+        evento.tipo = "message";
+        std::string dados;
+        size_t inicio = 0;
+        while (inicio < bloco.size()) {
+            size_t fim = bloco.find('\n', inicio);
+            if (fim == std::string::npos) fim = bloco.size();
+            std::string linha = bloco.substr(inicio, fim - inicio);
+            if (!linha.empty() && linha.back() == '\r') linha.pop_back();
+            if (linha.compare(0, 6, "event:") == 0) {
+                evento.tipo = linha.substr(linha.size() > 6 && linha[6] == ' ' ? 7 : 6);
+            } else if (linha.compare(0, 5, "data:") == 0) {
+                if (!dados.empty()) dados += '\n';
+                dados += linha.substr(linha.size() > 5 && linha[5] == ' ' ? 6 : 5);
+            }
+            inicio = fim + 1;
+        }
+        if (dados.empty()) {
+            return;
+        }
+        Json::Reader reader;
+        if (!reader.parse(dados, evento.dados)) {
+            publicarErro("Evento com JSON inválido: " + evento.tipo);
+            return;
+        }
+        publicar(std::move(evento));
+    }
+
+    bool receber(const char* dados, size_t tamanho) {
+        pendente.append(dados, tamanho);
+        size_t separador;
+        while ((separador = pendente.find("\n\n")) != std::string::npos) {
+            interpretarBloco(pendente.substr(0, separador));
+            pendente.erase(0, separador + 2);
+        }
+        return !cancelado;
+    }
+
+    void executar() {
+        httplib::Client client(host, porta);
+        client.set_read_timeout(600, 0);
+
+        struct RegistroCliente {
+            ProcessamentoProgressivo& processamento;
+            ~RegistroCliente() {
+                std::lock_guard<std::mutex> lock(processamento.mutex);
+                processamento.clienteAtivo = nullptr;
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cancelado) {
+                concluido = true;
+                return;
+            }
+            clienteAtivo = &client;
+        }
+        RegistroCliente registro{*this};
+
+        httplib::Request req;
+        req.method = "POST";
+        req.path = "/processar/stream";
+        // Corpo em blocos que conferem o cancelamento, como em IngestaoDiretorio::enviarDocumento
+        req.content_length_ = corpo.size();
+        req.content_provider_ = [this](size_t offset, size_t length, httplib::DataSink& sink) {
+            if (cancelado) return false;
+            return sink.write(corpo.data() + offset, std::min<size_t>(length, blocoEnvio));
+        };
+        req.set_header("Content-Type", "application/json");
+        req.set_header("Accept", "text/event-stream");
+        req.content_receiver = [this](const char* dados, size_t tamanho, uint64_t, uint64_t) {
+            return receber(dados, tamanho);
+        };
+
+        auto resposta = client.send(req);
+        if (!resposta) {
+            if (!cancelado) publicarErro("Erro na comunicação com o servidor mestre");
+        } else if (resposta->status != 200) {
+            // Erros chegam como JSON comum, não como evento
+            Json::Value json;
+            Json::Reader reader;
+            std::string mensagem = "Erro do servidor: " + std::to_string(resposta->status);
+            if (reader.parse(pendente, json) && json["erro"].isString()) {
+                mensagem += " (" + json["erro"].asString() + ")";
+            }
+            publicarErro(mensagem);
+        } else {
+            if (!pendente.empty()) {
+                interpretarBloco(pendente);
+                pendente.clear();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!finalRecebido && !cancelado) {
+                EventoProcessamento evento;
+                evento.tipo = "erro";
+                evento.dados["erro"] = "Conexão encerrada sem resultado final";
+                eventos.push_back(std::move(evento));
+            }
+        }
+        concluido = true;
+    }
+
+public:
+    ProcessamentoProgressivo(std::string hostMestre, int portaMestre, const std::string& texto)
+        : host(std::move(hostMestre)), porta(portaMestre) {
+        Json::Value requestJson;
+        requestJson["texto"] = texto;
+        Json::StreamWriterBuilder builder;
+        corpo = Json::writeString(builder, requestJson);
+    }
+
+    ~ProcessamentoProgressivo() {
+        cancelar();
+        aguardar();
+    }
+
+    void iniciar() {
+        thread = std::thread([this]() { executar(); });
+    }
+
+    void aguardar() {
+        if (thread.joinable()) thread.join();
+    }
+
+    // Interrompe também a requisição em andamento: sem isso o destrutor (na GUI) esperaria
+    // até o timeout de leitura de 600 s
+    void cancelar() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelado = true;
+        if (clienteAtivo) clienteAtivo->stop();
+    }
+
+    // Thread encerrada: todos os eventos já estão disponíveis
+    bool terminou() const {
+        return concluido;
+    }
+
+    // Eventos a partir da posição 'desde' (para exibição incremental)
+    std::vector<EventoProcessamento> eventosDesde(size_t desde) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (desde >= eventos.size()) {
+            return {};
+        }
+        return std::vector<EventoProcessamento>(eventos.begin() + desde, eventos.end());
+    }
+};
+
+#endif // PROCESSAMENTO_PROGRESSIVO_H
@@ -0,0 +1,221 @@
+#ifndef RASTREAMENTO_H
+#define RASTREAMENTO_H
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <jsoncpp/json/json.h>
+
+// Rastreamento de requisições ponta a ponta.
+//
+// O Mestre gera um id por requisição e o repassa aos escravos no cabeçalho X-Request-Id,
+// junto com X-Trace-Amostrado (1 quando o rastro deve ser gravado em arquivo). Cada
+// componente mede suas etapas com Rastro::medir; as durações voltam no objeto "timings"
+// das respostas e, para requisições amostradas, são gravadas em formato Chrome trace-event.
+//
+// Variáveis de ambiente:
+//   TRACE_ARQUIVO     arquivo de saída (JSON array de eventos; abre em chrome://tracing ou Perfetto)
+//   TRACE_AMOSTRAGEM  fração das requisições gravadas no Mestre (padrão: 0.01)
+
+constexpr const char* cabecalhoRequestId = "X-Request-Id";
+constexpr const char* cabecalhoAmostrado = "X-Trace-Amostrado";
+
+inline std::string gerarIdRequisicao() {
+    thread_local std::mt19937_64 gerador{std::random_device{}()};
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(gerador()));
+    return id;
+}
+
+// Usa o id recebido em cabeçalho apenas se for seguro repassar e gravar (até 64 caracteres [A-Za-z0-9_-])
+inline std::string idRequisicaoRecebido(const std::string& recebido) {
+    if (recebido.empty() || recebido.size() > 64) {
+        return gerarIdRequisicao();
+    }
+    for (unsigned char c : recebido) {
+        if (!std::isalnum(c) && c != '-' && c != '_') {
+            return gerarIdRequisicao();
+        }
+    }
+    return recebido;
+}
+
+// Arquivo de trace compartilhado pelo processo
+class GravadorTrace {
+private:
+    std::FILE* arquivo = nullptr;
+    double amostragem = 0.01;
+    std::mutex mutex;
+
+    GravadorTrace() {
+        const char* caminho = std::getenv("TRACE_ARQUIVO");
+        if (const char* valor = std::getenv("TRACE_AMOSTRAGEM")) {
+            amostragem = std::atof(valor);
+        }
+        if (!caminho) {
+            return;
+        }
+        // Vários processos podem gravar no mesmo arquivo: cada um usa o seu
+        std::string nome = std::string(caminho) + "." + std::to_string(getpid()) + ".json";
+        arquivo = std::fopen(nome.c_str(), "w");
+        if (arquivo) {
+            // O formato aceita o array sem o ']' final, então cada evento é gravado assim que chega
+            std::fputs("[\n", arquivo);
+            std::fflush(arquivo);
+        }
+    }
+
+public:
+    static GravadorTrace& instancia() {
+        static GravadorTrace gravador;
+        return gravador;
+    }
+
+    bool ativo() const { return arquivo != nullptr; }
+
+    bool sortearAmostra() const {
+        if (!arquivo) {
+            return false;
+        }
+        thread_local std::mt19937_64 gerador{std::random_device{}()};
+        return std::uniform_real_distribution<double>(0.0, 1.0)(gerador) < amostragem;
+    }
+
+    void gravar(const std::string& eventos) {
+        if (!arquivo) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        std::fputs(eventos.c_str(), arquivo);
+        std::fflush(arquivo);
+    }
+};
+
+class Rastro {
+public:
+    struct Trecho {
+        std::string nome;
+        int64_t inicioUs;  // relativo ao início do rastro
+        int64_t duracaoUs;
+        size_t thread;
+    };
+
+private:
+    std::string idRequisicao;
+    std::string servico;
+    bool amostrado;
+    std::chrono::steady_clock::time_point inicio;
+    int64_t inicioEpocaUs; // relógio de parede, para alinhar rastros de processos diferentes
+    std::vector<Trecho> trechos;
+    mutable std::mutex mutex;
+
+public:
+    Rastro(std::string id, std::string nomeServico, bool amostra)
+        : idRequisicao(std::move(id)), servico(std::move(nomeServico)), amostrado(amostra),
+          inicio(std::chrono::steady_clock::now()),
+          inicioEpocaUs(std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count()) {}
+
+    // Grava o rastro ao final da requisição, se ela foi amostrada
+    ~Rastro() {
+        if (amostrado) {
+            GravadorTrace::instancia().gravar(eventosChrome());
+        }
+    }
+
+    // Mede o tempo até o fim do escopo do objeto retornado
+    class Medicao {
+    private:
+        Rastro& rastro;
+        std::string nome;
+        std::chrono::steady_clock::time_point inicio;
+        bool encerrada = false;
+
+    public:
+        Medicao(Rastro& r, std::string n)
+            : rastro(r), nome(std::move(n)), inicio(std::chrono::steady_clock::now()) {}
+
+        Medicao(const Medicao&) = delete;
+        Medicao& operator=(const Medicao&) = delete;
+
+        void encerrar() {
+            if (!encerrada) {
+                rastro.registrar(nome, inicio, std::chrono::steady_clock::now());
+                encerrada = true;
+            }
+        }
+
+        ~Medicao() { encerrar(); }
+    };
+
+    Medicao medir(const std::string& nome) {
+        return Medicao(*this, nome);
+    }
+
+    void registrar(const std::string& nome, std::chrono::steady_clock::time_point de,
+                   std::chrono::steady_clock::time_point ate) {
+        Trecho t;
+        t.nome = nome;
+        t.inicioUs = std::chrono::duration_cast<std::chrono::microseconds>(de - inicio).count();
+        t.duracaoUs = std::chrono::duration_cast<std::chrono::microseconds>(ate - de).count();
+        t.thread = std::hash<std::thread::id>{}(std::this_thread::get_id()) % 100000;
+        std::lock_guard<std::mutex> lock(mutex);
+        trechos.push_back(std::move(t));
+    }
+
+    // Registra uma duração medida em outro componente (ex.: tempo informado pelo escravo)
+    void registrarDuracao(const std::string& nome, std::chrono::steady_clock::time_point de, double ms) {
+        Trecho t;
+        t.nome = nome;
+        t.inicioUs = std::chrono::duration_cast<std::chrono::microseconds>(de - inicio).count();
+        t.duracaoUs = static_cast<int64_t>(ms * 1000.0);
+        t.thread = std::hash<std::thread::id>{}(std::this_thread::get_id()) % 100000;
+        std::lock_guard<std::mutex> lock(mutex);
+        trechos.push_back(std::move(t));
+    }
+
+    const std::string& id() const { return idRequisicao; }
+    bool amostra() const { return amostrado; }
+
+    double decorridoMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    }
+
+    // {"request_id": ..., "total_ms": ..., "etapas": {"nome": ms, ...}}; nomes repetidos são somados
+    Json::Value timings() const {
+        Json::Value resultado;
+        resultado["request_id"] = idRequisicao;
+        resultado["total_ms"] = decorridoMs();
+        Json::Value etapas(Json::objectValue);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& t : trechos) {
+            etapas[t.nome] = etapas.get(t.nome, 0.0).asDouble() + t.duracaoUs / 1000.0;
+        }
+        resultado["etapas"] = etapas;
+        return resultado;
+    }
+
+    std::string eventosChrome() const {
+        std::ostringstream saida;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& t : trechos) {
+            saida << "{\"name\":\"" << t.nome << "\",\"cat\":\"" << servico << "\",\"ph\":\"X\""
+                  << ",\"ts\":" << (inicioEpocaUs + t.inicioUs) << ",\"dur\":" << t.duracaoUs
+                  << ",\"pid\":" << getpid() << ",\"tid\":" << t.thread
+                  << ",\"args\":{\"request_id\":\"" << idRequisicao << "\"}},\n";
+        }
+        return saida.str();
+    }
+};
+
+#endif // RASTREAMENTO_H
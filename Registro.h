@@ -0,0 +1,137 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <httplib.h>
+#include <jsoncpp/json/json.h>
+
+// Registro do escravo no Mestre (POST /registrar) seguido de heartbeats periódicos
+// (POST /heartbeat) com a carga atual. Só é ativado quando MESTRE_ENDERECO está definido.
+// Uma recusa do registro (4xx) é definitiva; falhas de conexão e 5xx são tentadas de novo.
+//
+// Variáveis de ambiente:
+//   MESTRE_ENDERECO  host:porta do Mestre (ex.: mestre:8080)
+//   ANUNCIAR_HOST    nome pelo qual o Mestre alcança este escravo (padrão: hostname)
+//   HEARTBEAT_MS     intervalo entre heartbeats (padrão: 2000)
+class RegistroMestre {
+private:
+    std::string tipo;
+    int porta;
+    std::function<Json::Value()> carga;
+
+    std::string mestreHost;
+    int mestrePorta = 0;
+    std::string hostAnunciado;
+    int intervaloMs = 2000;
+
+    std::thread thread;
+    std::atomic<bool> ativo{false};
+    std::atomic<bool> recusado{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    Json::Value corpo() const {
+        Json::Value c;
+        c["tipo"] = tipo;
+        c["host"] = hostAnunciado;
+        c["porta"] = porta;
+        return c;
+    }
+
+    int enviar(const std::string& rota, const Json::Value& requestJson) {
+        httplib::Client client(mestreHost, mestrePorta);
+        client.set_connection_timeout(1);
+        client.set_read_timeout(2);
+
+        Json::StreamWriterBuilder builder;
+        auto resposta = client.Post(rota, Json::writeString(builder, requestJson), "application/json");
+        return resposta ? resposta->status : -1;
+    }
+
+    void executar() {
+        bool registrado = false;
+        while (ativo) {
+            if (!registrado) {
+                int status = enviar("/registrar", corpo());
+                registrado = status == 200;
+                if (registrado) {
+                    std::cout << "Registrado no Mestre " << mestreHost << ":" << mestrePorta
+                             << " como " << hostAnunciado << ":" << porta << " (" << tipo << ")" << std::endl;
+                } else if (status >= 400 && status < 500) {
+                    // Recusa do Mestre (tipo sem grupo, host ou porta inválidos): tentar de novo
+                    // daria a mesma resposta, então o registro é abandonado
+                    std::cerr << "Mestre " << mestreHost << ":" << mestrePorta << " recusou o registro ("
+                              << tipo << ", status " << status << "); registro desativado" << std::endl;
+                    recusado = true;
+                    return;
+                }
+            } else {
+                Json::Value batida = corpo();
+                batida["carga"] = carga();
+                // Qualquer resposta diferente de 200 (Mestre reiniciado, fora do ar) leva a um novo registro
+                registrado = enviar("/heartbeat", batida) == 200;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait_for(lock, std::chrono::milliseconds(intervaloMs), [this]() { return !ativo; });
+        }
+    }
+
+public:
+    RegistroMestre(std::string tipoEscravo, int portaEscravo, std::function<Json::Value()> funcaoCarga)
+        : tipo(std::move(tipoEscravo)), porta(portaEscravo), carga(std::move(funcaoCarga)) {}
+
+    ~RegistroMestre() {
+        parar();
+    }
+
+    bool iniciar() {
+        const char* endereco = std::getenv("MESTRE_ENDERECO");
+        if (!endereco || std::string(endereco).find(':') == std::string::npos) {
+            return false;
+        }
+        std::string e(endereco);
+        mestreHost = e.substr(0, e.rfind(':'));
+        mestrePorta = std::stoi(e.substr(e.rfind(':') + 1));
+
+        if (const char* host = std::getenv("ANUNCIAR_HOST")) {
+            hostAnunciado = host;
+        } else {
+            char nome[256] = {0};
+            gethostname(nome, sizeof(nome) - 1);
+            hostAnunciado = nome;
+        }
+        if (const char* intervalo = std::getenv("HEARTBEAT_MS")) {
+            intervaloMs = std::stoi(intervalo);
+        }
+
+        ativo = true;
+        thread = std::thread([this]() { executar(); });
+        return true;
+    }
+
+    // Interrompe os heartbeats e avisa o Mestre para retirar este escravo imediatamente
+    void parar() {
+        if (!ativo.exchange(false)) {
+            return;
+        }
+        cv.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+        if (!recusado) {
+            enviar("/desregistrar", corpo());
+        }
+    }
+};
+
+#endif // REGISTRO_H
@@ -1,5 +1,6 @@
 QT += widgets
+CONFIG += c++17
 SOURCES += Cliente.cpp ClientWindow.cpp
-HEADERS += ClientWindow.h
+HEADERS += ClientWindow.h Fragmentacao.h IngestaoDiretorio.h ProcessamentoProgressivo.h
 # Incluir as bibliotecas necessárias para a sua lógica HTTP e JSON
 LIBS += -ljsoncpp -lpthread
\ No newline at end of file